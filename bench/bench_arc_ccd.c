@@ -0,0 +1,179 @@
+// Benchmark: rotating arcs tested frozen at their current rotation vs swept (setArcCircleSweptRotation)
+//
+// Runs a scene of 3 nested arcs 100 px apart turning at 300 to 600 degrees per second, with 500
+// small balls spawned at the center which don't collide with each other (so only the arcs move
+// them) and escape callbacks that only count. It runs at a large time step, with each mode and
+// a few substep budgets, and checks the result after every step:
+//   - penetrations: balls whose center went deeper than half their radius into an arc
+//   - escapes: balls which crossed an arc's outer circle during the step, missed when no
+//     escape callback fired for them, false when a callback fired for a ball that didn't cross
+// The checks use their own geometry (atan2f, cosf/sinf) at the arcs' rotation after the step.
+//
+// Usage: bench_arc_ccd [frames] [time multiplier]
+
+#include "../include/common.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <math.h>
+
+GameObject* createArcCircleObject(Vector2 position, Vector2 velocity, float radius, float startAngle, float endAngle, float thickness, Color color, bool isStatic, float rotationSpeed, bool removeEscapedBalls);
+
+#define ARC_COUNT 3
+#define MAX_BALLS 500
+
+typedef struct {
+    const char* name;
+    bool swept;
+    int maxSubsteps;
+} CcdMode;
+
+typedef struct {
+    long long penetrations;
+    long long crossings;
+    long long missedEscapes;
+    long long falseEscapes;
+    double msPerStep;
+} CcdResult;
+
+// State shared with the escape callback
+static Simulation* currentSim;
+static GameObject* arcs[ARC_COUNT];
+static bool escaped[ARC_COUNT][MAX_BALLS];
+
+static double nowSeconds(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+}
+
+static float randomRange(float min, float max) {
+    return min + (max - min) * (float)rand() / RAND_MAX;
+}
+
+static void countEscape(GameObject* arc, BouncingObject* ball) {
+    int index = getBallIndex(&currentSim->balls, ball->handle);
+    if (index < 0 || index >= MAX_BALLS) return;
+    for (int a = 0; a < ARC_COUNT; a++) {
+        if (arcs[a] == arc) escaped[a][index] = true;
+    }
+}
+
+static float distanceToSegment(Vector2 p, Vector2 a, Vector2 b) {
+    Vector2 ab = Vector2Subtract(b, a);
+    float lengthSq = Vector2LengthSqr(ab);
+    float t = (lengthSq > 0.0f) ? Clamp(Vector2DotProduct(Vector2Subtract(p, a), ab) / lengthSq, 0.0f, 1.0f) : 0.0f;
+    return Vector2Distance(p, Vector2Add(a, Vector2Scale(ab, t)));
+}
+
+// Whether a ball's center is more than half its radius inside the arc
+static bool isDeepInsideArc(const GameObject* arc, Vector2 position, float ballRadius) {
+    const ShapeDataArcCircle* data = (const ShapeDataArcCircle*)arc->shapeData;
+    float inner = data->radius - data->thickness / 2.0f;
+    float outer = data->radius + data->thickness / 2.0f;
+    float depth = ballRadius * 0.5f;
+
+    Vector2 d = Vector2Subtract(position, arc->position);
+    float r = Vector2Length(d);
+    float angle = fmodf(atan2f(d.y, d.x) * RAD2DEG - (data->startAngle + data->rotation), 360.0f);
+    if (angle < 0.0f) angle += 360.0f;
+    if (angle > 360.0f) angle -= 360.0f;
+    if (angle <= data->endAngle - data->startAngle) {
+        return r > inner - depth && r < outer + depth;
+    }
+
+    float ends[2] = { data->startAngle + data->rotation, data->endAngle + data->rotation };
+    for (int e = 0; e < 2; e++) {
+        Vector2 dir = { cosf(ends[e] * DEG2RAD), sinf(ends[e] * DEG2RAD) };
+        Vector2 a = Vector2Add(arc->position, Vector2Scale(dir, inner));
+        Vector2 b = Vector2Add(arc->position, Vector2Scale(dir, outer));
+        if (distanceToSegment(position, a, b) < depth) return true;
+    }
+    return false;
+}
+
+static bool isInsideOuterCircle(const GameObject* arc, Vector2 position) {
+    const ShapeDataArcCircle* data = (const ShapeDataArcCircle*)arc->shapeData;
+    return Vector2Distance(position, arc->position) <= data->radius + data->thickness / 2.0f;
+}
+
+static void runMode(const CcdMode* mode, int frames, float dt, CcdResult* result) {
+    memset(result, 0, sizeof(*result));
+    srand(1234);
+    Simulation sim;
+    initSimulation(&sim, 1);
+    sim.maxSubsteps = mode->maxSubsteps;
+    currentSim = &sim;
+
+    for (int a = 0; a < ARC_COUNT; a++) {
+        arcs[a] = createArcCircleObject((Vector2){ SCREEN_WIDTH * 0.5f, SCREEN_HEIGHT * 0.5f }, (Vector2){ 0, 0 },
+                                        80 + a * 100, 0.0f, 300.0f, 6.0f, RED, false, 300.0f + a * 150, false);
+        addEscapeCallbackToArcCircle(arcs[a], countEscape);
+        setArcCircleSweptRotation(arcs[a], mode->swept);
+        addSimulationObject(&sim, arcs[a]);
+    }
+
+    static bool wasInside[ARC_COUNT][MAX_BALLS];
+    double stepTime = 0.0;
+    for (int f = 0; f < frames; f++) {
+        for (int i = 0; i < 10 && sim.balls.count < MAX_BALLS; i++) {
+            float angle = randomRange(0.0f, 2.0f * PI);
+            float speed = randomRange(100.0f, 400.0f);
+            createBouncingObject(&sim.balls, (Vector2){ SCREEN_WIDTH * 0.5f, SCREEN_HEIGHT * 0.5f },
+                                 (Vector2){ cosf(angle) * speed, sinf(angle) * speed },
+                                 randomRange(3.0f, 6.0f), YELLOW, 1.0f, 1.0f, false);
+        }
+        for (int a = 0; a < ARC_COUNT; a++) {
+            for (int i = 0; i < sim.balls.count; i++) {
+                wasInside[a][i] = isInsideOuterCircle(arcs[a], (Vector2){ sim.balls.posX[i], sim.balls.posY[i] });
+                escaped[a][i] = false;
+            }
+        }
+
+        double start = nowSeconds();
+        stepSimulation(&sim, dt);
+        stepTime += nowSeconds() - start;
+
+        for (int a = 0; a < ARC_COUNT; a++) {
+            for (int i = 0; i < sim.balls.count; i++) {
+                Vector2 position = { sim.balls.posX[i], sim.balls.posY[i] };
+                bool crossed = wasInside[a][i] && !isInsideOuterCircle(arcs[a], position);
+                result->crossings += crossed;
+                result->missedEscapes += crossed && !escaped[a][i];
+                result->falseEscapes += !crossed && escaped[a][i];
+                result->penetrations += isDeepInsideArc(arcs[a], position, sim.balls.radius[i]);
+            }
+        }
+    }
+    result->msPerStep = stepTime * 1000.0 / frames;
+
+    freeSimulation(&sim);
+}
+
+int main(int argc, char** argv) {
+    int frames = (argc > 1) ? atoi(argv[1]) : 600;
+    float multiplier = (argc > 2) ? (float)atof(argv[2]) : 10.0f;
+    if (frames < 1) frames = 1;
+    float dt = multiplier / 120.0f;
+
+    const CcdMode modes[] = {
+        { "frozen, 10 substeps", false, 10 },
+        { "swept, 10 substeps",  true,  10 },
+        { "frozen, 4 substeps",  false, 4 },
+        { "swept, 4 substeps",   true,  4 },
+    };
+
+    printf("arc scene, %d frames at dt = %.4f s (x%.1f)\n", frames, dt, multiplier);
+    printf("%-20s | %8s | %12s | %9s | %14s | %13s\n",
+           "mode", "ms/step", "penetrations", "crossings", "missed escapes", "false escapes");
+    for (size_t m = 0; m < sizeof(modes) / sizeof(modes[0]); m++) {
+        CcdResult result;
+        runMode(&modes[m], frames, dt, &result);
+        printf("%-20s | %8.3f | %12lld | %9lld | %14lld | %13lld\n", modes[m].name, result.msPerStep,
+               result.penetrations, result.crossings, result.missedEscapes, result.falseEscapes);
+    }
+
+    freeCollisionEffectPool();
+    return 0;
+}
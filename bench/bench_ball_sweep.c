@@ -0,0 +1,115 @@
+// Benchmark: the per-ball "trivial" passes, scalar vs vectorized
+//
+// Integration with screen wrap (updateBouncingObjectList) and screen boundary collisions
+// (applyScreenBoundaryCollisionsRange) sweep the ball arrays 4 balls at a time without branches.
+// They are compared with the scalar code they replace, run on a copy of the same balls, half
+// of them outside the screen so that every branch is taken: time per ball and per pass, and
+// whether both give exactly the same balls.
+//
+// Usage: bench_ball_sweep [ballCount] [passes]
+
+#include "../include/common.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+static double nowSeconds(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+}
+
+static float randomRange(float min, float max) {
+    return min + (max - min) * (float)rand() / RAND_MAX;
+}
+
+static void createBalls(BallStore* balls, int count) {
+    srand(5);
+    for (int i = 0; i < count; i++) {
+        Vector2 position = { randomRange(-100.0f, SCREEN_WIDTH + 100.0f), randomRange(-100.0f, SCREEN_HEIGHT + 100.0f) };
+        Vector2 velocity = { randomRange(-300.0f, 300.0f), randomRange(-300.0f, 300.0f) };
+        createBouncingObject(balls, position, velocity, randomRange(2.0f, 20.0f), YELLOW, 1.0f, 1.0f, false);
+    }
+}
+
+// The scalar integration loop updateBouncingObjectList had before
+static void integrateScalar(BallStore* store, float dt) {
+    for (int i = 0; i < store->count; i++) {
+        store->posX[i] += store->velX[i] * dt;
+        store->posY[i] += store->velY[i] * dt;
+        if (store->posX[i] < -50) store->posX[i] = SCREEN_WIDTH + 40;
+        if (store->posX[i] > SCREEN_WIDTH + 50) store->posX[i] = -40;
+        if (store->posY[i] < -50) store->posY[i] = SCREEN_HEIGHT + 40;
+        if (store->posY[i] > SCREEN_HEIGHT + 50) store->posY[i] = -40;
+    }
+}
+
+// Boundary collisions one working copy at a time, as the object pass did before
+static void boundariesScalar(BallStore* store) {
+    for (int i = 0; i < store->count; i++) {
+        BouncingObject ball;
+        loadBouncingObject(store, i, &ball);
+        applyScreenBoundaryCollisions(&ball);
+        storeBouncingObject(store, i, &ball);
+    }
+}
+
+static void boundariesVectorized(BallStore* store) {
+    applyScreenBoundaryCollisionsRange(store, 0, store->count);
+}
+
+static void integrateVectorized(BallStore* store, float dt) {
+    updateBouncingObjectList(store, dt);
+}
+
+static bool sameBalls(const BallStore* a, const BallStore* b) {
+    size_t size = (size_t)a->count * sizeof(float);
+    return a->count == b->count &&
+           memcmp(a->posX, b->posX, size) == 0 && memcmp(a->posY, b->posY, size) == 0 &&
+           memcmp(a->velX, b->velX, size) == 0 && memcmp(a->velY, b->velY, size) == 0;
+}
+
+// Time `passes` integration + boundary passes, return ns per ball and per pass of each
+static void runPasses(BallStore* balls, int passes, void (*integrate)(BallStore*, float),
+                      void (*boundaries)(BallStore*), double* integrateNs, double* boundariesNs) {
+    const float dt = 1.0f / 120.0f;
+    double integrateTime = 0.0, boundariesTime = 0.0;
+    for (int p = 0; p < passes; p++) {
+        double start = nowSeconds();
+        integrate(balls, dt);
+        double middle = nowSeconds();
+        boundaries(balls);
+        boundariesTime += nowSeconds() - middle;
+        integrateTime += middle - start;
+    }
+    *integrateNs = integrateTime * 1e9 / ((double)balls->count * passes);
+    *boundariesNs = boundariesTime * 1e9 / ((double)balls->count * passes);
+}
+
+int main(int argc, char** argv) {
+    int ballCount = (argc > 1) ? atoi(argv[1]) : 1000000;
+    int passes = (argc > 2) ? atoi(argv[2]) : 50;
+    if (ballCount < 1) ballCount = 1;
+    if (passes < 1) passes = 1;
+
+    BallStore scalar, vectorized;
+    initBallStore(&scalar);
+    initBallStore(&vectorized);
+    createBalls(&scalar, ballCount);
+    createBalls(&vectorized, ballCount);
+
+    double scalarIntegrate, scalarBoundaries, vectorIntegrate, vectorBoundaries;
+    runPasses(&scalar, passes, integrateScalar, boundariesScalar, &scalarIntegrate, &scalarBoundaries);
+    runPasses(&vectorized, passes, integrateVectorized, boundariesVectorized, &vectorIntegrate, &vectorBoundaries);
+
+    printf("%d balls, %d passes\n", ballCount, passes);
+    printf("%-11s | %14s | %14s\n", "pass", "scalar ns/ball", "vector ns/ball");
+    printf("%-11s | %14.2f | %14.2f (%.1fx)\n", "integration", scalarIntegrate, vectorIntegrate, scalarIntegrate / vectorIntegrate);
+    printf("%-11s | %14.2f | %14.2f (%.1fx)\n", "boundaries", scalarBoundaries, vectorBoundaries, scalarBoundaries / vectorBoundaries);
+    printf("same balls : %s\n", sameBalls(&scalar, &vectorized) ? "yes" : "NO");
+
+    freeBallStore(&scalar);
+    freeBallStore(&vectorized);
+    return 0;
+}
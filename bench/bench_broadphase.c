@@ -0,0 +1,116 @@
+// Benchmark: ball-to-ball collisions, naive O(n^2) pair loop vs uniform grid broadphase
+//
+// Balls are scattered at a constant density (the world grows with the ball count),
+// so the number of real contacts per ball stays the same at every size and only
+// the cost of finding them changes.
+//
+// Usage: bench_broadphase [maxNaiveBalls]
+//   maxNaiveBalls: skip the naive loop above this many balls (default: always run it)
+
+#include "../include/common.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <math.h>
+
+// Average area per ball, in pixels^2 (about 3000 balls on a 1080x720 screen)
+#define AREA_PER_BALL 260.0f
+
+static double nowSeconds(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+}
+
+static void createBalls(BallStore* balls, int count, float side, unsigned int seed) {
+    srand(seed);
+    for (int i = 0; i < count; i++) {
+        Vector2 position = { side * (float)rand() / RAND_MAX, side * (float)rand() / RAND_MAX };
+        Vector2 velocity = { (float)(rand() % 400 - 200), (float)(rand() % 400 - 200) };
+        float radius = 3.0f + (float)(rand() % 5);
+        float mass = 0.5f + ((float)rand() / RAND_MAX) * 2.5f;
+        createBouncingObject(balls, position, velocity, radius, YELLOW, mass, 1.0f, true);
+    }
+}
+
+// Move the balls and wrap them around the world so every frame sees new contacts
+// (a wrapped ball has no path over the frame for the swept ball-to-ball test)
+static void moveBalls(BallStore* balls, float side, float dt) {
+    saveBallPositions(balls);
+    for (int i = 0; i < balls->count; i++) {
+        balls->posX[i] += balls->velX[i] * dt;
+        balls->posY[i] += balls->velY[i] * dt;
+        bool wrapped = false;
+        if (balls->posX[i] < 0.0f) { balls->posX[i] += side; wrapped = true; }
+        if (balls->posX[i] > side) { balls->posX[i] -= side; wrapped = true; }
+        if (balls->posY[i] < 0.0f) { balls->posY[i] += side; wrapped = true; }
+        if (balls->posY[i] > side) { balls->posY[i] -= side; wrapped = true; }
+        if (wrapped) {
+            balls->prevX[i] = balls->posX[i];
+            balls->prevY[i] = balls->posY[i];
+        }
+    }
+}
+
+// Grid broadphase on the calling thread only
+static void handleBallToBallCollisionsSerial(BallStore* balls, float dt) {
+    handleBallToBallCollisions(balls, dt, NULL);
+}
+
+// Run `fn` on a fresh set of balls until at least minSeconds have elapsed.
+// Returns the average time per frame in milliseconds (ball movement included).
+static double timeFrames(void (*fn)(BallStore*, float), int count, double minSeconds, int* framesOut) {
+    const float dt = 1.0f / 120.0f;
+    float side = sqrtf(AREA_PER_BALL * (float)count);
+    BallStore balls;
+    initBallStore(&balls);
+    createBalls(&balls, count, side, 1234);
+
+    int frames = 0;
+    double start = nowSeconds();
+    double elapsed = 0.0;
+    do {
+        moveBalls(&balls, side, dt);
+        fn(&balls, dt);
+        frames++;
+        elapsed = nowSeconds() - start;
+    } while (elapsed < minSeconds);
+
+    freeBallStore(&balls);
+    *framesOut = frames;
+    return elapsed * 1000.0 / frames;
+}
+
+int main(int argc, char** argv) {
+    int maxNaiveBalls = (argc > 1) ? atoi(argv[1]) : 0;
+    const int sizes[] = { 1000, 10000, 100000 };
+    const int sizeCount = sizeof(sizes) / sizeof(sizes[0]);
+
+    // "growth" is the cost ratio to the previous size: 10x more balls gives ~10x for O(n), ~100x for O(n^2)
+    printf("%-7s | %14s %7s %7s | %14s %7s %7s | %8s\n",
+           "balls", "naive ms/frame", "frames", "growth", "grid ms/frame", "frames", "growth", "speedup");
+    double previousGrid = -1.0, previousNaive = -1.0;
+    for (int s = 0; s < sizeCount; s++) {
+        int count = sizes[s];
+        int gridFrames = 0, naiveFrames = 0;
+        double gridMs = timeFrames(handleBallToBallCollisionsSerial, count, 0.5, &gridFrames);
+        double naiveMs = -1.0;
+        if (maxNaiveBalls <= 0 || count <= maxNaiveBalls) {
+            naiveMs = timeFrames(handleBallToBallCollisionsNaive, count, 0.5, &naiveFrames);
+        }
+
+        char naiveCol[32] = "skipped", naiveGrowth[16] = "-", gridGrowth[16] = "-", speedup[16] = "-";
+        if (naiveMs >= 0.0) {
+            snprintf(naiveCol, sizeof(naiveCol), "%.3f", naiveMs);
+            snprintf(speedup, sizeof(speedup), "%.1fx", naiveMs / gridMs);
+            if (previousNaive > 0.0) snprintf(naiveGrowth, sizeof(naiveGrowth), "%.1fx", naiveMs / previousNaive);
+        }
+        if (previousGrid > 0.0) snprintf(gridGrowth, sizeof(gridGrowth), "%.1fx", gridMs / previousGrid);
+
+        printf("%-7d | %14s %7d %7s | %14.3f %7d %7s | %8s\n",
+               count, naiveCol, naiveFrames, naiveGrowth, gridMs, gridFrames, gridGrowth, speedup);
+        previousGrid = gridMs;
+        previousNaive = naiveMs;
+    }
+    return 0;
+}
@@ -0,0 +1,172 @@
+// Benchmark: parallel collision passes on 1, 2, 4, ... threads
+//
+// Runs the ball vs GameObject pass (handleBouncingObjectListCollisions) and the ball-to-ball
+// contact solver (handleBallToBallCollisions) on the same scenes with a growing thread pool,
+// and reports the time per frame, the speedup over one thread and a checksum of the final
+// ball state (it must not depend on the number of threads, and thread count 0 is the
+// serial path without a pool).
+//
+// Usage: bench_parallel_collisions [ballCount] [frames] [maxThreads]
+
+#include "../include/common.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <math.h>
+
+GameObject* createRectangleObject(Vector2 position, Vector2 velocity, float width, float height, Color color, bool isStatic);
+GameObject* createDiamondObject(Vector2 position, Vector2 velocity, float diagWidth, float diagHeight, Color color, bool isStatic);
+GameObject* createArcCircleObject(Vector2 position, Vector2 velocity, float radius, float startAngle, float endAngle, float thickness, Color color, bool isStatic, float rotationSpeed, bool removeEscapedBalls);
+void addObjectToList(GameObject** head, GameObject* newObject);
+void freeObjectList(GameObject** head);
+void updateObjectList(GameObject* head, float dt);
+
+static int escapeCount = 0;
+
+static void countEscape(GameObject* arc, BouncingObject* ball) {
+    (void)arc;
+    (void)ball;
+    escapeCount++;
+}
+
+static double nowSeconds(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+}
+
+static float randomRange(float min, float max) {
+    return min + (max - min) * (float)rand() / RAND_MAX;
+}
+
+static double ballChecksum(const BallStore* balls) {
+    double sum = 0.0;
+    for (int i = 0; i < balls->count; i++) {
+        sum += balls->posX[i] + 3.0 * balls->posY[i] + 5.0 * balls->velX[i] + 7.0 * balls->velY[i];
+    }
+    return sum;
+}
+
+// 200 obstacles on a grid, a third of them rotating arcs with an escape callback
+static GameObject* createScene(AABBTree* tree) {
+    GameObject* list = NULL;
+    const int cols = 20, rows = 10;
+    float cellW = (float)SCREEN_WIDTH / cols;
+    float cellH = (float)SCREEN_HEIGHT / rows;
+    for (int i = 0; i < cols * rows; i++) {
+        Vector2 center = { ((float)(i % cols) + 0.5f) * cellW, ((float)(i / cols) + 0.5f) * cellH };
+        GameObject* obj = NULL;
+        switch (i % 3) {
+            case 0: obj = createRectangleObject(center, (Vector2){0, 0}, 16.0f, 8.0f, SKYBLUE, true); break;
+            case 1: obj = createDiamondObject(center, (Vector2){0, 0}, 16.0f, 16.0f, GREEN, true); break;
+            case 2:
+                obj = createArcCircleObject(center, (Vector2){0, 0}, 14.0f, 0.0f, 270.0f, 2.0f, RED, true, 90.0f, false);
+                addEscapeCallbackToArcCircle(obj, countEscape);
+                break;
+        }
+        addObjectToList(&list, obj);
+        insertObjectInTree(tree, obj);
+    }
+    return list;
+}
+
+// Simulate `frames` frames of the ball vs GameObject pass with `threadCount` threads, return ms/frame
+static double runObjectPass(int ballCount, int frames, int threadCount, double* checksum) {
+    const float dt = 1.0f / 120.0f;
+    AABBTree tree;
+    initAABBTree(&tree);
+    GameObject* objects = createScene(&tree);
+    BallStore balls;
+    initBallStore(&balls);
+    srand(7);
+    for (int i = 0; i < ballCount; i++) {
+        Vector2 position = { randomRange(0, SCREEN_WIDTH), randomRange(0, SCREEN_HEIGHT) };
+        Vector2 velocity = { randomRange(-300.0f, 300.0f), randomRange(-300.0f, 300.0f) };
+        createBouncingObject(&balls, position, velocity, randomRange(2.0f, 4.0f), YELLOW, 1.0f, 1.0f, false);
+    }
+    ThreadPool threads;
+    ThreadPool* pool = NULL; // No pool at all for the serial path
+    if (threadCount > 0) {
+        initThreadPool(&threads, threadCount);
+        pool = &threads;
+    }
+    escapeCount = 0;
+
+    double start = nowSeconds();
+    for (int f = 0; f < frames; f++) {
+        updateObjectList(objects, dt);
+        handleBouncingObjectListCollisions(&balls, objects, &tree, dt, 10, pool);
+    }
+    double elapsed = nowSeconds() - start;
+
+    *checksum = escapeCount + ballChecksum(&balls);
+
+    if (pool) freeThreadPool(pool);
+    freeBallStore(&balls);
+    freeObjectList(&objects);
+    freeAABBTree(&tree);
+    return elapsed * 1000.0 / frames;
+}
+
+// Simulate `frames` frames of a crowded box of interacting balls, return ms/frame
+// spent in the contact solver
+static double runContactPass(int ballCount, int frames, int threadCount, double* checksum) {
+    const float dt = 1.0f / 120.0f;
+    BallStore balls;
+    initBallStore(&balls);
+    srand(11);
+    for (int i = 0; i < ballCount; i++) {
+        Vector2 position = { randomRange(0, SCREEN_WIDTH), randomRange(0, SCREEN_HEIGHT) };
+        Vector2 velocity = { randomRange(-100.0f, 100.0f), randomRange(-100.0f, 100.0f) };
+        createBouncingObject(&balls, position, velocity, randomRange(1.5f, 3.0f), YELLOW, randomRange(0.5f, 2.0f), 1.0f, true);
+    }
+    ThreadPool threads;
+    ThreadPool* pool = NULL; // No pool at all for the serial path
+    if (threadCount > 0) {
+        initThreadPool(&threads, threadCount);
+        pool = &threads;
+    }
+
+    double solverTime = 0.0;
+    for (int f = 0; f < frames; f++) {
+        saveBallPositions(&balls);
+        updateBouncingObjectList(&balls, dt);
+        double start = nowSeconds();
+        handleBallToBallCollisions(&balls, dt, pool);
+        solverTime += nowSeconds() - start;
+    }
+    *checksum = ballChecksum(&balls);
+
+    if (pool) freeThreadPool(pool);
+    freeBallStore(&balls);
+    return solverTime * 1000.0 / frames;
+}
+
+typedef double (*PassRunner)(int ballCount, int frames, int threadCount, double* checksum);
+
+static void printScaling(const char* title, PassRunner run, int ballCount, int frames, int maxThreads) {
+    printf("%s: %d balls, %d frames\n", title, ballCount, frames);
+    printf("%-7s | %10s | %8s | %s\n", "threads", "ms/frame", "speedup", "checksum");
+    double serialChecksum;
+    double serialMs = run(ballCount, frames, 0, &serialChecksum);
+    printf("%-7s | %10.2f | %8s | %.6e\n", "serial", serialMs, "-", serialChecksum);
+    double baseMs = 0.0;
+    for (int threadCount = 1; threadCount <= maxThreads; threadCount *= 2) {
+        double checksum;
+        double ms = run(ballCount, frames, threadCount, &checksum);
+        if (threadCount == 1) baseMs = ms;
+        printf("%-7d | %10.2f | %7.2fx | %.6e%s\n", threadCount, ms, baseMs / ms, checksum,
+               checksum == serialChecksum ? "" : "  MISMATCH");
+    }
+}
+
+int main(int argc, char** argv) {
+    int ballCount = (argc > 1) ? atoi(argv[1]) : 50000;
+    int frames = (argc > 2) ? atoi(argv[2]) : 60;
+    int maxThreads = (argc > 3) ? atoi(argv[3]) : 16;
+
+    printScaling("ball vs GameObject", runObjectPass, ballCount, frames, maxThreads);
+    printf("\n");
+    printScaling("ball-to-ball contacts", runContactPass, ballCount, frames, maxThreads);
+    return 0;
+}
@@ -0,0 +1,145 @@
+// Benchmark: swept ball vs rectangle/diamond, per-edge scalar tests vs the polygon kernel
+//
+// The scalar path is what checkCollisionRectangleObj/checkCollisionDiamondObj did before
+// sweptBallToStaticPolygonCollision: one sweptBallToStaticSegmentCollision per edge, keeping the
+// earliest hit. Both run on the same random balls (most of them close enough to hit the shape
+// within dt), and the results are compared: hit/miss disagreements, largest difference of time
+// of impact and smallest dot product between the two normals.
+//
+// Usage: bench_polygon_sweep [cases] [repeats]
+
+#include "../include/common.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <math.h>
+
+typedef struct {
+    Vector2 vertices[4];
+    Vector2 position;
+    Vector2 velocity;
+    float radius;
+    float dt;
+} SweepCase;
+
+static double nowSeconds(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+}
+
+static float randomRange(float min, float max) {
+    return min + (max - min) * (float)rand() / RAND_MAX;
+}
+
+// Earliest hit over the edges, one segment test per edge (the previous narrowphase)
+static bool scalarPolygonCollision(const Vector2* vertices, int vertexCount, Vector2 ballPos, Vector2 ballVel,
+                                   float ballRadius, float dt, float* toi, Vector2* normal) {
+    float minToi = dt + EPSILON2;
+    bool collided = false;
+    for (int i = 0; i < vertexCount; ++i) {
+        float segmentToi;
+        Vector2 segmentNormal;
+        if (sweptBallToStaticSegmentCollision(vertices[i], vertices[(i + 1) % vertexCount],
+                                              ballPos, ballVel, ballRadius, dt, &segmentToi, &segmentNormal)) {
+            if (segmentToi >= -EPSILON2 && segmentToi < minToi) {
+                minToi = segmentToi;
+                *normal = segmentNormal;
+                collided = true;
+            }
+        }
+    }
+    if (collided) *toi = minToi;
+    return collided;
+}
+
+typedef bool (*PolygonSweep)(const Vector2* vertices, int vertexCount, Vector2 ballPos, Vector2 ballVel,
+                             float ballRadius, float dt, float* toi, Vector2* normal);
+
+// Half rectangles, half diamonds; balls within 40 px of the shape moving at up to 3000 px/s
+static void createCases(SweepCase* cases, int count) {
+    for (int i = 0; i < count; i++) {
+        SweepCase* c = &cases[i];
+        Vector2 center = { randomRange(100, 900), randomRange(100, 600) };
+        float hw = randomRange(5.0f, 40.0f), hh = randomRange(5.0f, 40.0f);
+        if (i % 2 == 0) {
+            c->vertices[0] = (Vector2){ center.x - hw, center.y - hh };
+            c->vertices[1] = (Vector2){ center.x + hw, center.y - hh };
+            c->vertices[2] = (Vector2){ center.x + hw, center.y + hh };
+            c->vertices[3] = (Vector2){ center.x - hw, center.y + hh };
+        } else {
+            c->vertices[0] = (Vector2){ center.x, center.y - hh };
+            c->vertices[1] = (Vector2){ center.x + hw, center.y };
+            c->vertices[2] = (Vector2){ center.x, center.y + hh };
+            c->vertices[3] = (Vector2){ center.x - hw, center.y };
+        }
+        float angle = randomRange(0.0f, 2.0f * PI);
+        float distance = randomRange(0.0f, 40.0f) + fmaxf(hw, hh);
+        c->position = (Vector2){ center.x + cosf(angle) * distance, center.y + sinf(angle) * distance };
+        c->velocity = (Vector2){ randomRange(-3000.0f, 3000.0f), randomRange(-3000.0f, 3000.0f) };
+        c->radius = randomRange(2.0f, 20.0f);
+        c->dt = 1.0f / 120.0f;
+    }
+}
+
+// Run every case `repeats` times, return ns per call
+static double timeSweep(PolygonSweep sweep, const SweepCase* cases, int count, int repeats, int* hits) {
+    int hitCount = 0;
+    double start = nowSeconds();
+    for (int r = 0; r < repeats; r++) {
+        for (int i = 0; i < count; i++) {
+            const SweepCase* c = &cases[i];
+            float toi;
+            Vector2 normal;
+            hitCount += sweep(c->vertices, 4, c->position, c->velocity, c->radius, c->dt, &toi, &normal);
+        }
+    }
+    double elapsed = nowSeconds() - start;
+    *hits = hitCount / repeats;
+    return elapsed * 1e9 / ((double)count * repeats);
+}
+
+int main(int argc, char** argv) {
+    int count = (argc > 1) ? atoi(argv[1]) : 100000;
+    int repeats = (argc > 2) ? atoi(argv[2]) : 20;
+    if (count < 1) count = 1;
+    if (repeats < 1) repeats = 1;
+
+    SweepCase* cases = (SweepCase*)malloc((size_t)count * sizeof(SweepCase));
+    if (!cases) return 1;
+    srand(3);
+    createCases(cases, count);
+
+    // Agreement between the two paths
+    int mismatches = 0, bothHit = 0;
+    float maxToiDiff = 0.0f, minNormalDot = 1.0f;
+    for (int i = 0; i < count; i++) {
+        const SweepCase* c = &cases[i];
+        float toiScalar = 0.0f, toiKernel = 0.0f;
+        Vector2 normalScalar = {0}, normalKernel = {0};
+        bool hitScalar = scalarPolygonCollision(c->vertices, 4, c->position, c->velocity, c->radius, c->dt, &toiScalar, &normalScalar);
+        bool hitKernel = sweptBallToStaticPolygonCollision(c->vertices, 4, c->position, c->velocity, c->radius, c->dt, &toiKernel, &normalKernel);
+        if (hitScalar != hitKernel) {
+            mismatches++;
+        } else if (hitScalar) {
+            bothHit++;
+            maxToiDiff = fmaxf(maxToiDiff, fabsf(toiScalar - toiKernel));
+            minNormalDot = fminf(minNormalDot, Vector2DotProduct(normalScalar, normalKernel));
+        }
+    }
+
+    int scalarHits, kernelHits;
+    double scalarNs = timeSweep(scalarPolygonCollision, cases, count, repeats, &scalarHits);
+    double kernelNs = timeSweep(sweptBallToStaticPolygonCollision, cases, count, repeats, &kernelHits);
+
+    printf("%d balls vs rectangles/diamonds, %d repeats\n", count, repeats);
+    printf("%-16s | %8s | %s\n", "path", "ns/call", "hits");
+    printf("%-16s | %8.1f | %d\n", "per-edge scalar", scalarNs, scalarHits);
+    printf("%-16s | %8.1f | %d\n", "polygon kernel", kernelNs, kernelHits);
+    printf("speedup          : %.2fx\n", scalarNs / kernelNs);
+    printf("hit mismatches   : %d\n", mismatches);
+    printf("both hit         : %d (max toi difference %.3g s, min normal dot %.6f)\n", bothHit, maxToiDiff, minNormalDot);
+
+    free(cases);
+    return 0;
+}
@@ -0,0 +1,348 @@
+// Benchmark: named, seeded scenarios of the whole simulation step, with a baseline
+//
+// Each scenario builds a world, then runs stepSimulation headless for a fixed number of
+// frames at a fixed dt, always from the same seed, so the work done (collision counters)
+// and the final state (checksum) only change when the physics changes.
+// For each scenario it reports the time per ball and per frame, the number of narrowphase
+// calls (checkCollision, ball vs GameObject) and of ball pairs tested per frame.
+//
+// With --save the results are written to the baseline file. Otherwise, if the baseline file
+// exists, every scenario is compared with it: a time per ball and per frame or a number of
+// narrowphase calls more than `threshold` percent above the baseline is a regression, and
+// the benchmark exits with status 1. A different checksum is reported, but is not an error
+// (it is expected when a change alters the physics).
+//
+// Usage: bench_scenarios [--save] [--baseline file] [--threshold percent] [--threads n] [scenario...]
+//   baseline : build/scenarios_baseline.txt by default
+//   threshold: 10 by default
+//   threads  : 1 by default, so timings are comparable between machines of different sizes
+//   scenario : arcs, flood, maze, fast, sparse, events, crowd, settle or awake; all of them by default
+
+#include "../include/common.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+GameObject* createRectangleObject(Vector2 position, Vector2 velocity, float width, float height, Color color, bool isStatic);
+GameObject* createArcCircleObject(Vector2 position, Vector2 velocity, float radius, float startAngle, float endAngle, float thickness, Color color, bool isStatic, float rotationSpeed, bool removeEscapedBalls);
+
+#define SCENARIO_DT (1.0f / 120.0f)
+#define DEFAULT_BASELINE_PATH "build/scenarios_baseline.txt"
+#define MAX_BASELINE_ENTRIES 32
+
+typedef struct {
+    const char* name;
+    const char* description;
+    unsigned int seed;
+    int frames;
+    float dt;
+    void (*setup)(Simulation* sim);
+    void (*spawn)(Simulation* sim, int frame); // Called before every step
+} Scenario;
+
+typedef struct {
+    char name[32];
+    double nsPerBallFrame;
+    double narrowphasePerFrame;
+    double pairTestsPerFrame;
+    int ballsLeft;
+    double checksum;
+} ScenarioResult;
+
+static double nowSeconds(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+}
+
+static float randomRange(float min, float max) {
+    return min + (max - min) * (float)rand() / RAND_MAX;
+}
+
+static double ballChecksum(const BallStore* balls) {
+    double sum = 0.0;
+    for (int i = 0; i < balls->count; i++) {
+        sum += balls->posX[i] + 3.0 * balls->posY[i] + 5.0 * balls->velX[i] + 7.0 * balls->velY[i];
+    }
+    return sum;
+}
+
+// --- Scenarios ---
+
+// The arcs of the game (createArcScene) without the escape callback: in the game the arcs
+// disappear within the first frames, which would leave nothing for the arc narrowphase to do
+static void createPersistentArcs(Simulation* sim) {
+    for (int i = 0; i < 10; i++) {
+        addSimulationObject(sim, createArcCircleObject((Vector2){ SCREEN_WIDTH * 0.5f, SCREEN_HEIGHT * 0.5f },
+                                                       (Vector2){ 0, 0 }, 50 + i * 25, 0.0f, 300.0f, 5.0f,
+                                                       RED, false, 60.0f + i * 20, false));
+    }
+}
+
+// Balls spawned at the center in bursts of 25 up to 1000, as in the game
+static void spawnArcBalls(Simulation* sim, int frame) {
+    for (int i = 0; i < 25 && frame * 25 + i < 1000; i++) {
+        spawnRandomBall(sim, (Vector2){ SCREEN_WIDTH * 0.5f, SCREEN_HEIGHT * 0.5f });
+    }
+}
+
+// Ball flood: no obstacle, 100 small interacting balls poured from the top every frame up to 5000
+static void spawnFloodBalls(Simulation* sim, int frame) {
+    for (int i = 0; i < 100 && frame * 100 + i < 5000; i++) {
+        Vector2 position = { randomRange(10.0f, SCREEN_WIDTH - 10.0f), randomRange(10.0f, 60.0f) };
+        Vector2 velocity = { randomRange(-150.0f, 150.0f), randomRange(100.0f, 300.0f) };
+        createBouncingObject(&sim->balls, position, velocity, randomRange(2.0f, 4.0f), YELLOW,
+                             randomRange(0.5f, 2.0f), 1.0f, true);
+    }
+}
+
+// Dense maze: one wall per 40x40 cell of the screen, horizontal or vertical at random,
+// and 2000 balls spread over the screen at once
+static void createMaze(Simulation* sim) {
+    const float cell = 40.0f;
+    for (float y = cell * 0.5f; y < SCREEN_HEIGHT; y += cell) {
+        for (float x = cell * 0.5f; x < SCREEN_WIDTH; x += cell) {
+            bool horizontal = rand() % 2 == 0;
+            addSimulationObject(sim, createRectangleObject((Vector2){ x, y }, (Vector2){ 0, 0 },
+                                                           horizontal ? cell : 4.0f, horizontal ? 4.0f : cell,
+                                                           SKYBLUE, true));
+        }
+    }
+}
+
+static void spawnMazeBalls(Simulation* sim, int frame) {
+    if (frame != 0) return;
+    for (int i = 0; i < 2000; i++) {
+        Vector2 position = { randomRange(0, SCREEN_WIDTH), randomRange(0, SCREEN_HEIGHT) };
+        Vector2 velocity = { randomRange(-300.0f, 300.0f), randomRange(-300.0f, 300.0f) };
+        createBouncingObject(&sim->balls, position, velocity, randomRange(2.0f, 4.0f), YELLOW, 1.0f, 1.0f, false);
+    }
+}
+
+// Sparse, fast scene: 60 scattered rectangles and 300 small interacting balls at up to
+// 1500 px/s, run with the substep passes (sparse) and with the event-driven mode (events)
+static void createSparseScene(Simulation* sim) {
+    for (int i = 0; i < 60; i++) {
+        Vector2 position = { randomRange(50.0f, SCREEN_WIDTH - 50.0f), randomRange(50.0f, SCREEN_HEIGHT - 50.0f) };
+        addSimulationObject(sim, createRectangleObject(position, (Vector2){ 0, 0 }, randomRange(10.0f, 40.0f),
+                                                       randomRange(10.0f, 40.0f), SKYBLUE, true));
+    }
+}
+
+static void createSparseSceneEvents(Simulation* sim) {
+    sim->mode = SIMULATION_EVENTS;
+    createSparseScene(sim);
+}
+
+static void spawnSparseBalls(Simulation* sim, int frame) {
+    if (frame != 0) return;
+    for (int i = 0; i < 300; i++) {
+        Vector2 position = { randomRange(0, SCREEN_WIDTH), randomRange(0, SCREEN_HEIGHT) };
+        Vector2 velocity = { randomRange(-1500.0f, 1500.0f), randomRange(-1500.0f, 1500.0f) };
+        createBouncingObject(&sim->balls, position, velocity, randomRange(2.0f, 4.0f), YELLOW,
+                             randomRange(0.5f, 2.0f), 1.0f, true);
+    }
+}
+
+// Dense event-driven scene: the sparse obstacles and 2400 larger, slower interacting balls in
+// SIMULATION_EVENTS mode, so that most events are ball pairs (crowd)
+static void spawnCrowdBalls(Simulation* sim, int frame) {
+    if (frame != 0) return;
+    for (int i = 0; i < 2400; i++) {
+        Vector2 position = { randomRange(0, SCREEN_WIDTH), randomRange(0, SCREEN_HEIGHT) };
+        Vector2 velocity = { randomRange(-400.0f, 400.0f), randomRange(-400.0f, 400.0f) };
+        createBouncingObject(&sim->balls, position, velocity, randomRange(4.0f, 8.0f), YELLOW,
+                             randomRange(0.5f, 2.0f), 0.95f, true);
+    }
+}
+
+// Settling scene: the maze with 2000 interacting, barely bouncy balls which come to rest within
+// a few hundred frames, with sleeping balls (settle) and with every ball kept awake (awake)
+static void spawnSettlingBalls(Simulation* sim, int frame) {
+    if (frame != 0) return;
+    for (int i = 0; i < 2000; i++) {
+        Vector2 position = { randomRange(0, SCREEN_WIDTH), randomRange(0, SCREEN_HEIGHT) };
+        Vector2 velocity = { randomRange(-300.0f, 300.0f), randomRange(-300.0f, 300.0f) };
+        createBouncingObject(&sim->balls, position, velocity, randomRange(2.0f, 4.0f), YELLOW, 1.0f, 0.3f, true);
+    }
+}
+
+static void createMazeAwake(Simulation* sim) {
+    sim->sleepSteps = 0;
+    createMaze(sim);
+}
+
+static const Scenario scenarios[] = {
+    { "arcs",   "10 rotating arcs, 1000 balls from the center", 1234, 1200, SCENARIO_DT,         createPersistentArcs,    spawnArcBalls },
+    { "flood",  "5000 interacting balls, no obstacle",          42,   600,  SCENARIO_DT,         NULL,                    spawnFloodBalls },
+    { "maze",   "2000 balls in a maze of 486 rectangles",       7,    600,  SCENARIO_DT,         createMaze,              spawnMazeBalls },
+    { "fast",   "the arcs scene at 10x speed (timeMultiplier)", 1234, 1200, SCENARIO_DT * 10.0f, createPersistentArcs,    spawnArcBalls },
+    { "sparse", "300 fast interacting balls, 60 rectangles",    99,   1200, SCENARIO_DT,         createSparseScene,       spawnSparseBalls },
+    { "events", "the sparse scene in SIMULATION_EVENTS mode",   99,   1200, SCENARIO_DT,         createSparseSceneEvents, spawnSparseBalls },
+    { "crowd",  "2400 interacting balls in SIMULATION_EVENTS mode", 99, 600, SCENARIO_DT,       createSparseSceneEvents, spawnCrowdBalls },
+    { "settle", "the maze, 2000 balls coming to rest",          7,    1200, SCENARIO_DT,         createMaze,              spawnSettlingBalls },
+    { "awake",  "the settle scene without sleeping balls",      7,    1200, SCENARIO_DT,         createMazeAwake,         spawnSettlingBalls },
+};
+static const int scenarioCount = sizeof(scenarios) / sizeof(scenarios[0]);
+
+static void runScenario(const Scenario* scenario, int threadCount, ScenarioResult* result) {
+    srand(scenario->seed);
+    Simulation sim;
+    initSimulation(&sim, threadCount);
+    seedSimulation(&sim, scenario->seed);
+    if (scenario->setup) scenario->setup(&sim);
+    resetCollisionStats();
+
+    double stepTime = 0.0;
+    long long ballFrames = 0; // Sum over the frames of the number of balls stepped
+    for (int f = 0; f < scenario->frames; f++) {
+        scenario->spawn(&sim, f);
+        ballFrames += sim.balls.count;
+
+        double start = nowSeconds();
+        stepSimulation(&sim, scenario->dt);
+        stepTime += nowSeconds() - start;
+    }
+
+    CollisionStats stats = getCollisionStats();
+    snprintf(result->name, sizeof(result->name), "%s", scenario->name);
+    result->nsPerBallFrame = (ballFrames > 0) ? stepTime * 1e9 / (double)ballFrames : 0.0;
+    result->narrowphasePerFrame = (double)stats.narrowphaseCalls / scenario->frames;
+    result->pairTestsPerFrame = (double)stats.ballPairTests / scenario->frames;
+    result->ballsLeft = sim.balls.count;
+    result->checksum = ballChecksum(&sim.balls);
+
+    freeSimulation(&sim);
+}
+
+// --- Baseline file: one line per scenario, in the order of ScenarioResult ---
+
+static int loadBaseline(const char* path, ScenarioResult* entries) {
+    FILE* file = fopen(path, "r");
+    if (!file) return -1;
+    int count = 0;
+    char line[256];
+    while (count < MAX_BASELINE_ENTRIES && fgets(line, sizeof(line), file)) {
+        if (line[0] == '#') continue;
+        ScenarioResult* entry = &entries[count];
+        if (sscanf(line, "%31s %lf %lf %lf %d %lf", entry->name, &entry->nsPerBallFrame,
+                   &entry->narrowphasePerFrame, &entry->pairTestsPerFrame,
+                   &entry->ballsLeft, &entry->checksum) == 6) {
+            count++;
+        }
+    }
+    fclose(file);
+    return count;
+}
+
+static bool saveBaseline(const char* path, const ScenarioResult* results, int count) {
+    FILE* file = fopen(path, "w");
+    if (!file) return false;
+    fprintf(file, "# name ns/ball/frame narrowphase/frame pairTests/frame ballsLeft checksum\n");
+    for (int i = 0; i < count; i++) {
+        fprintf(file, "%s %.3f %.3f %.3f %d %.17g\n", results[i].name, results[i].nsPerBallFrame,
+                results[i].narrowphasePerFrame, results[i].pairTestsPerFrame,
+                results[i].ballsLeft, results[i].checksum);
+    }
+    fclose(file);
+    return true;
+}
+
+static const ScenarioResult* findBaseline(const ScenarioResult* entries, int count, const char* name) {
+    for (int i = 0; i < count; i++) {
+        if (strcmp(entries[i].name, name) == 0) return &entries[i];
+    }
+    return NULL;
+}
+
+// Percentage of change from `base` to `value` (0 when there is no base)
+static double percentChange(double value, double base) {
+    return (base > 0.0) ? (value - base) * 100.0 / base : 0.0;
+}
+
+static const Scenario* findScenario(const char* name) {
+    for (int i = 0; i < scenarioCount; i++) {
+        if (strcmp(scenarios[i].name, name) == 0) return &scenarios[i];
+    }
+    return NULL;
+}
+
+int main(int argc, char** argv) {
+    bool save = false;
+    const char* baselinePath = DEFAULT_BASELINE_PATH;
+    double threshold = 10.0;
+    int threadCount = 1;
+    const Scenario* selected[MAX_BASELINE_ENTRIES];
+    int selectedCount = 0;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--save") == 0) {
+            save = true;
+        } else if (strcmp(argv[i], "--baseline") == 0 && i + 1 < argc) {
+            baselinePath = argv[++i];
+        } else if (strcmp(argv[i], "--threshold") == 0 && i + 1 < argc) {
+            threshold = atof(argv[++i]);
+        } else if (strcmp(argv[i], "--threads") == 0 && i + 1 < argc) {
+            threadCount = atoi(argv[++i]);
+        } else if (findScenario(argv[i]) && selectedCount < MAX_BASELINE_ENTRIES) {
+            selected[selectedCount++] = findScenario(argv[i]);
+        } else {
+            fprintf(stderr, "Unknown argument '%s'\n", argv[i]);
+            fprintf(stderr, "Usage: %s [--save] [--baseline file] [--threshold percent] [--threads n] [scenario...]\n", argv[0]);
+            for (int j = 0; j < scenarioCount; j++) fprintf(stderr, "  %-6s %s\n", scenarios[j].name, scenarios[j].description);
+            return 2;
+        }
+    }
+    if (selectedCount == 0) {
+        for (int i = 0; i < scenarioCount; i++) selected[selectedCount++] = &scenarios[i];
+    }
+
+    ScenarioResult baseline[MAX_BASELINE_ENTRIES];
+    int baselineCount = save ? -1 : loadBaseline(baselinePath, baseline);
+    if (!save) {
+        if (baselineCount < 0) printf("No baseline at %s (run with --save to create it)\n", baselinePath);
+        else printf("Comparing with %s (threshold %.1f%%)\n", baselinePath, threshold);
+    }
+
+    printf("%-6s | %8s | %14s | %18s | %16s | %s\n",
+           "name", "frames", "ns/ball/frame", "narrowphase/frame", "pairTests/frame", "checksum");
+
+    ScenarioResult results[MAX_BASELINE_ENTRIES];
+    int regressions = 0;
+    for (int s = 0; s < selectedCount; s++) {
+        const Scenario* scenario = selected[s];
+        ScenarioResult* result = &results[s];
+        runScenario(scenario, threadCount, result);
+        printf("%-6s | %8d | %14.1f | %18.1f | %16.1f | %.6e\n", result->name, scenario->frames,
+               result->nsPerBallFrame, result->narrowphasePerFrame, result->pairTestsPerFrame, result->checksum);
+
+        const ScenarioResult* base = (baselineCount > 0) ? findBaseline(baseline, baselineCount, result->name) : NULL;
+        if (!base) continue;
+
+        double timeChange = percentChange(result->nsPerBallFrame, base->nsPerBallFrame);
+        double callChange = percentChange(result->narrowphasePerFrame, base->narrowphasePerFrame);
+        printf("       |  vs base | %+13.1f%% | %+17.1f%% | %+15.1f%% | %s\n", timeChange, callChange,
+               percentChange(result->pairTestsPerFrame, base->pairTestsPerFrame),
+               (result->checksum == base->checksum && result->ballsLeft == base->ballsLeft) ? "same" : "changed");
+        if (timeChange > threshold) {
+            printf("REGRESSION: %s takes %.1f%% more time per ball and per frame\n", result->name, timeChange);
+            regressions++;
+        }
+        if (callChange > threshold) {
+            printf("REGRESSION: %s makes %.1f%% more narrowphase calls\n", result->name, callChange);
+            regressions++;
+        }
+    }
+
+    freeCollisionEffectPool();
+
+    if (save) {
+        if (!saveBaseline(baselinePath, results, selectedCount)) {
+            fprintf(stderr, "Could not write the baseline to %s\n", baselinePath);
+            return 1;
+        }
+        printf("Baseline saved to %s\n", baselinePath);
+    }
+    return (regressions > 0) ? 1 : 0;
+}
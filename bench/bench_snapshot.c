@@ -0,0 +1,163 @@
+// Benchmark: saving and loading world snapshots
+//
+// Builds a world of rotating arcs, rectangles and diamonds with effects, and `balls` balls
+// (one in ten with an effect), steps it for a while, then times saveSimulationSnapshot and
+// loadSimulationSnapshot. Loading is compared with rebuilding the same balls one at a time
+// with createBouncingObject.
+// The loaded world and the original are then both stepped: their balls must stay identical,
+// bit for bit, otherwise the benchmark exits with status 1.
+//
+// Usage: bench_snapshot [balls] [threads] [frames]
+//   frames: steps compared after the load, 240 by default
+
+#include "../include/common.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+GameObject* createRectangleObject(Vector2 position, Vector2 velocity, float width, float height, Color color, bool isStatic);
+GameObject* createDiamondObject(Vector2 position, Vector2 velocity, float diagWidth, float diagHeight, Color color, bool isStatic);
+GameObject* createArcCircleObject(Vector2 position, Vector2 velocity, float radius, float startAngle, float endAngle, float thickness, Color color, bool isStatic, float rotationSpeed, bool removeEscapedBalls);
+void addCollisionEffectsToGameObject(GameObject* obj, CollisionEffect* effectsList);
+int Count_GameObjects(GameObject* head);
+
+#define SNAPSHOT_PATH "build/bench_snapshot.bin"
+#define SNAPSHOT_DT (1.0f / 120.0f)
+#define SNAPSHOT_REPEATS 10
+
+static double nowSeconds(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+}
+
+static float randomRange(Simulation* sim, float min, float max) {
+    return min + (max - min) * simulationRandomFloat(sim);
+}
+
+static void buildWorld(Simulation* sim, int ballCount) {
+    for (int i = 0; i < 6; i++) {
+        GameObject* arc = createArcCircleObject((Vector2){ SCREEN_WIDTH * 0.5f, SCREEN_HEIGHT * 0.5f }, (Vector2){ 0, 0 },
+                                                80 + i * 40, 0.0f, 280.0f, 6.0f, RED, false, 30.0f + i * 15.0f, false);
+        if (i % 2 == 0) setArcCircleSweptRotation(arc, true);
+        addSimulationObject(sim, arc);
+    }
+    for (int i = 0; i < 40; i++) {
+        Vector2 position = { randomRange(sim, 0, SCREEN_WIDTH), randomRange(sim, 0, SCREEN_HEIGHT) };
+        Vector2 velocity = { randomRange(sim, -60.0f, 60.0f), randomRange(sim, -60.0f, 60.0f) };
+        GameObject* obj = (i % 2 == 0)
+            ? createRectangleObject(position, velocity, randomRange(sim, 10, 60), randomRange(sim, 10, 60), SKYBLUE, i % 4 != 0)
+            : createDiamondObject(position, velocity, randomRange(sim, 10, 60), randomRange(sim, 10, 60), GREEN, i % 4 != 1);
+        CollisionEffect* effects = NULL;
+        addEffectToList(&effects, createColorChangeEffect(ORANGE, false));
+        if (i % 3 == 0) addEffectToList(&effects, createVelocityDampenEffect(0.9f, false));
+        addCollisionEffectsToGameObject(obj, effects);
+        addSimulationObject(sim, obj);
+    }
+    for (int i = 0; i < ballCount; i++) {
+        Vector2 position = { randomRange(sim, 0, SCREEN_WIDTH), randomRange(sim, 0, SCREEN_HEIGHT) };
+        Vector2 velocity = { randomRange(sim, -300.0f, 300.0f), randomRange(sim, -300.0f, 300.0f) };
+        BallHandle ball = createBouncingObject(&sim->balls, position, velocity, randomRange(sim, 1.5f, 3.0f),
+                                               YELLOW, 1.0f, 0.9f, i % 2 == 0);
+        if (i % 10 == 0) addCollisionEffectsToBouncingObject(&sim->balls, ball, createSizeChangeEffect(1.01f, false));
+    }
+}
+
+// Whether the balls of both stores are the same, bit for bit
+static bool sameBalls(const BallStore* a, const BallStore* b) {
+    if (a->count != b->count) return false;
+    size_t n = (size_t)a->count;
+    return memcmp(a->posX, b->posX, n * sizeof(float)) == 0 && memcmp(a->posY, b->posY, n * sizeof(float)) == 0 &&
+           memcmp(a->velX, b->velX, n * sizeof(float)) == 0 && memcmp(a->velY, b->velY, n * sizeof(float)) == 0 &&
+           memcmp(a->radius, b->radius, n * sizeof(float)) == 0 && memcmp(a->flags, b->flags, n) == 0 &&
+           memcmp(a->color, b->color, n * sizeof(Color)) == 0;
+}
+
+int main(int argc, char** argv) {
+    int ballCount = (argc > 1) ? atoi(argv[1]) : 100000;
+    int threadCount = (argc > 2) ? atoi(argv[2]) : 0;
+    int frames = (argc > 3) ? atoi(argv[3]) : 240;
+
+    Simulation sim;
+    initSimulation(&sim, threadCount);
+    seedSimulation(&sim, 2024);
+    buildWorld(&sim, ballCount);
+    for (int f = 0; f < 60; f++) stepSimulation(&sim, SNAPSHOT_DT);
+
+    double saveTime = 1e30;
+    for (int k = 0; k < SNAPSHOT_REPEATS; k++) {
+        double start = nowSeconds();
+        if (!saveSimulationSnapshot(&sim, SNAPSHOT_PATH)) {
+            printf("could not write %s\n", SNAPSHOT_PATH);
+            return 1;
+        }
+        double elapsed = nowSeconds() - start;
+        if (elapsed < saveTime) saveTime = elapsed;
+    }
+    FILE* file = fopen(SNAPSHOT_PATH, "rb");
+    long fileSize = 0;
+    if (file) {
+        fseek(file, 0, SEEK_END);
+        fileSize = ftell(file);
+        fclose(file);
+    }
+
+    Simulation loaded;
+    initSimulation(&loaded, threadCount);
+    double loadTime = 1e30;
+    for (int k = 0; k < SNAPSHOT_REPEATS; k++) {
+        double start = nowSeconds();
+        if (!loadSimulationSnapshot(&loaded, SNAPSHOT_PATH)) {
+            printf("could not load %s\n", SNAPSHOT_PATH);
+            return 1;
+        }
+        double elapsed = nowSeconds() - start;
+        if (elapsed < loadTime) loadTime = elapsed;
+    }
+
+    // The same balls created one at a time, for comparison
+    double createTime = 1e30;
+    for (int k = 0; k < SNAPSHOT_REPEATS; k++) {
+        BallStore store;
+        initBallStore(&store);
+        double start = nowSeconds();
+        for (int i = 0; i < sim.balls.count; i++) {
+            BallHandle ball = createBouncingObject(&store, (Vector2){ sim.balls.posX[i], sim.balls.posY[i] },
+                                                   (Vector2){ sim.balls.velX[i], sim.balls.velY[i] }, sim.balls.radius[i],
+                                                   sim.balls.color[i], sim.balls.mass[i], sim.balls.restitution[i],
+                                                   (sim.balls.flags[i] & BALL_FLAG_INTERACT_WITH_BALLS) != 0);
+            if (sim.balls.effects[i]) addCollisionEffectsToBouncingObject(&store, ball, cloneCollisionEffect(sim.balls.effects[i]));
+        }
+        double elapsed = nowSeconds() - start;
+        if (elapsed < createTime) createTime = elapsed;
+        freeBallStore(&store);
+    }
+
+    printf("%d balls, %d objects, snapshot of %.2f MB\n", sim.balls.count, Count_GameObjects(sim.objects), fileSize / 1e6);
+    printf("save                 : %8.3f ms (%.0f MB/s)\n", saveTime * 1e3, fileSize / 1e6 / saveTime);
+    printf("load                 : %8.3f ms (%.0f MB/s)\n", loadTime * 1e3, fileSize / 1e6 / loadTime);
+    printf("createBouncingObject : %8.3f ms for the balls alone\n", createTime * 1e3);
+
+    // Both worlds must now evolve the same way
+    bool identical = sameBalls(&sim.balls, &loaded.balls) && sim.rngState == loaded.rngState;
+    int firstDifference = identical ? -1 : 0;
+    for (int f = 0; f < frames && identical; f++) {
+        stepSimulation(&sim, SNAPSHOT_DT);
+        stepSimulation(&loaded, SNAPSHOT_DT);
+        if (!sameBalls(&sim.balls, &loaded.balls)) {
+            identical = false;
+            firstDifference = f + 1;
+        }
+    }
+    if (identical) {
+        printf("replay after load    : identical over %d steps\n", frames);
+    } else {
+        printf("replay after load    : DIFFERENT after %d steps\n", firstDifference);
+    }
+
+    freeSimulation(&sim);
+    freeSimulation(&loaded);
+    remove(SNAPSHOT_PATH);
+    return identical ? 0 : 1;
+}
@@ -0,0 +1,74 @@
+// Benchmark: spawning and deleting balls with effects at a high rate
+//
+// Every frame spawns a burst of balls (as holding space does in the simulation), each
+// with its own collision effect, and deletes the same number of the oldest balls.
+// After a warm-up the ball store and the effect pool must stop calling the system
+// allocator: the number of reallocations/slab allocations is reported for each phase.
+//
+// Usage: bench_spawn_churn [liveBalls] [burst] [frames]
+
+#include "../include/common.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+static double nowSeconds(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+}
+
+static void spawnBurst(BallStore* balls, int burst) {
+    for (int i = 0; i < burst; i++) {
+        Vector2 position = { (float)(rand() % SCREEN_WIDTH), (float)(rand() % SCREEN_HEIGHT) };
+        Vector2 velocity = { (float)(rand() % 400 - 200), (float)(rand() % 400 - 200) };
+        BallHandle ball = createBouncingObject(balls, position, velocity, 10.0f, YELLOW, 1.0f, 1.0f, true);
+        addCollisionEffectsToBouncingObject(balls, ball, createColorChangeEffect(RED, false));
+    }
+}
+
+// Mark the `count` oldest balls (the store keeps spawn order) and remove them
+static void deleteOldest(BallStore* balls, int count) {
+    for (int i = 0; i < count && i < balls->count; i++) {
+        balls->flags[i] |= BALL_FLAG_MARKED_FOR_DELETION;
+    }
+    removeMarkedBouncingObjects(balls);
+}
+
+static void runFrames(BallStore* balls, int burst, int frames) {
+    for (int f = 0; f < frames; f++) {
+        spawnBurst(balls, burst);
+        deleteOldest(balls, burst);
+    }
+}
+
+int main(int argc, char** argv) {
+    int liveBalls = (argc > 1) ? atoi(argv[1]) : 2000;
+    int burst = (argc > 2) ? atoi(argv[2]) : 25;
+    int frames = (argc > 3) ? atoi(argv[3]) : 20000;
+    srand(1234);
+
+    BallStore balls;
+    initBallStore(&balls);
+    spawnBurst(&balls, liveBalls);
+    runFrames(&balls, burst, 100); // Warm-up
+
+    const ObjectPool* effects = getCollisionEffectPool();
+    int storeGrowsBefore = balls.growCount;
+    int poolAllocsBefore = effects->systemAllocCount;
+
+    double start = nowSeconds();
+    runFrames(&balls, burst, frames);
+    double elapsed = nowSeconds() - start;
+
+    printf("%d live balls, %d spawned + %d deleted per frame, %d frames\n", liveBalls, burst, burst, frames);
+    printf("time per spawn+delete   : %.1f ns\n", elapsed * 1e9 / ((double)frames * burst));
+    printf("store reallocations     : %d (warm-up) + %d (steady state)\n", storeGrowsBefore, balls.growCount - storeGrowsBefore);
+    printf("effect pool system allocs: %d (warm-up) + %d (steady state)\n", poolAllocsBefore, effects->systemAllocCount - poolAllocsBefore);
+    printf("effect pool: %d live, %d peak, %lld allocs, %lld frees, %d slabs\n",
+           effects->liveCount, effects->peakLiveCount, effects->allocCount, effects->freeCount, effects->slabCount);
+
+    freeBallStore(&balls);
+    freeCollisionEffectPool();
+    return 0;
+}
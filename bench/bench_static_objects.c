@@ -0,0 +1,123 @@
+// Benchmark: ball vs GameObject collisions, linear scan of the object list vs AABB tree
+//
+// For each obstacle count, a screen-sized scene is filled with a mix of rectangles,
+// diamonds and rotating arcs (some of them moving), then the same balls are simulated
+// once walking the whole list and once querying the tree.
+//
+// Usage: bench_static_objects [ballCount] [frames]
+
+#include "../include/common.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <math.h>
+
+GameObject* createRectangleObject(Vector2 position, Vector2 velocity, float width, float height, Color color, bool isStatic);
+GameObject* createDiamondObject(Vector2 position, Vector2 velocity, float diagWidth, float diagHeight, Color color, bool isStatic);
+GameObject* createArcCircleObject(Vector2 position, Vector2 velocity, float radius, float startAngle, float endAngle, float thickness, Color color, bool isStatic, float rotationSpeed, bool removeEscapedBalls);
+void addObjectToList(GameObject** head, GameObject* newObject);
+void freeObjectList(GameObject** head);
+void updateObjectList(GameObject* head, float dt);
+
+static double nowSeconds(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+}
+
+static float randomRange(float min, float max) {
+    return min + (max - min) * (float)rand() / RAND_MAX;
+}
+
+// Obstacles laid out on a jittered grid covering the screen
+static GameObject* createObstacles(int count, unsigned int seed) {
+    srand(seed);
+    GameObject* list = NULL;
+    int cols = (int)ceilf(sqrtf((float)count * SCREEN_WIDTH / SCREEN_HEIGHT));
+    int rows = (count + cols - 1) / cols;
+    float cellW = (float)SCREEN_WIDTH / cols;
+    float cellH = (float)SCREEN_HEIGHT / rows;
+    float size = 0.45f * fminf(cellW, cellH);
+
+    for (int i = 0; i < count; i++) {
+        Vector2 center = {
+            ((float)(i % cols) + 0.5f) * cellW + randomRange(-0.1f, 0.1f) * cellW,
+            ((float)(i / cols) + 0.5f) * cellH + randomRange(-0.1f, 0.1f) * cellH
+        };
+        bool isStatic = (rand() % 10) != 0; // 10% of the obstacles move
+        Vector2 velocity = { randomRange(-20.0f, 20.0f), randomRange(-20.0f, 20.0f) };
+        GameObject* obj = NULL;
+        switch (i % 3) {
+            case 0: obj = createRectangleObject(center, velocity, size, size * 0.5f, SKYBLUE, isStatic); break;
+            case 1: obj = createDiamondObject(center, velocity, size, size, GREEN, isStatic); break;
+            case 2: obj = createArcCircleObject(center, velocity, size * 0.5f, 0.0f, 270.0f, 2.0f, RED, isStatic, 90.0f, false); break;
+        }
+        addObjectToList(&list, obj);
+    }
+    return list;
+}
+
+static void createBalls(BallStore* balls, int count, unsigned int seed) {
+    srand(seed);
+    for (int i = 0; i < count; i++) {
+        Vector2 position = { randomRange(0, SCREEN_WIDTH), randomRange(0, SCREEN_HEIGHT) };
+        Vector2 velocity = { randomRange(-300.0f, 300.0f), randomRange(-300.0f, 300.0f) };
+        createBouncingObject(balls, position, velocity, randomRange(2.0f, 4.0f), YELLOW, 1.0f, 1.0f, false);
+    }
+}
+
+// Keep balls on screen without depending on main.c
+static void bounceOffScreenEdges(BouncingObject* ball) {
+    if (ball->position.x < ball->radius && ball->velocity.x < 0) ball->velocity.x *= -1;
+    if (ball->position.x > SCREEN_WIDTH - ball->radius && ball->velocity.x > 0) ball->velocity.x *= -1;
+    if (ball->position.y < ball->radius && ball->velocity.y < 0) ball->velocity.y *= -1;
+    if (ball->position.y > SCREEN_HEIGHT - ball->radius && ball->velocity.y > 0) ball->velocity.y *= -1;
+}
+
+// Simulate the scene and return the cost in nanoseconds per ball per frame
+static double runScene(int obstacleCount, int ballCount, int frames, bool useTree) {
+    const float dt = 1.0f / 120.0f;
+    GameObject* objects = createObstacles(obstacleCount, 42);
+    BallStore balls;
+    initBallStore(&balls);
+    createBalls(&balls, ballCount, 7);
+    AABBTree tree;
+    initAABBTree(&tree);
+    if (useTree) {
+        for (GameObject* obj = objects; obj != NULL; obj = obj->next) insertObjectInTree(&tree, obj);
+    }
+
+    double start = nowSeconds();
+    for (int f = 0; f < frames; f++) {
+        updateObjectList(objects, dt);
+        for (int i = 0; i < balls.count; i++) {
+            BouncingObject ball;
+            loadBouncingObject(&balls, i, &ball);
+            handleBouncingObjectCollisions(&ball, objects, useTree ? &tree : NULL, dt, 10);
+            bounceOffScreenEdges(&ball);
+            storeBouncingObject(&balls, i, &ball);
+        }
+    }
+    double elapsed = nowSeconds() - start;
+
+    freeObjectList(&objects);
+    freeAABBTree(&tree);
+    freeBallStore(&balls);
+    return elapsed * 1e9 / ((double)frames * ballCount);
+}
+
+int main(int argc, char** argv) {
+    int ballCount = (argc > 1) ? atoi(argv[1]) : 2000;
+    int frames = (argc > 2) ? atoi(argv[2]) : 120;
+    const int obstacleCounts[] = { 10, 50, 100, 500, 1000 };
+    const int sceneCount = sizeof(obstacleCounts) / sizeof(obstacleCounts[0]);
+
+    printf("%d balls, %d frames\n", ballCount, frames);
+    printf("%-9s | %16s | %16s | %8s\n", "obstacles", "list ns/ball/fr", "tree ns/ball/fr", "speedup");
+    for (int s = 0; s < sceneCount; s++) {
+        double listNs = runScene(obstacleCounts[s], ballCount, frames, false);
+        double treeNs = runScene(obstacleCounts[s], ballCount, frames, true);
+        printf("%-9d | %16.1f | %16.1f | %7.1fx\n", obstacleCounts[s], listNs, treeNs, listNs / treeNs);
+    }
+    return 0;
+}
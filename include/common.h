@@ -4,18 +4,24 @@
 #include "../include/raylib.h"
 #include "../include/raymath.h" // For Vector2 math functions
 #include <stdbool.h>
+#include <stddef.h>  // For size_t
+#include <stdint.h>  // For uint8_t, uint32_t
+#include <pthread.h> // For the worker thread pool
 #include <float.h>   // For FLT_MAX
 
 #define SCREEN_WIDTH 1080
 #define SCREEN_HEIGHT 720
 
 #define EPSILON2 0.0001f
+#define BOUNDS_MARGIN 1.0f // Extra distance added to bounding volumes so culling stays conservative
 
 // Forward declarations
 typedef struct Ball Ball;
 typedef struct GameObject GameObject;
 typedef struct BouncingObject BouncingObject;
 typedef struct CollisionEffect CollisionEffect;
+typedef struct AABBTree AABBTree;
+typedef struct CollisionEventBuffer CollisionEventBuffer;
 
 // Shape types
 typedef enum {
@@ -23,6 +29,7 @@ typedef enum {
     SHAPE_DIAMOND,
     SHAPE_CIRCLE_ARC, // Arc/Open circle
 } ShapeType;
+#define SHAPE_TYPE_COUNT (SHAPE_CIRCLE_ARC + 1)
 
 // --- Shape-specific data structures ---
 typedef struct {
@@ -59,6 +66,14 @@ typedef struct ArcCircleCallbackNode {
     struct ArcCircleCallbackNode* next;
 } ArcCircleCallbackNode;
 
+// Straight segment closing one end of an arc, from its inner corner to its outer corner
+typedef struct {
+    Vector2 direction;    // Unit vector from the inner corner to the outer corner
+    Vector2 normal;       // direction turned by 90 degrees
+    float length;
+    bool degenerate;      // Too short to be tested as a segment (the corners are tested as points)
+} ArcCap;
+
 typedef struct {
     float radius;         // Radius of the arc circle
     float startAngle;     // Start angle in degrees
@@ -66,8 +81,31 @@ typedef struct {
     float thickness;      // Thickness of the arc
     Color color;          // Color of the arc
     float rotation;       // Current rotation of the arc (for dynamic rotation)
+    float previousRotation; // Rotation before the last update, for interpolated rendering
     float rotationSpeed;  // Speed of rotation (degrees per second)
     bool removeEscapedBalls; // Whether balls that pass through the arc should be removed
+    bool sweptRotation;   // Collide with the arc as it turns during the step (see setArcCircleSweptRotation)
+
+    // Geometry derived from the fields above and the object's position, so the collision test
+    // is plain arithmetic. Refreshed by updateArcGeometry whenever the arc rotates or moves.
+    Vector2 startDir;     // Unit vectors from the center towards both ends of the arc,
+    Vector2 endDir;       // for angle tests without atan2f
+    bool wideArc;         // The arc spans more than 180 degrees
+    bool fullCircle;      // The arc spans 360 degrees or more (no gap)
+    float innerRadius;    // radius -/+ thickness/2
+    float outerRadius;
+    float outerRadiusSq;
+    Vector2 startInner;   // Corners of both ends of the arc
+    Vector2 startOuter;
+    Vector2 endInner;
+    Vector2 endOuter;
+    ArcCap startCap;      // startInner to startOuter
+    ArcCap endCap;        // endInner to endOuter
+
+    // Ring mesh for rendering, tessellated on the first draw (see buildArcMesh) and turned by
+    // the rotation when drawn
+    Vector2* meshDirs;    // meshSegments + 1 unit vectors from startAngle to endAngle, before rotation
+    int meshSegments;
     
     // Lists of callback functions
     ArcCircleCallbackNode* onCollisionCallbacks;  // Functions called when a ball collides with the arc
@@ -124,7 +162,21 @@ struct Ball {
     Color color;
 };
 
+// --- Handle to a ball in a BallStore ---
+// Stays valid while the ball exists, whatever happens to the other balls
+typedef struct {
+    uint32_t slot;       // Slot in the store's handle table
+    uint32_t generation; // Must match the slot's generation, which changes when the ball is removed
+} BallHandle;
+
+#define BALL_SLOT_NONE UINT32_MAX
+#define BALL_HANDLE_NULL ((BallHandle){ BALL_SLOT_NONE, 0 })
+
 // --- Bouncing Object structure ---
+// Working copy of one ball of a BallStore (see loadBouncingObject/storeBouncingObject),
+// used by the collision code and passed to callbacks
+#define BALL_MAX_PENDING_ESCAPES 8
+
 struct BouncingObject {
     Vector2 position;
     Vector2 velocity;
@@ -138,34 +190,446 @@ struct BouncingObject {
     // Linked list of effects to apply when this object collides
     CollisionEffect* onCollisionEffects;
     
-    // Pointer to the next bouncing object in the linked list
-    BouncingObject* next;
+    BallHandle handle;     // Handle of the ball this copy was loaded from
+    float frameElapsed;    // Time of the step already simulated by the collision pass (set by it)
+
+    // Swept arcs the ball leaves through their gap during the current collision query, with
+    // the time of the crossing: they wait for runPendingArcEscapes, which knows the ball's
+    // earliest hit on any object (see checkCollisionArcCircleObj)
+    GameObject* pendingEscapeArcs[BALL_MAX_PENDING_ESCAPES];
+    float pendingEscapeTimes[BALL_MAX_PENDING_ESCAPES];
+    int pendingEscapeCount;
+
+    // When set, arc callbacks and sounds triggered by this ball are queued here instead
+    // of being run, so the ball can be processed on a worker thread (see CollisionEvent)
+    CollisionEventBuffer* deferredEvents;
+};
+
+// --- Deferred collision side effects ---
+// Everything a ball's collision pass may do outside of the ball itself. Worker threads
+// record these events; they are run on the main thread afterwards, in ball order.
+typedef enum {
+    COLLISION_EVENT_ARC_CALLBACK, // Call `callback(object, ball)`
+    COLLISION_EVENT_SOUND         // Play `sound`
+} CollisionEventType;
+
+typedef struct {
+    CollisionEventType type;
+    BallHandle ball;
+    GameObject* object;
+    ArcCircleCallback callback;
+    Sound sound;
+    bool toggleSound;     // Stop the sound if it is already playing instead of playing it
+} CollisionEvent;
+
+struct CollisionEventBuffer {
+    CollisionEvent* events;
+    int count, capacity;
 };
 
+// --- Ball flags ---
+#define BALL_FLAG_INTERACT_WITH_BALLS  (1u << 0)
+#define BALL_FLAG_MARKED_FOR_DELETION  (1u << 1)
+#define BALL_FLAG_ASLEEP               (1u << 2) // At rest: skipped by the collision passes until woken
+
+// --- Sleeping balls (updateSleepingBalls) ---
+#define BALL_SLEEP_SPEED 5.0f // px/s: a ball slower than this is at rest
+#define BALL_SLEEP_STEPS 60   // Steps at rest before a ball falls asleep (half a second at SIMULATION_FIXED_DT)
+
+/**
+ * @brief Structure-of-arrays storage for all bouncing objects.
+ * Each property is a contiguous array indexed by a dense index in [0, count).
+ * Removing balls compacts the arrays, so long-lived references must use a BallHandle.
+ * @param slotOf For each dense index, the handle slot of the ball
+ * @param slotDense For each handle slot, the dense index of the ball (next free slot when free)
+ * @param slotGeneration For each handle slot, the generation of the ball currently using it
+ */
+typedef struct {
+    int count, capacity;
+
+    float* posX;
+    float* posY;
+    float* prevX;                 // Position at the start of the last step, for interpolated rendering
+    float* prevY;
+    float* velX;
+    float* velY;
+    float* radius;
+    float* mass;
+    float* restitution;
+    uint8_t* flags;               // BALL_FLAG_* bits
+    uint8_t* stillSteps;          // Consecutive steps slower than BALL_SLEEP_SPEED (stops at 255)
+    Color* color;
+    CollisionEffect** effects;    // Linked list of effects of each ball
+    uint32_t* slotOf;
+
+    uint32_t* slotDense;
+    uint32_t* slotGeneration;
+    int slotCount, slotCapacity;
+    uint32_t freeSlot;            // First free slot, BALL_SLOT_NONE if none
+
+    int growCount;                // Number of times the arrays were reallocated
+    int asleepCount;              // Balls with BALL_FLAG_ASLEEP after the last updateSleepingBalls
+} BallStore;
+
 // --- Generic Game Object structure (now represents non-bouncing objects) ---
 struct GameObject {
     ShapeType type;
     Vector2 position;    // Center of the shape
+    Vector2 previousPosition; // Position before the last update, for interpolated rendering
     Vector2 velocity;
     void* shapeData;     // Pointer to shape-specific data (e.g., ShapeDataRectangle)
     bool isStatic;       // If true, velocity is ignored, object doesn't move
     bool markedForDeletion; // If true, this object will be removed in the next frame
+    Vector2 boundsMin;   // Cached axis-aligned bounding box, refreshed by updateGameObjectBounds
+    Vector2 boundsMax;
+    AABBTree* tree;      // Tree this object is registered in (NULL if none)
+    int treeProxy;       // Index of this object's leaf in the tree
     
     // Linked list of effects to apply to bouncing objects that collide with this object
     CollisionEffect* onCollisionEffects;
 
     // Function pointers for polymorphism
-    void (*render)(GameObject* self);
+    // alpha: where to draw between the state before the last update (0) and the current state (1)
+    void (*render)(GameObject* self, float alpha);
     // dt_step: the maximum time interval for this collision check (e.g., remaining frame time)
     // timeOfImpact (OUT): calculated time until collision occurs within dt_step
     // collisionNormal (OUT): normal of the surface at the point of impact (pointing away from object surface)
     bool (*checkCollision)(GameObject* self, struct BouncingObject* bouncingObj, float dt_step, float* timeOfImpact, Vector2* collisionNormal);
     void (*update)(GameObject* self, float dt); // For moving objects
+    // Velocity of the object's surface at a point, for the collision response
+    // (NULL: the response treats the object as still)
+    Vector2 (*surfaceVelocity)(GameObject* self, Vector2 point);
     void (*destroy)(GameObject* self);          // To free shapeData and other resources
 
     GameObject* next; // For linked list
 };
 
+// --- Dynamic AABB tree over GameObjects (broadphase for ball-vs-object collisions) ---
+#define AABB_TREE_NULL -1
+#define AABB_TREE_MAX_DEPTH 64
+
+typedef struct {
+    Vector2 min, max;     // Bounds (for leaves: object bounds enlarged by a margin)
+    int parent;
+    int left, right;      // Children, AABB_TREE_NULL for leaves
+    int height;           // 0 for leaves, -1 for free nodes
+    int next;             // Next free node when in the free list
+    GameObject* object;   // Object of a leaf
+} AABBTreeNode;
+
+/**
+ * @brief Balanced bounding volume hierarchy over GameObjects.
+ * Objects register with insertObjectInTree and are refitted automatically by
+ * updateGameObjectBounds when they move out of their (enlarged) leaf box.
+ * @param maxObjectSpeed Largest speed of any inserted object, used to widen swept queries
+ */
+struct AABBTree {
+    AABBTreeNode* nodes;
+    int nodeCount, nodeCapacity;
+    int root;
+    int freeList;
+    float maxObjectSpeed;
+};
+
+// Called for each object found by queryAABBTree; return false to stop the query
+typedef bool (*AABBTreeVisitor)(GameObject* obj, void* userData);
+
+void initAABBTree(AABBTree* tree);
+void freeAABBTree(AABBTree* tree);
+bool insertObjectInTree(AABBTree* tree, GameObject* obj);
+void removeObjectFromTree(GameObject* obj);
+void moveObjectInTree(GameObject* obj);
+void queryAABBTree(const AABBTree* tree, Vector2 queryMin, Vector2 queryMax, AABBTreeVisitor visit, void* userData);
+
+// --- Uniform grid broadphase for ball-to-ball collisions ---
+typedef struct {
+    int a, b;            // Indices of the two balls in the arrays given to the grid
+} BallPair;
+
+/**
+ * @brief Uniform grid rebuilt every frame from the ball positions.
+ * The cell size is derived from the largest ball radius so that overlapping
+ * balls are always in the same or in neighbouring cells.
+ * @param cellStart For each cell, index of its first entry in cellEntries (cols*rows + 1 entries)
+ * @param cellEntries Ball indices sorted by cell
+ * @param pairs Overlapping pairs found by the last collectSpatialGridPairs call
+ * @param candidateCount Number of pairs tested by the last collectSpatialGridPairs call
+ */
+typedef struct {
+    float cellSize;
+    float invCellSize;
+    float originX, originY; // World position of the corner of cell (0, 0)
+    int cols, rows;
+    int ballCount;
+
+    int* cellStart;
+    int* cellEntries;
+    int* ballCell;          // Cell index of each ball
+    int cellCapacity, entryCapacity, ballCellCapacity;
+
+    BallPair* pairs;
+    int pairCount, pairCapacity;
+    int candidateCount;
+} SpatialGrid;
+
+void initSpatialGrid(SpatialGrid* grid);
+void freeSpatialGrid(SpatialGrid* grid);
+bool rebuildSpatialGrid(SpatialGrid* grid, const float* x, const float* y, const float* r, int count);
+int collectSpatialGridPairs(SpatialGrid* grid, const float* x, const float* y, const float* r);
+
+// Called for each overlapping pair (a, b); return false to stop
+typedef bool (*BallPairVisitor)(int a, int b, void* userData);
+int visitSpatialGridCellPairs(const SpatialGrid* grid, const float* x, const float* y, const float* r,
+                              int cell, BallPairVisitor visit, void* userData);
+
+// Called for each ball overlapping a query circle; return false to stop
+typedef bool (*BallVisitor)(int ball, void* userData);
+int visitSpatialGridCircle(const SpatialGrid* grid, const float* x, const float* y, const float* r,
+                           float cx, float cy, float cr, BallVisitor visit, void* userData);
+
+#define SPATIAL_GRID_BAND_ROWS 4 // Rows per band for the parallel contact solver
+int getSpatialGridBandCount(const SpatialGrid* grid);
+int getSpatialGridPhaseBandCount(const SpatialGrid* grid, int phase);
+int visitSpatialGridBandPairs(const SpatialGrid* grid, const float* x, const float* y, const float* r,
+                              int band, BallPairVisitor visit, void* userData);
+
+// --- Fixed-size object pool (slab allocator with an intrusive free list) ---
+/**
+ * @brief Pool of equally sized objects allocated from slabs of objectsPerSlab objects.
+ * Freed objects go back on a free list, so a pool in steady state never calls malloc/free.
+ * @param systemAllocCount Number of malloc/realloc calls made by the pool (slabs and slab table)
+ */
+typedef struct {
+    size_t objectSize;
+    int objectsPerSlab;
+    size_t stride;            // Object size rounded up for alignment (computed on first slab)
+    void* freeList;
+    void** slabs;
+    int slabCount, slabCapacity;
+
+    int liveCount;            // Objects currently allocated
+    int peakLiveCount;
+    long long allocCount;     // Total number of poolAlloc calls
+    long long freeCount;      // Total number of poolFree calls
+    int systemAllocCount;
+} ObjectPool;
+
+#define OBJECT_POOL_INIT(size, perSlab) { .objectSize = (size), .objectsPerSlab = (perSlab) }
+
+void initObjectPool(ObjectPool* pool, size_t objectSize, int objectsPerSlab);
+void freeObjectPool(ObjectPool* pool);
+void* poolAlloc(ObjectPool* pool);
+void poolFree(ObjectPool* pool, void* object);
+
+// --- Worker thread pool ---
+#define THREAD_POOL_MAX_THREADS 64
+
+// Processes items [begin, end) of a parallel job on thread `threadIndex`
+typedef void (*ParallelRangeTask)(void* userData, int begin, int end, int threadIndex);
+
+/**
+ * @brief Persistent worker threads running runParallelRange jobs.
+ * @param threadCount Number of threads taking part in a job, the calling thread included
+ */
+typedef struct {
+    int threadCount;
+    pthread_t workers[THREAD_POOL_MAX_THREADS - 1];
+    pthread_mutex_t mutex;
+    pthread_cond_t jobReady;
+    pthread_cond_t jobDone;
+    bool shuttingDown;
+
+    // Current job
+    unsigned int jobGeneration; // Incremented for every job, wakes the workers
+    ParallelRangeTask task;
+    void* userData;
+    int jobCount;
+    int pendingWorkers;
+} ThreadPool;
+
+bool initThreadPool(ThreadPool* pool, int threadCount);
+void freeThreadPool(ThreadPool* pool);
+void runParallelRange(ThreadPool* pool, int count, ParallelRangeTask task, void* userData);
+
+// --- Frame profiler (profiler.c) ---
+#define PROFILER_FRAME_COUNT 240 // Frames kept in the ring buffer
+#define PROFILER_MAX_MARKERS 256 // Markers kept per frame (the phase totals are always kept)
+#define PROFILER_MAX_DEPTH 8     // Nesting of profileBegin/profileEnd
+
+typedef enum {
+    PROFILE_STEP,              // stepSimulation, parent of the physics phases
+    PROFILE_UPDATE_OBJECTS,    // updateObjectList
+    PROFILE_BALL_VS_OBJECTS,   // Ball vs GameObject pass (all collisions in SIMULATION_EVENTS mode)
+    PROFILE_SCREEN_BOUNDARIES, // Inside PROFILE_BALL_VS_OBJECTS; longest thread of the pass (sum in threadTime)
+    PROFILE_BALL_VS_BALL,      // handleBallToBallCollisions
+    PROFILE_REMOVE_MARKED,     // Deletion sweep of the marked balls and objects
+    PROFILE_SLEEP,             // updateSleepingBalls
+    PROFILE_RENDER,            // Drawing of the world and the HUD
+    PROFILE_PHASE_COUNT
+} ProfilePhase;
+
+/**
+ * @brief One timed scope of a frame.
+ * @param start, end Seconds since the start of the frame
+ * @param depth Number of scopes open around this one
+ */
+typedef struct {
+    uint8_t phase;
+    uint8_t depth;
+    float start;
+    float end;
+} ProfileMarker;
+
+typedef struct {
+    double startTime;                      // Seconds, from profileNow
+    float duration;                        // Seconds from profileBeginFrame to profileEndFrame
+    float phaseTime[PROFILE_PHASE_COUNT];  // Total time of each phase in the frame
+    float threadTime[PROFILE_PHASE_COUNT]; // Time summed over the threads, for the phases run on the thread pool
+    int markerCount;
+    ProfileMarker markers[PROFILER_MAX_MARKERS];
+} ProfileFrame;
+
+double profileNow(void);
+void setProfilerEnabled(bool enabled);
+bool isProfilerRecording(void); // Enabled and between profileBeginFrame and profileEndFrame
+void profileBeginFrame(void);
+void profileEndFrame(void);
+void profileBegin(ProfilePhase phase);
+void profileEnd(ProfilePhase phase);
+void profileAddScope(ProfilePhase phase, double start, double end);
+void profileAddThreadTime(ProfilePhase phase, double seconds);
+const char* getProfilePhaseName(ProfilePhase phase);
+int getProfileFrameCount(void);                    // Frames in the ring buffer
+const ProfileFrame* getProfileFrame(int framesAgo); // 0: last complete frame
+double getProfilePhaseAverage(ProfilePhase phase); // Seconds per frame over the ring buffer
+bool writeProfileCSV(const char* path);
+bool writeProfileTrace(const char* path);          // Chrome trace JSON (chrome://tracing, Perfetto)
+void drawProfilerOverlay(Rectangle bounds, float frameBudget);
+
+// --- Simulation (one world, stepped without any window) ---
+#define SIMULATION_FIXED_DT (1.0f / 120.0f)     // Default length of a physics step
+#define SIMULATION_MAX_STEPS_PER_FRAME 16       // Default step budget of advanceSimulation
+#define SIMULATION_DEFAULT_SEED 1u              // Seed of simulationRandom after initSimulation
+
+// How stepSimulation resolves collisions
+typedef enum {
+    SIMULATION_SUBSTEPS, // Each ball moves from hit to hit against the objects (up to maxSubsteps), then overlapping balls are pushed apart
+    SIMULATION_EVENTS    // Every collision, ball pairs included, predicted and handled in time order (handleEventDrivenCollisions)
+} SimulationMode;
+
+/**
+ * @brief Source of balls run at the start of every step (scene files, see loadScene).
+ * Each ball gets a random speed, direction, radius and mass in the given ranges
+ * (drawn with simulationRandom) and a copy of the emitter's effects.
+ * @param rate Balls emitted per step
+ * @param remaining Balls left to emit, -1 for no limit
+ */
+typedef struct {
+    Vector2 position;
+    float minSpeed, maxSpeed;       // px/s
+    float minAngle, maxAngle;       // Direction, degrees
+    float minRadius, maxRadius;
+    float minMass, maxMass;
+    float restitution;
+    Color color;
+    bool interactWithOtherBouncingObjects;
+    int rate;
+    int remaining;
+    CollisionEffect* effects;       // Copied on every ball emitted
+} BallEmitter;
+
+typedef struct {
+    GameObject* objects;   // Objects that don't bounce but can be collided with
+    AABBTree objectTree;   // Broadphase tree over objects
+    BallStore balls;       // Objects that bounce around
+    ThreadPool threads;    // Runs the collision passes
+    SimulationMode mode;   // SIMULATION_SUBSTEPS by default
+    int maxSubsteps;       // Collisions handled per ball and per step
+    int sleepSteps;        // Steps at rest before a ball falls asleep (BALL_SLEEP_STEPS by default, 0: never)
+    long long frame;       // Number of steps taken
+    uint32_t rngState;     // State of simulationRandom
+    BallEmitter* emitters; // Run at the start of every step
+    int emitterCount, emitterCapacity;
+
+    // Fixed timestep (advanceSimulation)
+    float fixedDt;         // Length of one step
+    int maxStepsPerFrame;  // Steps allowed per advanceSimulation call, time beyond that is dropped
+    float accumulator;     // Time received but not simulated yet, always less than fixedDt
+    double droppedTime;    // Total time dropped because the step budget was exhausted
+} Simulation;
+
+bool initSimulation(Simulation* sim, int threadCount);
+void freeSimulation(Simulation* sim);
+bool addSimulationObject(Simulation* sim, GameObject* obj);
+BallEmitter* addSimulationEmitter(Simulation* sim, const BallEmitter* emitter);
+void stepSimulation(Simulation* sim, float dt);
+int advanceSimulation(Simulation* sim, float frameTime);
+float getSimulationAlpha(const Simulation* sim);
+void createArcScene(Simulation* sim);
+void removeArcOnEscape(GameObject* arc, BouncingObject* ball);
+void seedSimulation(Simulation* sim, uint32_t seed);
+uint32_t simulationRandom(Simulation* sim);
+float simulationRandomFloat(Simulation* sim);
+BallHandle spawnRandomBall(Simulation* sim, Vector2 position);
+
+// --- World snapshots (snapshot.c) ---
+#define SNAPSHOT_VERSION 3 // Incremented whenever the file layout changes; other versions are refused
+
+bool registerSnapshotCallback(ArcCircleCallback callback);
+bool saveSimulationSnapshot(const Simulation* sim, const char* path);
+bool loadSimulationSnapshot(Simulation* sim, const char* path);
+
+// --- Input recording and replay (replay.c) ---
+#define REPLAY_VERSION 2
+#define REPLAY_SCENE_PATH_MAX 256
+#define REPLAY_SPAWN_BURST 25 // Balls spawned per frame while the right button is held
+
+// Input bits of a ReplayFrame
+#define REPLAY_INPUT_LEFT_PRESSED   (1u << 0) // Left button pressed this frame
+#define REPLAY_INPUT_RIGHT_DOWN     (1u << 1) // Right button held
+#define REPLAY_INPUT_SPACE_DOWN     (1u << 2) // Space held
+#define REPLAY_INPUT_OVER_CONTROLS  (1u << 3) // Mouse over the speed controls (no spawning)
+
+/**
+ * @brief What the player did in one frame of the game, as seen by the simulation.
+ * @param frameTime Real time of the frame (0 while the world is frozen)
+ * @param timeMultiplier Speed of the simulation in this frame; the world advances by frameTime * timeMultiplier
+ * @param mouse Mouse position, where balls are spawned
+ * @param input REPLAY_INPUT_* bits
+ */
+typedef struct {
+    float frameTime;
+    float timeMultiplier;
+    Vector2 mouse;
+    uint32_t input;
+} ReplayFrame;
+
+/**
+ * @brief Recorded session: the seed and scene of the world and one ReplayFrame per frame.
+ * @param scene Scene file the world was built from (see loadScene), empty for createArcScene
+ * @param stateHash, steps hashSimulationState and Simulation.frame at the end of the
+ *        recording (set by loadReplay)
+ */
+typedef struct {
+    uint32_t seed;
+    char scene[REPLAY_SCENE_PATH_MAX];
+    ReplayFrame* frames;
+    int frameCount, frameCapacity;
+    uint64_t stateHash;
+    long long steps;
+} Replay;
+
+void initReplay(Replay* replay, uint32_t seed, const char* scene);
+void freeReplay(Replay* replay);
+bool recordReplayFrame(Replay* replay, const ReplayFrame* frame);
+int applyReplayFrame(Simulation* sim, const ReplayFrame* frame);
+uint64_t hashSimulationState(const Simulation* sim);
+bool saveReplay(const Replay* replay, const Simulation* sim, const char* path);
+bool loadReplay(Replay* replay, const char* path);
+
+// --- Scene files (scene.c) ---
+bool loadScene(Simulation* sim, const char* path);
+
 // --- Function Prototypes for Physics Helpers (implemented in objects.c or a dedicated physics.c) ---
 bool sweptBallToStaticPointCollision(Vector2 point,
                                      Vector2 ballPos, Vector2 ballVel, float ballRadius,
@@ -175,21 +639,96 @@ bool sweptBallToStaticSegmentCollision(Vector2 segP1, Vector2 segP2,
                                        Vector2 ballPos, Vector2 ballVel, float ballRadius,
                                        float dt_max, float* toi, Vector2* normal);
 
+// All the edges of a closed polygon at once, 4 per SSE batch (polygon_sweep.c)
+bool sweptBallToStaticPolygonCollision(const Vector2* vertices, int vertexCount,
+                                       Vector2 ballPos, Vector2 ballVel, float ballRadius,
+                                       float dt_max, float* toi, Vector2* normal);
+
+// --- Collision counters (physics.c) ---
+#define COLLISION_STATS_SUBSTEP_BUCKETS 16 // Substep histogram size, the last bucket holds that many or more
+
+/**
+ * @brief Work done by the collision passes since the last resetCollisionStats.
+ * @param narrowphaseCalls checkCollision calls (ball vs GameObject), after the bounds test
+ * @param ballPairTests Ball pairs tested by the ball-to-ball solver
+ * @param narrowphaseByShape narrowphaseCalls split by the shape of the object tested
+ * @param narrowphaseHits checkCollision calls which reported a hit
+ * @param boundsTests Objects given by the broadphase, before the bounds test
+ *        (1 - narrowphaseCalls / boundsTests of them were culled by it)
+ * @param ballPairContacts Ball pairs tested which touched and were resolved
+ * @param ballsStepped Balls through the ball vs object pass (substeps or events)
+ * @param substepHistogram Balls by number of substeps used (events handled in SIMULATION_EVENTS mode)
+ * @param maxSubstepsReached Balls which used up maxSubsteps before the end of the step
+ */
+typedef struct {
+    long long narrowphaseCalls;
+    long long ballPairTests;
+    long long narrowphaseByShape[SHAPE_TYPE_COUNT];
+    long long narrowphaseHits;
+    long long boundsTests;
+    long long ballPairContacts;
+    long long ballsStepped;
+    long long substepHistogram[COLLISION_STATS_SUBSTEP_BUCKETS];
+    long long maxSubstepsReached;
+} CollisionStats;
+
+void resetCollisionStats(void);
+void addCollisionStats(int threadIndex, CollisionStats counts);
+void accumulateCollisionStats(CollisionStats* total, const CollisionStats* counts, int sign);
+CollisionStats getCollisionStats(void);
+bool writeCollisionStatsCSV(const char* path, const CollisionStats* stats, long long frames);
+
+// --- Function Prototypes for Collision Handling (physics.c) ---
+void forEachCandidateObject(BouncingObject* ball, GameObject* objectList, AABBTree* objectTree,
+                            float dt, AABBTreeVisitor visit, void* userData);
+void resolveBallObjectHit(BouncingObject* bouncingObj, GameObject* object, Vector2 normal);
+int handleBouncingObjectCollisions(BouncingObject* bouncingObj, GameObject* objectList, AABBTree* objectTree, float dt, int maxSubsteps);
+void applyScreenBoundaryCollisions(BouncingObject* obj);
+void applyScreenBoundaryCollisionsRange(BallStore* store, int begin, int end);
+void handleBouncingObjectListCollisions(BallStore* balls, GameObject* objectList, AABBTree* objectTree, float dt, int maxSubsteps, ThreadPool* threads);
+bool pushCollisionEvent(CollisionEventBuffer* buffer, const CollisionEvent* event);
+void handleBallToBallCollisions(BallStore* balls, float dt, ThreadPool* threads);
+void handleBallToBallCollisionsNaive(BallStore* balls, float dt);
+
+// --- Sleeping balls (physics.c) ---
+void updateSleepingBalls(BallStore* balls, GameObject* objectList, AABBTree* objectTree, float dt, int sleepSteps);
+
+// --- Event-driven collisions (event_physics.c) ---
+void handleEventDrivenCollisions(BallStore* balls, GameObject* objectList, AABBTree* objectTree, float dt, int maxEventsPerBall);
+
 // --- Function Prototypes for ArcCircle Callback Management ---
 void addCollisionCallbackToArcCircle(GameObject* arcCircle, ArcCircleCallback callback);
 void addEscapeCallbackToArcCircle(GameObject* arcCircle, ArcCircleCallback callback);
+void setArcCircleSweptRotation(GameObject* arcCircle, bool enabled);
+void runPendingArcEscapes(BouncingObject* ball, float hitTime);
 void freeArcCircleCallbackList(ArcCircleCallbackNode** head);
 
 // --- Function Prototypes for GameObject Management ---
+GameObject* allocGameObject(void);
+void bindGameObject(GameObject* obj);
+void freeGameObjectPools(void);
 void removeMarkedGameObjects(GameObject** head);
+void updateGameObjectBounds(GameObject* obj);
+bool canBallReachGameObject(const BouncingObject* ball, const GameObject* obj, float dt);
 
-// --- Function Prototypes for BouncingObject Management ---
-BouncingObject* createBouncingObject(Vector2 position, Vector2 velocity, float radius, Color color, float mass, float restitution, bool interactWithOtherBouncingObjects);
-void addBouncingObjectToList(BouncingObject** head, BouncingObject* newObject);
-void freeBouncingObjectList(BouncingObject** head);
-void updateBouncingObjectList(BouncingObject* head, float dt);
-void renderBouncingObjectList(BouncingObject* head);
-void removeMarkedBouncingObjects(BouncingObject** head); // New function to clean up marked objects
+// --- Function Prototypes for BouncingObject Management (ball_store.c) ---
+void initBallStore(BallStore* store);
+void freeBallStore(BallStore* store);
+BallHandle createBouncingObject(BallStore* store, Vector2 position, Vector2 velocity, float radius, Color color, float mass, float restitution, bool interactWithOtherBouncingObjects);
+bool resizeBallStore(BallStore* store, int count, int slotCount);
+int getBallIndex(const BallStore* store, BallHandle handle);
+BallHandle getBallHandle(const BallStore* store, int index);
+void loadBouncingObject(const BallStore* store, int index, BouncingObject* out);
+void storeBouncingObject(BallStore* store, int index, const BouncingObject* ball);
+void updateBouncingObjectList(BallStore* store, float dt);
+void saveBallPositions(BallStore* store);
+void renderBouncingObjectList(const BallStore* store, float alpha);
+void renderBouncingObjectListBatched(const BallStore* store, float alpha);
+void freeBallRenderer(void);
+void removeMarkedBouncingObjects(BallStore* store); // New function to clean up marked objects
+void addCollisionEffectsToBouncingObject(BallStore* store, BallHandle ball, CollisionEffect* effectsList);
+void wakeBall(BallStore* store, int index);
+int Count_BouncingObjects(const BallStore* store);
 
 // --- Function Prototypes for Collision Effect Management ---
 CollisionEffect* createColorChangeEffect(Color newColor, bool continuous);
@@ -199,8 +738,12 @@ CollisionEffect* createSizeChangeEffect(float factor, bool continuous);
 CollisionEffect* createSoundPlayEffect(Sound sound, bool continuous);
 CollisionEffect* createBallDisappearEffect(int particleCount, Color particleColor, bool continuous);
 CollisionEffect* createBallSpawnEffect(Vector2 position, float radius, Color color, bool continuous);
+CollisionEffect* cloneCollisionEffect(const CollisionEffect* source);
 void addEffectToList(CollisionEffect** head, CollisionEffect* newEffect);
 void freeEffectList(CollisionEffect** head);
+const ObjectPool* getCollisionEffectPool(void);
+void freeCollisionEffectPool(void);
 void applyEffects(BouncingObject* bouncingObj, GameObject* gameObj, bool isOngoingCollision);
+void runCollisionEvent(const CollisionEvent* event, BouncingObject* ball);
 
 #endif // COMMON_H
\ No newline at end of file
@@ -3,20 +3,80 @@
 
 #include <stdio.h> // For snprintf
 #include <errno.h> // For strerror with nob_copy_file
+#include <string.h> // For strcmp
+
+#ifdef _WIN32
+#define EXE_SUFFIX ".exe"
+#else
+#define EXE_SUFFIX ""
+#endif
+
+// Simulation sources shared by every target (main.c only holds the window, input and rendering)
+#define SIM_SOURCES "src/objects.c", "src/ball_store.c", "src/physics.c", "src/broadphase.c", "src/aabb_tree.c", "src/pool.c", "src/thread_pool.c", "src/simulation.c", "src/polygon_sweep.c", "src/event_physics.c", "src/profiler.c", "src/snapshot.c", "src/replay.c", "src/scene.c"
+
+// Build a benchmark from bench/<name>.c. Benchmarks are built with -DHEADLESS, so they
+// don't link raylib and build on any platform.
+static bool build_benchmark(Nob_Cmd *cmd, const char *name) {
+    nob_cmd_append(cmd, "gcc", "-Wall", "-Wextra", "-O2");
+    nob_cmd_append(cmd, "-Iinclude", "-DRAYMATH_STATIC_INLINE", "-DHEADLESS");
+    nob_cmd_append(cmd, "-o", nob_temp_sprintf("build/%s" EXE_SUFFIX, name));
+    nob_cmd_append(cmd, nob_temp_sprintf("bench/%s.c", name), SIM_SOURCES);
+    nob_cmd_append(cmd, "-lm", "-pthread");
+    return nob_cmd_run_sync_and_reset(cmd);
+}
+
+static bool build_benchmarks(void) {
+    if (!nob_mkdir_if_not_exists("build")) return false;
+
+    Nob_Cmd cmd = {0};
+    if (!build_benchmark(&cmd, "bench_broadphase")) return false;
+    if (!build_benchmark(&cmd, "bench_static_objects")) return false;
+    if (!build_benchmark(&cmd, "bench_spawn_churn")) return false;
+    if (!build_benchmark(&cmd, "bench_parallel_collisions")) return false;
+    if (!build_benchmark(&cmd, "bench_polygon_sweep")) return false;
+    if (!build_benchmark(&cmd, "bench_ball_sweep")) return false;
+    if (!build_benchmark(&cmd, "bench_scenarios")) return false;
+    if (!build_benchmark(&cmd, "bench_arc_ccd")) return false;
+    if (!build_benchmark(&cmd, "bench_snapshot")) return false;
+    return true;
+}
+
+// Build the simulation without window nor rendering (-DHEADLESS, no raylib), for profiling
+// and benchmarking the physics on machines without a display: build/bouncing_ball_headless
+static bool build_headless(void) {
+    if (!nob_mkdir_if_not_exists("build")) return false;
+
+    Nob_Cmd cmd = {0};
+    nob_cmd_append(&cmd, "gcc", "-Wall", "-Wextra", "-O2");
+    nob_cmd_append(&cmd, "-Iinclude", "-DRAYMATH_STATIC_INLINE", "-DHEADLESS");
+    nob_cmd_append(&cmd, "-o", "build/bouncing_ball_headless" EXE_SUFFIX);
+    nob_cmd_append(&cmd, "src/headless.c", SIM_SOURCES);
+    nob_cmd_append(&cmd, "-lm", "-pthread");
+    return nob_cmd_run_sync(cmd);
+}
 
 int main(int argc, char **argv) {
     NOB_GO_REBUILD_URSELF(argc, argv);
 
+    nob_shift_args(&argc, &argv); // Skip program name
+    if (argc > 0) {
+        const char *target = nob_shift_args(&argc, &argv);
+        if (strcmp(target, "bench") == 0) return build_benchmarks() ? 0 : 1;
+        if (strcmp(target, "headless") == 0) return build_headless() ? 0 : 1;
+        nob_log(NOB_ERROR, "Unknown target '%s' (available: bench, headless)", target);
+        return 1;
+    }
+
     // gcc build/main.c.o build/objects.c.o -o bouncing_ball_sim.exe -Llib -lraylib -lopengl32 -lgdi32 -lwinmm -mwindows
     Nob_Cmd cmd = {0};
     nob_cmd_append(&cmd, "gcc", "-Wall", "-Wextra");
     nob_cmd_append(&cmd, "-Iinclude", "-Llib");
     nob_cmd_append(&cmd, "-o", "bouncing_ball_sim.exe");
     nob_cmd_append(&cmd, "-O2");
-    nob_cmd_append(&cmd, "src/main.c", "src/objects.c");
-    nob_cmd_append(&cmd, "-lraylib", "-lopengl32", "-lgdi32", "-lwinmm");
+    nob_cmd_append(&cmd, "src/main.c", SIM_SOURCES);
+    nob_cmd_append(&cmd, "-lraylib", "-lopengl32", "-lgdi32", "-lwinmm", "-pthread");
     nob_cmd_append(&cmd, "-mwindows");
     if (!nob_cmd_run_sync(cmd)) return 1;
-   
+
     return 0;
 }
@@ -0,0 +1,354 @@
+#include "../include/common.h"
+#include <stdlib.h> // For realloc, free
+#include <math.h>   // For fmaxf, fminf
+
+// --- Dynamic AABB Tree over GameObjects ---
+//
+// Leaves hold a "fat" copy of their object's bounds (enlarged by AABB_TREE_MARGIN),
+// so an object that moves a little stays inside its leaf and nothing has to be
+// updated. When it leaves its fat box, the leaf is removed and reinserted.
+// Insertion picks the sibling with the cheapest perimeter increase and the tree is
+// kept balanced with rotations, like the Box2D dynamic tree.
+
+#define AABB_TREE_MARGIN 8.0f
+
+static bool isLeaf(const AABBTreeNode* node) {
+    return node->left == AABB_TREE_NULL;
+}
+
+static void combineBounds(Vector2 aMin, Vector2 aMax, Vector2 bMin, Vector2 bMax, Vector2* outMin, Vector2* outMax) {
+    outMin->x = fminf(aMin.x, bMin.x);
+    outMin->y = fminf(aMin.y, bMin.y);
+    outMax->x = fmaxf(aMax.x, bMax.x);
+    outMax->y = fmaxf(aMax.y, bMax.y);
+}
+
+static float boundsPerimeter(Vector2 min, Vector2 max) {
+    return 2.0f * ((max.x - min.x) + (max.y - min.y));
+}
+
+static bool boundsContain(Vector2 outerMin, Vector2 outerMax, Vector2 innerMin, Vector2 innerMax) {
+    return outerMin.x <= innerMin.x && outerMin.y <= innerMin.y &&
+           innerMax.x <= outerMax.x && innerMax.y <= outerMax.y;
+}
+
+static bool boundsOverlap(Vector2 aMin, Vector2 aMax, Vector2 bMin, Vector2 bMax) {
+    return aMax.x >= bMin.x && aMin.x <= bMax.x &&
+           aMax.y >= bMin.y && aMin.y <= bMax.y;
+}
+
+void initAABBTree(AABBTree* tree) {
+    *tree = (AABBTree){0};
+    tree->root = AABB_TREE_NULL;
+    tree->freeList = AABB_TREE_NULL;
+}
+
+void freeAABBTree(AABBTree* tree) {
+    free(tree->nodes);
+    initAABBTree(tree);
+}
+
+static int allocateNode(AABBTree* tree) {
+    if (tree->freeList == AABB_TREE_NULL) {
+        int newCapacity = (tree->nodeCapacity > 0) ? tree->nodeCapacity * 2 : 16;
+        AABBTreeNode* newNodes = (AABBTreeNode*)realloc(tree->nodes, newCapacity * sizeof(AABBTreeNode));
+        if (!newNodes) return AABB_TREE_NULL;
+        tree->nodes = newNodes;
+        // Chain the new nodes into the free list
+        for (int i = tree->nodeCapacity; i < newCapacity; i++) {
+            tree->nodes[i].next = (i + 1 < newCapacity) ? i + 1 : AABB_TREE_NULL;
+            tree->nodes[i].height = -1;
+        }
+        tree->freeList = tree->nodeCapacity;
+        tree->nodeCapacity = newCapacity;
+    }
+
+    int index = tree->freeList;
+    AABBTreeNode* node = &tree->nodes[index];
+    tree->freeList = node->next;
+    node->parent = AABB_TREE_NULL;
+    node->left = AABB_TREE_NULL;
+    node->right = AABB_TREE_NULL;
+    node->height = 0;
+    node->object = NULL;
+    tree->nodeCount++;
+    return index;
+}
+
+static void releaseNode(AABBTree* tree, int index) {
+    tree->nodes[index].next = tree->freeList;
+    tree->nodes[index].height = -1;
+    tree->freeList = index;
+    tree->nodeCount--;
+}
+
+// Recompute the bounds and height of a node from its two children
+static void refitNode(AABBTree* tree, int index) {
+    AABBTreeNode* node = &tree->nodes[index];
+    AABBTreeNode* left = &tree->nodes[node->left];
+    AABBTreeNode* right = &tree->nodes[node->right];
+    combineBounds(left->min, left->max, right->min, right->max, &node->min, &node->max);
+    node->height = 1 + ((left->height > right->height) ? left->height : right->height);
+}
+
+// Perform a left or right rotation if node A is imbalanced. Returns the new root of the subtree.
+static int balanceNode(AABBTree* tree, int iA) {
+    AABBTreeNode* A = &tree->nodes[iA];
+    if (isLeaf(A) || A->height < 2) return iA;
+
+    int iB = A->left;
+    int iC = A->right;
+    AABBTreeNode* B = &tree->nodes[iB];
+    AABBTreeNode* C = &tree->nodes[iC];
+    int balance = C->height - B->height;
+
+    // Rotate C up
+    if (balance > 1) {
+        int iF = C->left;
+        int iG = C->right;
+        AABBTreeNode* F = &tree->nodes[iF];
+        AABBTreeNode* G = &tree->nodes[iG];
+
+        C->left = iA;
+        C->parent = A->parent;
+        A->parent = iC;
+        if (C->parent != AABB_TREE_NULL) {
+            if (tree->nodes[C->parent].left == iA) tree->nodes[C->parent].left = iC;
+            else tree->nodes[C->parent].right = iC;
+        } else {
+            tree->root = iC;
+        }
+
+        if (F->height > G->height) {
+            C->right = iF;
+            A->right = iG;
+            G->parent = iA;
+        } else {
+            C->right = iG;
+            A->right = iF;
+            F->parent = iA;
+        }
+        refitNode(tree, iA);
+        refitNode(tree, iC);
+        return iC;
+    }
+
+    // Rotate B up
+    if (balance < -1) {
+        int iD = B->left;
+        int iE = B->right;
+        AABBTreeNode* D = &tree->nodes[iD];
+        AABBTreeNode* E = &tree->nodes[iE];
+
+        B->left = iA;
+        B->parent = A->parent;
+        A->parent = iB;
+        if (B->parent != AABB_TREE_NULL) {
+            if (tree->nodes[B->parent].left == iA) tree->nodes[B->parent].left = iB;
+            else tree->nodes[B->parent].right = iB;
+        } else {
+            tree->root = iB;
+        }
+
+        if (D->height > E->height) {
+            B->right = iD;
+            A->left = iE;
+            E->parent = iA;
+        } else {
+            B->right = iE;
+            A->left = iD;
+            D->parent = iA;
+        }
+        refitNode(tree, iA);
+        refitNode(tree, iB);
+        return iB;
+    }
+
+    return iA;
+}
+
+// Walk from a node up to the root, rebalancing and refitting every ancestor
+static void refitAncestors(AABBTree* tree, int index) {
+    while (index != AABB_TREE_NULL) {
+        index = balanceNode(tree, index);
+        refitNode(tree, index);
+        index = tree->nodes[index].parent;
+    }
+}
+
+// Link a leaf into the tree. Returns false, leaving the leaf unlinked, if its new parent
+// node can't be allocated.
+static bool insertLeaf(AABBTree* tree, int leaf) {
+    if (tree->root == AABB_TREE_NULL) {
+        tree->root = leaf;
+        tree->nodes[leaf].parent = AABB_TREE_NULL;
+        return true;
+    }
+
+    // 1. Find the best sibling: descend towards the child whose perimeter grows the least
+    Vector2 leafMin = tree->nodes[leaf].min;
+    Vector2 leafMax = tree->nodes[leaf].max;
+    int index = tree->root;
+    while (!isLeaf(&tree->nodes[index])) {
+        AABBTreeNode* node = &tree->nodes[index];
+        Vector2 combinedMin, combinedMax;
+        combineBounds(node->min, node->max, leafMin, leafMax, &combinedMin, &combinedMax);
+        float perimeter = boundsPerimeter(node->min, node->max);
+        float combinedPerimeter = boundsPerimeter(combinedMin, combinedMax);
+
+        // Cost of creating a new parent for this node and the new leaf
+        float cost = 2.0f * combinedPerimeter;
+        // Minimum cost of pushing the leaf further down the tree
+        float inheritanceCost = 2.0f * (combinedPerimeter - perimeter);
+
+        float childCost[2];
+        int children[2] = { node->left, node->right };
+        for (int c = 0; c < 2; c++) {
+            AABBTreeNode* child = &tree->nodes[children[c]];
+            combineBounds(child->min, child->max, leafMin, leafMax, &combinedMin, &combinedMax);
+            float newPerimeter = boundsPerimeter(combinedMin, combinedMax);
+            if (isLeaf(child)) {
+                childCost[c] = newPerimeter + inheritanceCost;
+            } else {
+                childCost[c] = (newPerimeter - boundsPerimeter(child->min, child->max)) + inheritanceCost;
+            }
+        }
+
+        if (cost < childCost[0] && cost < childCost[1]) break;
+        index = (childCost[0] < childCost[1]) ? children[0] : children[1];
+    }
+    int sibling = index;
+
+    // 2. Create a new parent for the sibling and the leaf
+    int oldParent = tree->nodes[sibling].parent;
+    int newParent = allocateNode(tree);
+    if (newParent == AABB_TREE_NULL) return false;
+    AABBTreeNode* parentNode = &tree->nodes[newParent];
+    parentNode->parent = oldParent;
+    parentNode->left = sibling;
+    parentNode->right = leaf;
+    tree->nodes[sibling].parent = newParent;
+    tree->nodes[leaf].parent = newParent;
+
+    if (oldParent != AABB_TREE_NULL) {
+        if (tree->nodes[oldParent].left == sibling) tree->nodes[oldParent].left = newParent;
+        else tree->nodes[oldParent].right = newParent;
+    } else {
+        tree->root = newParent;
+    }
+
+    // 3. Walk back up the tree fixing heights and bounds
+    refitAncestors(tree, newParent);
+    return true;
+}
+
+static void removeLeaf(AABBTree* tree, int leaf) {
+    if (leaf == tree->root) {
+        tree->root = AABB_TREE_NULL;
+        return;
+    }
+
+    int parent = tree->nodes[leaf].parent;
+    int grandParent = tree->nodes[parent].parent;
+    int sibling = (tree->nodes[parent].left == leaf) ? tree->nodes[parent].right : tree->nodes[parent].left;
+
+    if (grandParent != AABB_TREE_NULL) {
+        // Replace the parent by the sibling
+        if (tree->nodes[grandParent].left == parent) tree->nodes[grandParent].left = sibling;
+        else tree->nodes[grandParent].right = sibling;
+        tree->nodes[sibling].parent = grandParent;
+        releaseNode(tree, parent);
+        refitAncestors(tree, grandParent);
+    } else {
+        tree->root = sibling;
+        tree->nodes[sibling].parent = AABB_TREE_NULL;
+        releaseNode(tree, parent);
+    }
+}
+
+// Set the fat bounds of a leaf from its object's current bounds
+static void setLeafBounds(AABBTree* tree, int leaf) {
+    GameObject* obj = tree->nodes[leaf].object;
+    Vector2 margin = { AABB_TREE_MARGIN, AABB_TREE_MARGIN };
+    tree->nodes[leaf].min = Vector2Subtract(obj->boundsMin, margin);
+    tree->nodes[leaf].max = Vector2Add(obj->boundsMax, margin);
+}
+
+// Add an object to the tree (an object can only be in one tree at a time). Returns false,
+// the object staying out of the tree (obj->tree NULL), if out of memory.
+bool insertObjectInTree(AABBTree* tree, GameObject* obj) {
+    if (!tree || !obj || obj->tree) return false;
+
+    int leaf = allocateNode(tree);
+    if (leaf == AABB_TREE_NULL) return false;
+    tree->nodes[leaf].object = obj;
+    setLeafBounds(tree, leaf);
+    if (!insertLeaf(tree, leaf)) {
+        releaseNode(tree, leaf);
+        return false;
+    }
+
+    obj->tree = tree;
+    obj->treeProxy = leaf;
+
+    float speed = Vector2Length(obj->velocity);
+    if (speed > tree->maxObjectSpeed) tree->maxObjectSpeed = speed;
+    return true;
+}
+
+// Remove an object from the tree it belongs to, if any
+void removeObjectFromTree(GameObject* obj) {
+    if (!obj || !obj->tree) return;
+    AABBTree* tree = obj->tree;
+    removeLeaf(tree, obj->treeProxy);
+    releaseNode(tree, obj->treeProxy);
+    obj->tree = NULL;
+    obj->treeProxy = AABB_TREE_NULL;
+}
+
+// Incremental refit after an object moved: only reinsert it if it left its fat box
+void moveObjectInTree(GameObject* obj) {
+    if (!obj || !obj->tree) return;
+    AABBTree* tree = obj->tree;
+    int leaf = obj->treeProxy;
+    if (boundsContain(tree->nodes[leaf].min, tree->nodes[leaf].max, obj->boundsMin, obj->boundsMax)) return;
+
+    removeLeaf(tree, leaf);
+    setLeafBounds(tree, leaf);
+    // Can't fail: removeLeaf just released the parent node insertLeaf takes back (a leaf
+    // which was the root needs none), so the object never drops out of the tree here
+    insertLeaf(tree, leaf);
+}
+
+// Query the subtree under `root`. Returns false if `visit` stopped the traversal.
+static bool querySubtree(const AABBTree* tree, int root, Vector2 queryMin, Vector2 queryMax, AABBTreeVisitor visit, void* userData) {
+    // Explicit stack; the tree is balanced so its depth stays small
+    int stack[AABB_TREE_MAX_DEPTH];
+    int stackSize = 0;
+    stack[stackSize++] = root;
+
+    while (stackSize > 0) {
+        int index = stack[--stackSize];
+        const AABBTreeNode* node = &tree->nodes[index];
+        if (!boundsOverlap(node->min, node->max, queryMin, queryMax)) continue;
+
+        if (isLeaf(node)) {
+            if (!visit(node->object, userData)) return false;
+        } else if (stackSize + 2 <= AABB_TREE_MAX_DEPTH) {
+            stack[stackSize++] = node->right;
+            stack[stackSize++] = node->left;
+        } else {
+            // Deeper than the stack: continue below this node with a new stack rather than skip it
+            if (!querySubtree(tree, node->left, queryMin, queryMax, visit, userData)) return false;
+            if (!querySubtree(tree, node->right, queryMin, queryMax, visit, userData)) return false;
+        }
+    }
+    return true;
+}
+
+// Call `visit` for every object whose fat bounds overlap the query box.
+// The traversal stops early if `visit` returns false.
+void queryAABBTree(const AABBTree* tree, Vector2 queryMin, Vector2 queryMax, AABBTreeVisitor visit, void* userData) {
+    if (!tree || tree->root == AABB_TREE_NULL) return;
+    querySubtree(tree, tree->root, queryMin, queryMax, visit, userData);
+}
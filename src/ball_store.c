@@ -0,0 +1,411 @@
+#include "../include/common.h"
+#include <stdlib.h> // For realloc, free
+#include <string.h> // For memcpy
+#include <math.h>   // For sqrtf
+
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define BALL_STORE_SSE2
+#endif
+
+// --- Structure-of-Arrays Ball Storage ---
+//
+// Every ball property lives in its own contiguous array, indexed by a dense index
+// in [0, count). Dense indices change when balls are removed, so anything that
+// must keep referring to a ball (callbacks, effects, game logic) uses a BallHandle:
+// a slot in an indirection table plus a generation counter that detects stale handles.
+
+void initBallStore(BallStore* store) {
+    *store = (BallStore){0};
+    store->freeSlot = BALL_SLOT_NONE;
+}
+
+// Free all balls (and their effects) and the store's arrays
+void freeBallStore(BallStore* store) {
+    for (int i = 0; i < store->count; i++) {
+        freeEffectList(&store->effects[i]);
+    }
+    free(store->posX);
+    free(store->posY);
+    free(store->prevX);
+    free(store->prevY);
+    free(store->velX);
+    free(store->velY);
+    free(store->radius);
+    free(store->mass);
+    free(store->restitution);
+    free(store->flags);
+    free(store->stillSteps);
+    free(store->color);
+    free(store->effects);
+    free(store->slotOf);
+    free(store->slotDense);
+    free(store->slotGeneration);
+    initBallStore(store);
+}
+
+static bool growBallArray(void** array, int capacity, size_t elemSize) {
+    void* newArray = realloc(*array, (size_t)capacity * elemSize);
+    if (!newArray) return false;
+    *array = newArray;
+    return true;
+}
+
+// Make room for at least `needed` balls
+static bool reserveBalls(BallStore* store, int needed) {
+    if (needed <= store->capacity) return true;
+    int newCapacity = (store->capacity > 0) ? store->capacity * 2 : 256;
+    while (newCapacity < needed) newCapacity *= 2;
+
+    if (!growBallArray((void**)&store->posX, newCapacity, sizeof(float)) ||
+        !growBallArray((void**)&store->posY, newCapacity, sizeof(float)) ||
+        !growBallArray((void**)&store->prevX, newCapacity, sizeof(float)) ||
+        !growBallArray((void**)&store->prevY, newCapacity, sizeof(float)) ||
+        !growBallArray((void**)&store->velX, newCapacity, sizeof(float)) ||
+        !growBallArray((void**)&store->velY, newCapacity, sizeof(float)) ||
+        !growBallArray((void**)&store->radius, newCapacity, sizeof(float)) ||
+        !growBallArray((void**)&store->mass, newCapacity, sizeof(float)) ||
+        !growBallArray((void**)&store->restitution, newCapacity, sizeof(float)) ||
+        !growBallArray((void**)&store->flags, newCapacity, sizeof(uint8_t)) ||
+        !growBallArray((void**)&store->stillSteps, newCapacity, sizeof(uint8_t)) ||
+        !growBallArray((void**)&store->color, newCapacity, sizeof(Color)) ||
+        !growBallArray((void**)&store->effects, newCapacity, sizeof(CollisionEffect*)) ||
+        !growBallArray((void**)&store->slotOf, newCapacity, sizeof(uint32_t))) {
+        return false;
+    }
+    store->capacity = newCapacity;
+    store->growCount++;
+    return true;
+}
+
+// Take a slot from the free list, or append a new one
+static uint32_t allocateSlot(BallStore* store) {
+    if (store->freeSlot != BALL_SLOT_NONE) {
+        uint32_t slot = store->freeSlot;
+        store->freeSlot = store->slotDense[slot]; // Free slots chain through slotDense
+        return slot;
+    }
+    if (store->slotCount >= store->slotCapacity) {
+        int newCapacity = (store->slotCapacity > 0) ? store->slotCapacity * 2 : 256;
+        if (!growBallArray((void**)&store->slotDense, newCapacity, sizeof(uint32_t)) ||
+            !growBallArray((void**)&store->slotGeneration, newCapacity, sizeof(uint32_t))) {
+            return BALL_SLOT_NONE;
+        }
+        store->slotCapacity = newCapacity;
+        store->growCount++;
+    }
+    uint32_t slot = (uint32_t)store->slotCount++;
+    store->slotGeneration[slot] = 0;
+    return slot;
+}
+
+static void releaseSlot(BallStore* store, uint32_t slot) {
+    store->slotGeneration[slot]++; // Invalidate every outstanding handle to this slot
+    store->slotDense[slot] = store->freeSlot;
+    store->freeSlot = slot;
+}
+
+// Create a new bouncing object in the store and return its handle
+BallHandle createBouncingObject(BallStore* store, Vector2 position, Vector2 velocity, float radius, Color color, float mass, float restitution, bool interactWithOtherBouncingObjects) {
+    if (!reserveBalls(store, store->count + 1)) return BALL_HANDLE_NULL;
+    uint32_t slot = allocateSlot(store);
+    if (slot == BALL_SLOT_NONE) return BALL_HANDLE_NULL;
+
+    int i = store->count++;
+    store->posX[i] = position.x;
+    store->posY[i] = position.y;
+    store->prevX[i] = position.x;
+    store->prevY[i] = position.y;
+    store->velX[i] = velocity.x;
+    store->velY[i] = velocity.y;
+    store->radius[i] = radius;
+    store->color[i] = color;
+    store->mass[i] = (mass > 0.0f) ? mass : 1.0f; // Ensure positive mass
+    store->restitution[i] = Clamp(restitution, 0.0f, 1.0f); // Ensure valid restitution
+    store->flags[i] = interactWithOtherBouncingObjects ? BALL_FLAG_INTERACT_WITH_BALLS : 0;
+    store->stillSteps[i] = 0;
+    store->effects[i] = NULL;
+    store->slotOf[i] = slot;
+    store->slotDense[slot] = (uint32_t)i;
+
+    return (BallHandle){ slot, store->slotGeneration[slot] };
+}
+
+// Drop every ball and size the store for `count` balls and `slotCount` handle slots. The
+// contents of the arrays are left for the caller to fill in, slot tables included (bulk
+// loading, see loadSimulationSnapshot).
+bool resizeBallStore(BallStore* store, int count, int slotCount) {
+    for (int i = 0; i < store->count; i++) {
+        freeEffectList(&store->effects[i]);
+    }
+    store->count = 0;
+    store->slotCount = 0;
+    store->freeSlot = BALL_SLOT_NONE;
+    store->asleepCount = 0;
+
+    if (!reserveBalls(store, count)) return false;
+    if (slotCount > store->slotCapacity) {
+        if (!growBallArray((void**)&store->slotDense, slotCount, sizeof(uint32_t)) ||
+            !growBallArray((void**)&store->slotGeneration, slotCount, sizeof(uint32_t))) {
+            return false;
+        }
+        store->slotCapacity = slotCount;
+        store->growCount++;
+    }
+    store->count = count;
+    store->slotCount = slotCount;
+    return true;
+}
+
+// Dense index of a ball, or -1 if the handle refers to a ball that no longer exists
+int getBallIndex(const BallStore* store, BallHandle handle) {
+    if (handle.slot >= (uint32_t)store->slotCount) return -1;
+    if (store->slotGeneration[handle.slot] != handle.generation) return -1;
+    return (int)store->slotDense[handle.slot];
+}
+
+BallHandle getBallHandle(const BallStore* store, int index) {
+    uint32_t slot = store->slotOf[index];
+    return (BallHandle){ slot, store->slotGeneration[slot] };
+}
+
+// Copy ball `index` into a BouncingObject working copy, used by the collision code
+void loadBouncingObject(const BallStore* store, int index, BouncingObject* out) {
+    out->position = (Vector2){ store->posX[index], store->posY[index] };
+    out->velocity = (Vector2){ store->velX[index], store->velY[index] };
+    out->radius = store->radius[index];
+    out->color = store->color[index];
+    out->mass = store->mass[index];
+    out->restitution = store->restitution[index];
+    out->interactWithOtherBouncingObjects = (store->flags[index] & BALL_FLAG_INTERACT_WITH_BALLS) != 0;
+    out->markedForDeletion = (store->flags[index] & BALL_FLAG_MARKED_FOR_DELETION) != 0;
+    out->onCollisionEffects = store->effects[index];
+    out->handle = getBallHandle(store, index);
+    out->frameElapsed = 0.0f;
+    out->pendingEscapeCount = 0;
+    out->deferredEvents = NULL;
+}
+
+// Write a working copy back into the store
+void storeBouncingObject(BallStore* store, int index, const BouncingObject* ball) {
+    store->posX[index] = ball->position.x;
+    store->posY[index] = ball->position.y;
+    store->velX[index] = ball->velocity.x;
+    store->velY[index] = ball->velocity.y;
+    store->radius[index] = ball->radius;
+    store->color[index] = ball->color;
+    store->mass[index] = ball->mass;
+    store->restitution[index] = ball->restitution;
+    store->flags[index] = (uint8_t)((store->flags[index] & BALL_FLAG_ASLEEP) |
+                                    (ball->interactWithOtherBouncingObjects ? BALL_FLAG_INTERACT_WITH_BALLS : 0) |
+                                    (ball->markedForDeletion ? BALL_FLAG_MARKED_FOR_DELETION : 0));
+    store->effects[index] = ball->onCollisionEffects;
+}
+
+// Remove all bouncing objects marked for deletion.
+// Survivors are compacted in place, so the relative order of the balls is kept.
+void removeMarkedBouncingObjects(BallStore* store) {
+    int write = 0;
+    for (int read = 0; read < store->count; read++) {
+        if (store->flags[read] & BALL_FLAG_MARKED_FOR_DELETION) {
+            // Free resources associated with this object
+            freeEffectList(&store->effects[read]);
+            releaseSlot(store, store->slotOf[read]);
+            if (store->flags[read] & BALL_FLAG_ASLEEP) store->asleepCount--;
+            continue;
+        }
+        if (write != read) {
+            store->posX[write] = store->posX[read];
+            store->posY[write] = store->posY[read];
+            store->prevX[write] = store->prevX[read];
+            store->prevY[write] = store->prevY[read];
+            store->velX[write] = store->velX[read];
+            store->velY[write] = store->velY[read];
+            store->radius[write] = store->radius[read];
+            store->mass[write] = store->mass[read];
+            store->restitution[write] = store->restitution[read];
+            store->flags[write] = store->flags[read];
+            store->stillSteps[write] = store->stillSteps[read];
+            store->color[write] = store->color[read];
+            store->effects[write] = store->effects[read];
+            store->slotOf[write] = store->slotOf[read];
+            store->slotDense[store->slotOf[write]] = (uint32_t)write;
+        }
+        write++;
+    }
+    store->count = write;
+}
+
+#ifdef BALL_STORE_SSE2
+// Lanes of x where `outside` is set are replaced by wrapTo
+static inline __m128 wrapLanes(__m128 x, __m128 outside, __m128 wrapTo) {
+    return _mm_or_ps(_mm_and_ps(outside, wrapTo), _mm_andnot_ps(outside, x));
+}
+#endif
+
+// Update all bouncing objects
+// Positions are integrated 4 balls at a time, the screen wrap is done with masks instead of branches.
+// A wrapped ball jumps to the far side: its previous position (prevX/prevY) jumps with it, so
+// that it isn't seen travelling across the screen (interpolation, swept ball-to-ball test).
+void updateBouncingObjectList(BallStore* store, float dt) {
+    int i = 0;
+#ifdef BALL_STORE_SSE2
+    const __m128 step = _mm_set1_ps(dt);
+    const __m128 low = _mm_set1_ps(-50.0f);
+    const __m128 highX = _mm_set1_ps((float)(SCREEN_WIDTH + 50)), highY = _mm_set1_ps((float)(SCREEN_HEIGHT + 50));
+    const __m128 wrapHighX = _mm_set1_ps((float)(SCREEN_WIDTH + 40)), wrapHighY = _mm_set1_ps((float)(SCREEN_HEIGHT + 40));
+    const __m128 wrapLow = _mm_set1_ps(-40.0f);
+    for (; i + 4 <= store->count; i += 4) {
+        __m128 x = _mm_add_ps(_mm_loadu_ps(&store->posX[i]), _mm_mul_ps(_mm_loadu_ps(&store->velX[i]), step));
+        __m128 y = _mm_add_ps(_mm_loadu_ps(&store->posY[i]), _mm_mul_ps(_mm_loadu_ps(&store->velY[i]), step));
+
+        // Same order as the scalar tail: a ball wrapped to the far side is not wrapped back
+        __m128 wrapped = _mm_cmplt_ps(x, low);
+        x = wrapLanes(x, wrapped, wrapHighX);
+        __m128 outside = _mm_cmpgt_ps(x, highX);
+        x = wrapLanes(x, outside, wrapLow);
+        wrapped = _mm_or_ps(wrapped, outside);
+        outside = _mm_cmplt_ps(y, low);
+        y = wrapLanes(y, outside, wrapHighY);
+        wrapped = _mm_or_ps(wrapped, outside);
+        outside = _mm_cmpgt_ps(y, highY);
+        y = wrapLanes(y, outside, wrapLow);
+        wrapped = _mm_or_ps(wrapped, outside);
+
+        _mm_storeu_ps(&store->posX[i], x);
+        _mm_storeu_ps(&store->posY[i], y);
+        if (_mm_movemask_ps(wrapped)) { // Rare: only touch prevX/prevY when a ball wrapped
+            _mm_storeu_ps(&store->prevX[i], wrapLanes(_mm_loadu_ps(&store->prevX[i]), wrapped, x));
+            _mm_storeu_ps(&store->prevY[i], wrapLanes(_mm_loadu_ps(&store->prevY[i]), wrapped, y));
+        }
+    }
+#endif
+    for (; i < store->count; i++) {
+        // Update position based on velocity
+        store->posX[i] += store->velX[i] * dt;
+        store->posY[i] += store->velY[i] * dt;
+
+        // Basic screen wrap for bouncing objects (optional)
+        bool wrapped = false;
+        if (store->posX[i] < -50) { store->posX[i] = SCREEN_WIDTH + 40; wrapped = true; }
+        if (store->posX[i] > SCREEN_WIDTH + 50) { store->posX[i] = -40; wrapped = true; }
+        if (store->posY[i] < -50) { store->posY[i] = SCREEN_HEIGHT + 40; wrapped = true; }
+        if (store->posY[i] > SCREEN_HEIGHT + 50) { store->posY[i] = -40; wrapped = true; }
+        if (wrapped) {
+            store->prevX[i] = store->posX[i];
+            store->prevY[i] = store->posY[i];
+        }
+    }
+}
+
+// Copy the current positions to prevX/prevY, called at the start of every simulation step
+void saveBallPositions(BallStore* store) {
+    if (store->count == 0) return;
+    memcpy(store->prevX, store->posX, (size_t)store->count * sizeof(float));
+    memcpy(store->prevY, store->posY, (size_t)store->count * sizeof(float));
+}
+
+// Render all bouncing objects, between their previous (alpha = 0) and current (alpha = 1) positions
+void renderBouncingObjectList(const BallStore* store, float alpha) {
+#ifndef HEADLESS
+    for (int i = 0; i < store->count; i++) {
+        Vector2 position = {
+            store->prevX[i] + (store->posX[i] - store->prevX[i]) * alpha,
+            store->prevY[i] + (store->posY[i] - store->prevY[i]) * alpha
+        };
+        DrawCircleV(position, store->radius[i], store->color[i]);
+    }
+#else
+    (void)store;
+    (void)alpha;
+#endif
+}
+
+// --- Batched ball rendering ---
+//
+// DrawCircleV tessellates every ball into a fan of 36 segments (cosf/sinf per vertex) and
+// pushes them through raylib's batch one by one. The batched renderer draws each ball as one
+// textured quad instead: a disc texture built once, tinted with the ball's color, read straight
+// from the store's arrays. Every quad uses the same texture, so raylib merges them into a single
+// draw call per full batch buffer (a few draw calls for tens of thousands of balls).
+
+#define BALL_TEXTURE_SIZE 64 // Disc texture resolution, mipmapped for the small balls
+
+#ifndef HEADLESS
+static Texture2D ballTexture = { 0 };
+
+// White disc with an antialiased edge (alpha = pixel coverage)
+static bool loadBallTexture(void) {
+    Image image = GenImageColor(BALL_TEXTURE_SIZE, BALL_TEXTURE_SIZE, BLANK);
+    if (!image.data) return false;
+    Color* pixels = (Color*)image.data;
+    const float center = BALL_TEXTURE_SIZE * 0.5f;
+    for (int y = 0; y < BALL_TEXTURE_SIZE; y++) {
+        for (int x = 0; x < BALL_TEXTURE_SIZE; x++) {
+            float dx = x + 0.5f - center;
+            float dy = y + 0.5f - center;
+            float coverage = Clamp(center - sqrtf(dx * dx + dy * dy) + 0.5f, 0.0f, 1.0f);
+            pixels[y * BALL_TEXTURE_SIZE + x] = (Color){ 255, 255, 255, (unsigned char)(coverage * 255.0f) };
+        }
+    }
+    ballTexture = LoadTextureFromImage(image);
+    UnloadImage(image);
+    if (ballTexture.id == 0) return false;
+    GenTextureMipmaps(&ballTexture);
+    SetTextureFilter(ballTexture, TEXTURE_FILTER_TRILINEAR);
+    return true;
+}
+#endif
+
+// Same picture as renderBouncingObjectList, one quad per ball.
+// The texture is loaded on the first call (a window must be open); falls back to
+// renderBouncingObjectList if it can't be.
+void renderBouncingObjectListBatched(const BallStore* store, float alpha) {
+#ifndef HEADLESS
+    if (ballTexture.id == 0 && !loadBallTexture()) {
+        renderBouncingObjectList(store, alpha);
+        return;
+    }
+    const Rectangle source = { 0.0f, 0.0f, (float)BALL_TEXTURE_SIZE, (float)BALL_TEXTURE_SIZE };
+    const Vector2 origin = { 0.0f, 0.0f };
+    for (int i = 0; i < store->count; i++) {
+        float r = store->radius[i];
+        float x = store->prevX[i] + (store->posX[i] - store->prevX[i]) * alpha;
+        float y = store->prevY[i] + (store->posY[i] - store->prevY[i]) * alpha;
+        DrawTexturePro(ballTexture, source, (Rectangle){ x - r, y - r, 2.0f * r, 2.0f * r }, origin, 0.0f, store->color[i]);
+    }
+#else
+    (void)store;
+    (void)alpha;
+#endif
+}
+
+// Release the texture of the batched renderer (before closing the window)
+void freeBallRenderer(void) {
+#ifndef HEADLESS
+    if (ballTexture.id != 0) UnloadTexture(ballTexture);
+    ballTexture = (Texture2D){ 0 };
+#endif
+}
+
+// Helper function to add collision effects to a bouncing object
+void addCollisionEffectsToBouncingObject(BallStore* store, BallHandle ball, CollisionEffect* effectsList) {
+    int index = getBallIndex(store, ball);
+    if (index < 0) return;
+    store->effects[index] = effectsList;
+    wakeBall(store, index); // New effects may change how the ball moves
+}
+
+// Put a ball back into the collision passes (see updateSleepingBalls)
+void wakeBall(BallStore* store, int index) {
+    if (store->flags[index] & BALL_FLAG_ASLEEP) {
+        store->flags[index] &= (uint8_t)~BALL_FLAG_ASLEEP;
+        store->asleepCount--;
+    }
+    store->stillSteps[index] = 0;
+}
+
+// Count the number of bouncing objects
+int Count_BouncingObjects(const BallStore* store) {
+    return store->count;
+}
@@ -0,0 +1,266 @@
+#include "../include/common.h"
+#include <stdlib.h> // For malloc, realloc, free
+#include <math.h>   // For fmaxf, sqrtf, floorf
+
+// --- Uniform Grid Broadphase ---
+//
+// The grid is rebuilt from scratch every frame with a counting sort: balls are
+// binned by cell, then the cells are walked in order and each ball is only
+// compared against balls in its own cell and in 4 "forward" neighbour cells
+// (E, SW, S, SE), so every candidate pair is emitted exactly once.
+// Rows can also be grouped in bands of two colors that don't share any ball (see below),
+// which lets the contact solver work on several bands at once.
+// Because the cell size is at least twice the largest radius, two overlapping
+// balls always end up in the same or in adjacent cells.
+
+// Hard limit on the number of cells relative to the number of balls, so that a
+// few balls spread over a huge area don't make the grid explode in size
+#define GRID_MAX_CELLS_PER_BALL 4
+#define GRID_MIN_CELLS 64
+
+// Grow a dynamic array to hold at least `needed` elements of `elemSize` bytes
+static bool growArray(void** items, int* capacity, int needed, size_t elemSize) {
+    if (needed <= *capacity) return true;
+    int newCapacity = (*capacity > 0) ? *capacity : 64;
+    while (newCapacity < needed) newCapacity *= 2;
+    void* newItems = realloc(*items, (size_t)newCapacity * elemSize);
+    if (!newItems) return false;
+    *items = newItems;
+    *capacity = newCapacity;
+    return true;
+}
+
+void initSpatialGrid(SpatialGrid* grid) {
+    *grid = (SpatialGrid){0};
+}
+
+void freeSpatialGrid(SpatialGrid* grid) {
+    free(grid->cellStart);
+    free(grid->cellEntries);
+    free(grid->ballCell);
+    free(grid->pairs);
+    *grid = (SpatialGrid){0};
+}
+
+// Rebuild the grid for the given balls (positions and radii as separate arrays)
+bool rebuildSpatialGrid(SpatialGrid* grid, const float* x, const float* y, const float* r, int count) {
+    grid->ballCount = 0;
+    grid->cols = 0;
+    grid->rows = 0;
+    if (count <= 0) return true;
+
+    // 1. Bounds of all ball centers and largest radius
+    float minX = x[0], maxX = x[0], minY = y[0], maxY = y[0], maxRadius = r[0];
+    for (int i = 1; i < count; i++) {
+        if (x[i] < minX) minX = x[i];
+        if (x[i] > maxX) maxX = x[i];
+        if (y[i] < minY) minY = y[i];
+        if (y[i] > maxY) maxY = y[i];
+        if (r[i] > maxRadius) maxRadius = r[i];
+    }
+
+    // 2. Cell size from the largest ball, enlarged if it would create too many cells
+    float cellSize = fmaxf(2.0f * maxRadius, 1.0f);
+    float width = maxX - minX;
+    float height = maxY - minY;
+    float maxCells = (float)(count * GRID_MAX_CELLS_PER_BALL + GRID_MIN_CELLS);
+    float wantedCells = (width / cellSize + 1.0f) * (height / cellSize + 1.0f);
+    if (wantedCells > maxCells) {
+        cellSize *= sqrtf(wantedCells / maxCells);
+    }
+
+    grid->cellSize = cellSize;
+    grid->invCellSize = 1.0f / cellSize;
+    grid->originX = minX;
+    grid->originY = minY;
+    grid->cols = (int)(width * grid->invCellSize) + 1;
+    grid->rows = (int)(height * grid->invCellSize) + 1;
+    int cellCount = grid->cols * grid->rows;
+
+    if (!growArray((void**)&grid->cellStart, &grid->cellCapacity, cellCount + 1, sizeof(int)) ||
+        !growArray((void**)&grid->cellEntries, &grid->entryCapacity, count, sizeof(int)) ||
+        !growArray((void**)&grid->ballCell, &grid->ballCellCapacity, count, sizeof(int))) {
+        grid->cols = grid->rows = 0;
+        return false;
+    }
+
+    // 3. Counting sort of the balls by cell
+    for (int c = 0; c <= cellCount; c++) grid->cellStart[c] = 0;
+    for (int i = 0; i < count; i++) {
+        int cx = (int)((x[i] - minX) * grid->invCellSize);
+        int cy = (int)((y[i] - minY) * grid->invCellSize);
+        if (cx >= grid->cols) cx = grid->cols - 1;
+        if (cy >= grid->rows) cy = grid->rows - 1;
+        int cell = cy * grid->cols + cx;
+        grid->ballCell[i] = cell;
+        grid->cellStart[cell]++;
+    }
+    // Exclusive prefix sum: cellStart[c] becomes the first entry of cell c
+    int runningTotal = 0;
+    for (int c = 0; c <= cellCount; c++) {
+        int cellBallCount = grid->cellStart[c];
+        grid->cellStart[c] = runningTotal;
+        runningTotal += cellBallCount;
+    }
+    // Scatter, using cellStart[c] as a write cursor (it ends up at the start of cell c + 1)
+    for (int i = 0; i < count; i++) {
+        grid->cellEntries[grid->cellStart[grid->ballCell[i]]++] = i;
+    }
+    // Shift the cursors back so cellStart[c] is again the start of cell c
+    for (int c = cellCount; c > 0; c--) {
+        grid->cellStart[c] = grid->cellStart[c - 1];
+    }
+    grid->cellStart[0] = 0;
+
+    grid->ballCount = count;
+    return true;
+}
+
+static inline bool ballsOverlap(const float* x, const float* y, const float* r, int a, int b) {
+    float dx = x[b] - x[a];
+    float dy = y[b] - y[a];
+    float minDistance = r[a] + r[b];
+    return dx * dx + dy * dy < minDistance * minDistance;
+}
+
+static bool appendPair(SpatialGrid* grid, int a, int b) {
+    if (grid->pairCount >= grid->pairCapacity &&
+        !growArray((void**)&grid->pairs, &grid->pairCapacity, grid->pairCount + 1, sizeof(BallPair))) {
+        return false;
+    }
+    grid->pairs[grid->pairCount++] = (BallPair){a, b};
+    return true;
+}
+
+// Visit the overlapping pairs owned by `cell`: pairs made of a ball of the cell and a ball
+// of the same cell or of one of its forward neighbours. Returns the number of pairs tested.
+// Pairs owned by a cell only involve balls of cells (cx-1..cx+1, cy..cy+1).
+int visitSpatialGridCellPairs(const SpatialGrid* grid, const float* x, const float* y, const float* r,
+                              int cell, BallPairVisitor visit, void* userData) {
+    // Forward half of the 8-neighbourhood: E, SW, S, SE
+    static const int neighbourOffsets[4][2] = { {1, 0}, {-1, 1}, {0, 1}, {1, 1} };
+
+    int cx = cell % grid->cols;
+    int cy = cell / grid->cols;
+    int begin = grid->cellStart[cell];
+    int end = grid->cellStart[cell + 1];
+    int candidates = 0;
+
+    for (int e = begin; e < end; e++) {
+        int a = grid->cellEntries[e];
+
+        // Balls sharing the same cell
+        for (int f = e + 1; f < end; f++) {
+            int b = grid->cellEntries[f];
+            candidates++;
+            if (ballsOverlap(x, y, r, a, b) && !visit(a, b, userData)) return candidates;
+        }
+
+        // Balls in the forward neighbour cells
+        for (int n = 0; n < 4; n++) {
+            int nx = cx + neighbourOffsets[n][0];
+            int ny = cy + neighbourOffsets[n][1];
+            if (nx < 0 || nx >= grid->cols || ny >= grid->rows) continue;
+            int neighbour = ny * grid->cols + nx;
+            for (int f = grid->cellStart[neighbour]; f < grid->cellStart[neighbour + 1]; f++) {
+                int b = grid->cellEntries[f];
+                candidates++;
+                if (ballsOverlap(x, y, r, a, b) && !visit(a, b, userData)) return candidates;
+            }
+        }
+    }
+    return candidates;
+}
+
+typedef struct {
+    SpatialGrid* grid;
+    bool outOfMemory;
+} PairCollector;
+
+static bool visitAppendPair(int a, int b, void* userData) {
+    PairCollector* collector = (PairCollector*)userData;
+    if (!appendPair(collector->grid, a, b)) {
+        collector->outOfMemory = true;
+        return false;
+    }
+    return true;
+}
+
+// Collect the pairs of overlapping balls from the current grid into grid->pairs.
+// Pairs are emitted cell by cell, in cell order. Returns the number of pairs.
+int collectSpatialGridPairs(SpatialGrid* grid, const float* x, const float* y, const float* r) {
+    grid->pairCount = 0;
+    grid->candidateCount = 0;
+
+    PairCollector collector = { grid, false };
+    int cellCount = grid->cols * grid->rows;
+    for (int cell = 0; cell < cellCount && !collector.outOfMemory; cell++) {
+        grid->candidateCount += visitSpatialGridCellPairs(grid, x, y, r, cell, visitAppendPair, &collector);
+    }
+    return grid->pairCount;
+}
+
+// Visit the balls of the grid overlapping the circle (cx, cy, cr), which may span many cells.
+// Returns the number of balls tested.
+int visitSpatialGridCircle(const SpatialGrid* grid, const float* x, const float* y, const float* r,
+                           float cx, float cy, float cr, BallVisitor visit, void* userData) {
+    if (grid->ballCount == 0) return 0;
+
+    // Balls of the grid have a radius of at most half a cell: the centers of those that can
+    // overlap the circle are within cr + cellSize / 2 of its center
+    float reach = cr + grid->cellSize * 0.5f;
+    int minCol = (int)fmaxf(0.0f, floorf((cx - reach - grid->originX) * grid->invCellSize));
+    int minRow = (int)fmaxf(0.0f, floorf((cy - reach - grid->originY) * grid->invCellSize));
+    float maxColF = floorf((cx + reach - grid->originX) * grid->invCellSize);
+    float maxRowF = floorf((cy + reach - grid->originY) * grid->invCellSize);
+    if (maxColF < 0.0f || maxRowF < 0.0f) return 0;
+    int maxCol = (maxColF < (float)(grid->cols - 1)) ? (int)maxColF : grid->cols - 1;
+    int maxRow = (maxRowF < (float)(grid->rows - 1)) ? (int)maxRowF : grid->rows - 1;
+
+    int candidates = 0;
+    for (int row = minRow; row <= maxRow; row++) {
+        for (int col = minCol; col <= maxCol; col++) {
+            int cell = row * grid->cols + col;
+            for (int e = grid->cellStart[cell]; e < grid->cellStart[cell + 1]; e++) {
+                int b = grid->cellEntries[e];
+                float dx = x[b] - cx;
+                float dy = y[b] - cy;
+                float minDistance = r[b] + cr;
+                candidates++;
+                if (dx * dx + dy * dy < minDistance * minDistance && !visit(b, userData)) return candidates;
+            }
+        }
+    }
+    return candidates;
+}
+
+// --- Row bands ---
+//
+// Rows are grouped in bands of SPATIAL_GRID_BAND_ROWS rows, colored like a checkerboard:
+// even bands, then odd bands. Pairs owned by a band only involve balls of the band and of
+// the first row of the next band, so two bands of the same parity never share a ball and
+// can be processed in any order, or in parallel. Inside a band cells are walked in cell
+// order, which keeps the neighbouring rows in cache.
+
+int getSpatialGridBandCount(const SpatialGrid* grid) {
+    return (grid->rows + SPATIAL_GRID_BAND_ROWS - 1) / SPATIAL_GRID_BAND_ROWS;
+}
+
+// Number of bands of the given parity (0: even bands, 1: odd bands)
+int getSpatialGridPhaseBandCount(const SpatialGrid* grid, int phase) {
+    return (getSpatialGridBandCount(grid) - phase + 1) / 2;
+}
+
+// Visit the pairs owned by the cells of one band, in cell order. Returns the number of pairs tested.
+int visitSpatialGridBandPairs(const SpatialGrid* grid, const float* x, const float* y, const float* r,
+                              int band, BallPairVisitor visit, void* userData) {
+    int firstCell = band * SPATIAL_GRID_BAND_ROWS * grid->cols;
+    int lastCell = firstCell + SPATIAL_GRID_BAND_ROWS * grid->cols;
+    if (lastCell > grid->rows * grid->cols) lastCell = grid->rows * grid->cols;
+
+    int candidates = 0;
+    for (int cell = firstCell; cell < lastCell; cell++) {
+        candidates += visitSpatialGridCellPairs(grid, x, y, r, cell, visit, userData);
+    }
+    return candidates;
+}
@@ -0,0 +1,531 @@
+#include "../include/common.h"
+#include <stdlib.h> // For realloc
+#include <math.h>   // For sqrtf, fmaxf, floorf
+
+// --- Event-driven collisions (SIMULATION_EVENTS) ---
+//
+// Instead of moving every ball in substeps and scanning the objects again after each hit, every
+// ball has its own clock within the step, and its next collision is predicted once: against the
+// objects (checkCollision), the screen boundaries and the other interacting balls. Predictions go
+// into a min-heap ordered by time; the earliest is popped, the balls involved are moved to that
+// time, the collision is resolved and only those balls are predicted again.
+//
+// Invalidation is lazy: each ball counts its collisions (ballVersion), an event remembers the
+// counts of its balls when it was predicted, and an event whose counts no longer match is
+// dropped when popped. The work is proportional to the number of collisions rather than to
+// the number of substeps times the number of objects.
+//
+// Ball pairs come from a grid over a circle around the rest of each ball's path (its swept
+// circle). The grid starts from the one built for the first predictions; a ball whose path
+// changes moves to the cell of its new circle, and is then predicted against the balls of the
+// cells its circle overlaps only. A circle larger than a cell goes to a list that every query
+// scans (a ball sped up far beyond the others).
+
+typedef enum {
+    PREDICTED_OBJECT,  // A ball touches a GameObject
+    PREDICTED_WALL,    // A ball touches a screen boundary
+    PREDICTED_BALL     // Two balls touch
+} PredictedEventType;
+
+typedef struct {
+    float time;            // From the start of the step
+    int ball;              // Index of the ball in the store
+    int other;             // Index of the other ball (PREDICTED_BALL)
+    uint32_t version;      // Collision counts of both balls when the event was predicted
+    uint32_t otherVersion;
+    GameObject* object;    // Object touched (PREDICTED_OBJECT)
+    Vector2 normal;        // From the surface to the ball (PREDICTED_OBJECT, PREDICTED_WALL)
+    PredictedEventType type;
+} PredictedEvent;
+
+// Binary min-heap of events ordered by time
+typedef struct {
+    PredictedEvent* items;
+    int count, capacity;
+} EventHeap;
+
+static bool pushEvent(EventHeap* heap, const PredictedEvent* event) {
+    if (heap->count == heap->capacity) {
+        int newCapacity = (heap->capacity > 0) ? heap->capacity * 2 : 256;
+        PredictedEvent* items = (PredictedEvent*)realloc(heap->items, newCapacity * sizeof(PredictedEvent));
+        if (!items) return false;
+        heap->items = items;
+        heap->capacity = newCapacity;
+    }
+
+    // Sift up
+    int i = heap->count++;
+    while (i > 0) {
+        int parent = (i - 1) / 2;
+        if (heap->items[parent].time <= event->time) break;
+        heap->items[i] = heap->items[parent];
+        i = parent;
+    }
+    heap->items[i] = *event;
+    return true;
+}
+
+// Remove and return the earliest event (the heap must not be empty)
+static PredictedEvent popEvent(EventHeap* heap) {
+    PredictedEvent top = heap->items[0];
+    PredictedEvent last = heap->items[--heap->count];
+    if (heap->count == 0) return top;
+
+    // Sift the last event down from the root
+    int i = 0;
+    for (;;) {
+        int child = 2 * i + 1;
+        if (child >= heap->count) break;
+        if (child + 1 < heap->count && heap->items[child + 1].time < heap->items[child].time) child++;
+        if (last.time <= heap->items[child].time) break;
+        heap->items[i] = heap->items[child];
+        i = child;
+    }
+    heap->items[i] = last;
+    return top;
+}
+
+// Scratch buffers reused from step to step
+static EventHeap eventHeap;
+static float* ballTime = NULL;        // Time each ball has been moved to
+static uint32_t* ballVersion = NULL;  // Collisions of each ball so far this step
+static int* interacting = NULL;       // Indices of the balls that collide with other balls
+static float* sweptX = NULL;          // Circle around the path of each interacting ball over the step
+static float* sweptY = NULL;
+static float* sweptRadius = NULL;
+static int* ballSlot = NULL;           // Index in `interacting` of each ball, -1 if it doesn't interact
+static int* slotNext = NULL;           // Swept circles in the same cell (doubly linked, -1 at the ends)
+static int* slotPrev = NULL;
+static int* slotCell = NULL;           // Cell of each swept circle
+static int scratchCapacity = 0;
+static SpatialGrid sweptGrid;
+static int* cellHead = NULL;           // First swept circle of each cell, then of the oversized list
+static int cellHeadCapacity = 0;
+
+static bool reserveEventScratch(int count) {
+    if (count <= scratchCapacity) return true;
+    int newCapacity = (scratchCapacity > 0) ? scratchCapacity : 256;
+    while (newCapacity < count) newCapacity *= 2;
+
+    float* newTime = (float*)realloc(ballTime, newCapacity * sizeof(float));
+    if (!newTime) return false;
+    ballTime = newTime;
+    uint32_t* newVersion = (uint32_t*)realloc(ballVersion, newCapacity * sizeof(uint32_t));
+    if (!newVersion) return false;
+    ballVersion = newVersion;
+    int* newInteracting = (int*)realloc(interacting, newCapacity * sizeof(int));
+    if (!newInteracting) return false;
+    interacting = newInteracting;
+    float* newX = (float*)realloc(sweptX, newCapacity * sizeof(float));
+    if (!newX) return false;
+    sweptX = newX;
+    float* newY = (float*)realloc(sweptY, newCapacity * sizeof(float));
+    if (!newY) return false;
+    sweptY = newY;
+    float* newRadius = (float*)realloc(sweptRadius, newCapacity * sizeof(float));
+    if (!newRadius) return false;
+    sweptRadius = newRadius;
+    int* newSlot = (int*)realloc(ballSlot, newCapacity * sizeof(int));
+    if (!newSlot) return false;
+    ballSlot = newSlot;
+    int* newNext = (int*)realloc(slotNext, newCapacity * sizeof(int));
+    if (!newNext) return false;
+    slotNext = newNext;
+    int* newPrev = (int*)realloc(slotPrev, newCapacity * sizeof(int));
+    if (!newPrev) return false;
+    slotPrev = newPrev;
+    int* newCell = (int*)realloc(slotCell, newCapacity * sizeof(int));
+    if (!newCell) return false;
+    slotCell = newCell;
+
+    scratchCapacity = newCapacity;
+    return true;
+}
+
+typedef struct {
+    BallStore* balls;
+    GameObject* objectList;
+    AABBTree* objectTree;
+    float dt;
+    uint32_t maxEventsPerBall;
+    int interactingCount;
+    bool pairsFromGrid;    // Ball pairs found with the swept circle grid (false: every pair is tested)
+    CollisionStats counts;
+} EventStep;
+
+// A ball which used up its collisions stays where it is for the rest of the step
+// (as in the substep mode) and is never predicted again
+static bool isBallDone(const EventStep* step, int i) {
+    return ballVersion[i] >= step->maxEventsPerBall;
+}
+
+static void moveBallTo(BallStore* balls, int i, float time) {
+    float elapsed = time - ballTime[i];
+    if (elapsed > 0.0f) {
+        balls->posX[i] += balls->velX[i] * elapsed;
+        balls->posY[i] += balls->velY[i] * elapsed;
+    }
+    ballTime[i] = time;
+}
+
+// Earliest object hit of one ball, as visitEarliestHit in physics.c
+typedef struct {
+    BouncingObject* ball;
+    float dt;
+    float toi;
+    GameObject* object;
+    Vector2 normal;
+    CollisionStats* counts;
+} ObjectHitQuery;
+
+static bool visitObjectHit(GameObject* obj, void* userData) {
+    ObjectHitQuery* hit = (ObjectHitQuery*)userData;
+    hit->counts->boundsTests++;
+    if (!canBallReachGameObject(hit->ball, obj, hit->dt)) return true;
+
+    float toi;
+    Vector2 normal;
+    hit->counts->narrowphaseCalls++;
+    hit->counts->narrowphaseByShape[obj->type]++;
+    if (obj->checkCollision(obj, hit->ball, hit->dt, &toi, &normal)) {
+        hit->counts->narrowphaseHits++;
+        // A ball overlapping a fixed surface while already moving away from it is reported at
+        // toi 0: resolving it would turn the ball back into the surface, event after event
+        if (!obj->surfaceVelocity && Vector2DotProduct(hit->ball->velocity, normal) > 0.0f) return true;
+        if (toi >= -EPSILON2 && toi < hit->toi) {
+            hit->toi = toi;
+            hit->object = obj;
+            hit->normal = normal;
+        }
+    }
+    return true;
+}
+
+static void predictObjectHit(EventStep* step, int i) {
+    float now = ballTime[i];
+    float remaining = step->dt - now;
+
+    BouncingObject ball;
+    loadBouncingObject(step->balls, i, &ball);
+    ball.frameElapsed = now;
+    ObjectHitQuery hit = { &ball, remaining, remaining, NULL, {0, 0}, &step->counts };
+    forEachCandidateObject(&ball, step->objectList, step->objectTree, remaining, visitObjectHit, &hit);
+    runPendingArcEscapes(&ball, hit.toi);
+
+    // Arc callbacks run during checkCollision may have changed the ball (e.g. marked it for deletion)
+    storeBouncingObject(step->balls, i, &ball);
+
+    if (hit.object) {
+        PredictedEvent event = { .time = now + fmaxf(0.0f, hit.toi), .ball = i, .other = -1,
+                                 .version = ballVersion[i], .object = hit.object, .normal = hit.normal,
+                                 .type = PREDICTED_OBJECT };
+        pushEvent(&eventHeap, &event);
+    }
+}
+
+// First screen boundary the ball moves towards (0 if it is already past it)
+static void predictWallHit(EventStep* step, int i) {
+    const BallStore* balls = step->balls;
+    float x = balls->posX[i], y = balls->posY[i];
+    float vx = balls->velX[i], vy = balls->velY[i];
+    float r = balls->radius[i];
+    float now = ballTime[i];
+
+    float best = step->dt - now;
+    Vector2 normal = { 0, 0 };
+    bool found = false;
+    float t;
+    if (vx < 0.0f && (t = fmaxf(0.0f, (x - r) / -vx)) < best) { best = t; normal = (Vector2){ 1, 0 }; found = true; }
+    if (vx > 0.0f && (t = fmaxf(0.0f, (SCREEN_WIDTH - r - x) / vx)) < best) { best = t; normal = (Vector2){ -1, 0 }; found = true; }
+    if (vy < 0.0f && (t = fmaxf(0.0f, (y - r) / -vy)) < best) { best = t; normal = (Vector2){ 0, 1 }; found = true; }
+    if (vy > 0.0f && (t = fmaxf(0.0f, (SCREEN_HEIGHT - r - y) / vy)) < best) { best = t; normal = (Vector2){ 0, -1 }; found = true; }
+
+    if (found) {
+        PredictedEvent event = { .time = now + best, .ball = i, .other = -1, .version = ballVersion[i],
+                                 .normal = normal, .type = PREDICTED_WALL };
+        pushEvent(&eventHeap, &event);
+    }
+}
+
+// When balls i and j touch while getting closer, if before the end of the step. Ball i is at
+// its own time, which is the latest of the two: j is moved there along its path first.
+static void predictBallPair(EventStep* step, int i, int j) {
+    const BallStore* balls = step->balls;
+    float now = ballTime[i];
+    step->counts.ballPairTests++;
+
+    float dx = balls->posX[j] + balls->velX[j] * (now - ballTime[j]) - balls->posX[i];
+    float dy = balls->posY[j] + balls->velY[j] * (now - ballTime[j]) - balls->posY[i];
+    float dvx = balls->velX[j] - balls->velX[i];
+    float dvy = balls->velY[j] - balls->velY[i];
+    float b = dx * dvx + dy * dvy;
+    if (b >= 0.0f) return; // Not getting closer
+
+    // |d + dv t| = r_i + r_j, smallest root of a t^2 + 2 b t + c = 0
+    float sumRadius = balls->radius[i] + balls->radius[j];
+    float c = dx * dx + dy * dy - sumRadius * sumRadius;
+    float t = 0.0f; // Already touching
+    if (c > 0.0f) {
+        float a = dvx * dvx + dvy * dvy;
+        float discriminant = b * b - a * c;
+        if (discriminant < 0.0f) return;
+        t = c / (-b + sqrtf(discriminant)); // (-b - sqrt(d)) / a, without cancellation
+    }
+    if (t >= step->dt - now) return;
+
+    PredictedEvent event = { .time = now + t, .ball = i, .other = j, .version = ballVersion[i],
+                             .otherVersion = ballVersion[j], .type = PREDICTED_BALL };
+    pushEvent(&eventHeap, &event);
+}
+
+// --- Swept circle grid ---
+
+// Circle around the path of ball i from its own time to the end of the step
+static void setSweptCircle(const EventStep* step, int i) {
+    const BallStore* balls = step->balls;
+    int k = ballSlot[i];
+    float remaining = step->dt - ballTime[i];
+    float halfX = balls->velX[i] * remaining * 0.5f;
+    float halfY = balls->velY[i] * remaining * 0.5f;
+    sweptX[k] = balls->posX[i] + halfX;
+    sweptY[k] = balls->posY[i] + halfY;
+    sweptRadius[k] = balls->radius[i] + sqrtf(halfX * halfX + halfY * halfY);
+}
+
+static int clampCell(float coordinate, int count) {
+    if (coordinate < 0.0f) return 0;
+    return (coordinate < (float)(count - 1)) ? (int)coordinate : count - 1;
+}
+
+// Cell of a swept circle. Centers outside the grid go to its border cells, and circles larger
+// than half a cell to the oversized list (index cols * rows).
+static int sweptCircleCell(int k) {
+    if (sweptRadius[k] > sweptGrid.cellSize * 0.5f) return sweptGrid.cols * sweptGrid.rows;
+    int col = clampCell(floorf((sweptX[k] - sweptGrid.originX) * sweptGrid.invCellSize), sweptGrid.cols);
+    int row = clampCell(floorf((sweptY[k] - sweptGrid.originY) * sweptGrid.invCellSize), sweptGrid.rows);
+    return row * sweptGrid.cols + col;
+}
+
+static void linkSlot(int k, int cell) {
+    slotCell[k] = cell;
+    slotPrev[k] = -1;
+    slotNext[k] = cellHead[cell];
+    if (cellHead[cell] >= 0) slotPrev[cellHead[cell]] = k;
+    cellHead[cell] = k;
+}
+
+static void unlinkSlot(int k) {
+    if (slotPrev[k] >= 0) slotNext[slotPrev[k]] = slotNext[k];
+    else cellHead[slotCell[k]] = slotNext[k];
+    if (slotNext[k] >= 0) slotPrev[slotNext[k]] = slotPrev[k];
+}
+
+// Ball i changed its path: recompute its swept circle and move it to the matching cell
+static void refreshSweptCircle(const EventStep* step, int i) {
+    if (!step->pairsFromGrid || ballSlot[i] < 0) return;
+    int k = ballSlot[i];
+    setSweptCircle(step, i);
+    int cell = sweptCircleCell(k);
+    if (cell != slotCell[k]) {
+        unlinkSlot(k);
+        linkSlot(k, cell);
+    }
+}
+
+static void predictPairIfSweptOverlap(EventStep* step, int i, int k) {
+    int j = interacting[k];
+    if (j == i || isBallDone(step, j)) return;
+    int ki = ballSlot[i];
+    float dx = sweptX[k] - sweptX[ki];
+    float dy = sweptY[k] - sweptY[ki];
+    float reach = sweptRadius[k] + sweptRadius[ki];
+    if (dx * dx + dy * dy <= reach * reach) predictBallPair(step, i, j);
+}
+
+// Predict ball i against the balls whose swept circles overlap its own: the circles of the
+// cells within its radius plus half a cell, and the oversized circles
+static void predictBallPairsFromGrid(EventStep* step, int i) {
+    int ki = ballSlot[i];
+    float reach = sweptRadius[ki] + sweptGrid.cellSize * 0.5f;
+    int minCol = clampCell(floorf((sweptX[ki] - reach - sweptGrid.originX) * sweptGrid.invCellSize), sweptGrid.cols);
+    int maxCol = clampCell(floorf((sweptX[ki] + reach - sweptGrid.originX) * sweptGrid.invCellSize), sweptGrid.cols);
+    int minRow = clampCell(floorf((sweptY[ki] - reach - sweptGrid.originY) * sweptGrid.invCellSize), sweptGrid.rows);
+    int maxRow = clampCell(floorf((sweptY[ki] + reach - sweptGrid.originY) * sweptGrid.invCellSize), sweptGrid.rows);
+
+    for (int row = minRow; row <= maxRow; row++) {
+        for (int col = minCol; col <= maxCol; col++) {
+            for (int k = cellHead[row * sweptGrid.cols + col]; k >= 0; k = slotNext[k]) {
+                predictPairIfSweptOverlap(step, i, k);
+            }
+        }
+    }
+    for (int k = cellHead[sweptGrid.cols * sweptGrid.rows]; k >= 0; k = slotNext[k]) {
+        predictPairIfSweptOverlap(step, i, k);
+    }
+}
+
+// Predict everything ball i may touch next, except other balls when `withBalls` is false.
+// Sleeping balls don't move: the awake balls predict their hits on them.
+static void predictBall(EventStep* step, int i, bool withBalls) {
+    if (isBallDone(step, i) || (step->balls->flags[i] & BALL_FLAG_ASLEEP)) return;
+    predictObjectHit(step, i);
+    predictWallHit(step, i);
+
+    if (!withBalls || !(step->balls->flags[i] & BALL_FLAG_INTERACT_WITH_BALLS)) return;
+    if (step->pairsFromGrid) {
+        predictBallPairsFromGrid(step, i);
+        return;
+    }
+    for (int k = 0; k < step->interactingCount; k++) {
+        int j = interacting[k];
+        if (j != i && !isBallDone(step, j)) predictBallPair(step, i, j);
+    }
+}
+
+// Initial ball pair predictions: only pairs whose paths over the step can meet, found with the
+// spatial grid over the swept circles. The grid's cells then hold the circles for the
+// predictions that follow. Returns false if the grid couldn't be built.
+static bool predictInitialBallPairs(EventStep* step) {
+    for (int k = 0; k < step->interactingCount; k++) {
+        setSweptCircle(step, interacting[k]);
+    }
+    if (!rebuildSpatialGrid(&sweptGrid, sweptX, sweptY, sweptRadius, step->interactingCount)) return false;
+
+    int cellCount = sweptGrid.cols * sweptGrid.rows;
+    if (cellCount + 1 > cellHeadCapacity) {
+        int* newHeads = (int*)realloc(cellHead, (cellCount + 1) * sizeof(int));
+        if (!newHeads) return false;
+        cellHead = newHeads;
+        cellHeadCapacity = cellCount + 1;
+    }
+    for (int c = 0; c <= cellCount; c++) cellHead[c] = -1;
+    for (int k = 0; k < step->interactingCount; k++) {
+        linkSlot(k, sweptGrid.ballCell[k]);
+    }
+
+    collectSpatialGridPairs(&sweptGrid, sweptX, sweptY, sweptRadius);
+    for (int p = 0; p < sweptGrid.pairCount; p++) {
+        predictBallPair(step, interacting[sweptGrid.pairs[p].a], interacting[sweptGrid.pairs[p].b]);
+    }
+    return true;
+}
+
+static bool isEventValid(const PredictedEvent* event) {
+    if (ballVersion[event->ball] != event->version) return false;
+    return event->type != PREDICTED_BALL || ballVersion[event->other] == event->otherVersion;
+}
+
+static void resolveEvent(EventStep* step, const PredictedEvent* event) {
+    BallStore* balls = step->balls;
+    int i = event->ball;
+    moveBallTo(balls, i, event->time);
+
+    switch (event->type) {
+        case PREDICTED_OBJECT: {
+            BouncingObject ball;
+            loadBouncingObject(balls, i, &ball);
+            ball.frameElapsed = event->time;
+            resolveBallObjectHit(&ball, event->object, event->normal);
+            storeBouncingObject(balls, i, &ball);
+            break;
+        }
+
+        case PREDICTED_WALL:
+            // As applyScreenBoundaryCollisions: flip the velocity towards the wall, slight damping
+            if (event->normal.x != 0.0f && balls->velX[i] * event->normal.x < 0.0f) balls->velX[i] *= -1;
+            if (event->normal.y != 0.0f && balls->velY[i] * event->normal.y < 0.0f) balls->velY[i] *= -1;
+            balls->velX[i] *= 0.99f;
+            balls->velY[i] *= 0.99f;
+            break;
+
+        case PREDICTED_BALL: {
+            // Same impulse as resolveBallPair in physics.c, at the time of contact
+            int j = event->other;
+            moveBallTo(balls, j, event->time);
+            Vector2 normal = Vector2Normalize((Vector2){ balls->posX[j] - balls->posX[i], balls->posY[j] - balls->posY[i] });
+            if (Vector2LengthSqr(normal) < EPSILON2) normal = (Vector2){ 1, 0 }; // Same center
+            float relVelAlongNormal = (balls->velX[i] - balls->velX[j]) * normal.x +
+                                      (balls->velY[i] - balls->velY[j]) * normal.y;
+            if (relVelAlongNormal > 0.0f) {
+                step->counts.ballPairContacts++;
+                float mass1 = balls->mass[i];
+                float mass2 = balls->mass[j];
+                float impulseMagnitude = (-(1 + balls->restitution[i] * balls->restitution[j]) * relVelAlongNormal) /
+                                         (1/mass1 + 1/mass2);
+                balls->velX[i] += normal.x * impulseMagnitude / mass1;
+                balls->velY[i] += normal.y * impulseMagnitude / mass1;
+                balls->velX[j] -= normal.x * impulseMagnitude / mass2;
+                balls->velY[j] -= normal.y * impulseMagnitude / mass2;
+                wakeBall(balls, j); // Now moving: predicted from here on
+            }
+            ballVersion[j]++;
+            if (isBallDone(step, j)) ballTime[j] = step->dt;
+            break;
+        }
+    }
+
+    ballVersion[i]++;
+    if (isBallDone(step, i)) ballTime[i] = step->dt;
+
+    // Both paths changed: move their circles before predicting either ball
+    refreshSweptCircle(step, i);
+    if (event->type == PREDICTED_BALL) refreshSweptCircle(step, event->other);
+    predictBall(step, i, true);
+    if (event->type == PREDICTED_BALL) predictBall(step, event->other, true);
+}
+
+// Move every ball through the step, handling its collisions with the objects, the screen
+// boundaries and the other interacting balls one at a time, in time order.
+// maxEventsPerBall: collisions handled per ball; a ball which reaches it stops for the rest of
+// the step. Single-threaded: arc callbacks and sounds run immediately.
+void handleEventDrivenCollisions(BallStore* balls, GameObject* objectList, AABBTree* objectTree, float dt, int maxEventsPerBall) {
+    if (balls->count == 0 || dt <= 0.0f) return;
+    if (!reserveEventScratch(balls->count)) {
+        // Out of memory: fall back to the substep passes
+        handleBouncingObjectListCollisions(balls, objectList, objectTree, dt, maxEventsPerBall, NULL);
+        handleBallToBallCollisions(balls, dt, NULL);
+        return;
+    }
+
+    EventStep step = { balls, objectList, objectTree, dt, (uint32_t)(maxEventsPerBall > 0 ? maxEventsPerBall : 1), 0, false, {0} };
+    eventHeap.count = 0;
+    for (int i = 0; i < balls->count; i++) {
+        ballTime[i] = 0.0f;
+        ballVersion[i] = 0;
+        ballSlot[i] = -1;
+        if (balls->flags[i] & BALL_FLAG_INTERACT_WITH_BALLS) {
+            ballSlot[i] = step.interactingCount;
+            interacting[step.interactingCount++] = i;
+        }
+    }
+
+    // 1. First prediction of every ball; ball pairs from the grid when it can be built
+    step.pairsFromGrid = predictInitialBallPairs(&step);
+    for (int i = 0; i < balls->count; i++) {
+        predictBall(&step, i, !step.pairsFromGrid);
+    }
+
+    // 2. Earliest valid event first, until none is left within the step
+    while (eventHeap.count > 0) {
+        PredictedEvent event = popEvent(&eventHeap);
+        if (!isEventValid(&event)) continue;
+        resolveEvent(&step, &event);
+    }
+
+    // 3. Every ball to the end of the step, then the usual boundary pass as a safety net
+    // (for balls that stopped early or were pushed out by an object)
+    for (int i = 0; i < balls->count; i++) {
+        moveBallTo(balls, i, dt);
+
+        // Events handled by each ball, in place of the substeps of the other mode
+        uint32_t events = ballVersion[i];
+        step.counts.ballsStepped++;
+        step.counts.substepHistogram[(events < COLLISION_STATS_SUBSTEP_BUCKETS) ? events : COLLISION_STATS_SUBSTEP_BUCKETS - 1]++;
+        if (isBallDone(&step, i)) step.counts.maxSubstepsReached++;
+    }
+    profileBegin(PROFILE_SCREEN_BOUNDARIES);
+    applyScreenBoundaryCollisionsRange(balls, 0, balls->count);
+    profileEnd(PROFILE_SCREEN_BOUNDARIES);
+
+    addCollisionStats(0, step.counts);
+}
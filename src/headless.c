@@ -0,0 +1,218 @@
+#include "../include/common.h"
+#include <stdio.h>  // For printf, snprintf
+#include <stdlib.h> // For atoi
+#include <string.h> // For strcmp
+#include <time.h>   // For clock_gettime
+
+// Prototypes for functions in objects.c
+int Count_GameObjects(GameObject* head);
+
+// Headless simulation: runs the game's physics step for a fixed number of frames at a
+// fixed dt, without a window, and prints timing. Built with -DHEADLESS (no raylib needed).
+//
+// Scenario: the game's arc scene, with balls spawned at the center of the screen in bursts
+// of 25 per frame (like holding space + right click) until `balls` balls have been created.
+//
+// Scene mode: builds the world from a scene file (see scene.c) and steps it; the balls come
+// from the scene's emitters.
+//
+// Replay mode: replays a session recorded by the game (replay.bin) as fast as possible, from
+// the same seed and scene, and checks that it ends in the same world (state hash).
+//
+// Usage: bouncing_ball_headless [frames] [balls] [threads] [seed] [profile] [stats]
+//        bouncing_ball_headless --scene file [frames] [threads] [profile] [stats]
+//        bouncing_ball_headless --replay file [threads] [profile] [stats]
+//   threads: 0 (default) for one per CPU
+//   profile: if given, the frame profiler runs and the last PROFILER_FRAME_COUNT frames are
+//            written to <profile>.csv and <profile>.json (Chrome trace); "-" to skip it
+//   stats  : if given, the collision counters of the run are written to this CSV file
+
+#define HEADLESS_DT (1.0f / 120.0f)
+#define HEADLESS_SPAWN_BURST 25
+
+static double nowSeconds(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+}
+
+// Collision counters of the run (per step), and the profile if it was recorded
+static void printReport(long long steps, const char* profilePath, const char* statsPath) {
+    CollisionStats stats = getCollisionStats();
+    if (steps > 0) {
+        printf("narrowphase: %.1f calls/step (rectangle %.1f, diamond %.1f, arc %.1f), %.1f%% culled by the bounds\n",
+               (double)stats.narrowphaseCalls / steps, (double)stats.narrowphaseByShape[SHAPE_RECTANGLE] / steps,
+               (double)stats.narrowphaseByShape[SHAPE_DIAMOND] / steps, (double)stats.narrowphaseByShape[SHAPE_CIRCLE_ARC] / steps,
+               (stats.boundsTests > 0) ? 100.0 * (1.0 - (double)stats.narrowphaseCalls / stats.boundsTests) : 0.0);
+        printf("ball pairs : %.1f tests/step, %.1f%% touching\n", (double)stats.ballPairTests / steps,
+               (stats.ballPairTests > 0) ? 100.0 * stats.ballPairContacts / stats.ballPairTests : 0.0);
+        printf("substeps   : %.3f%% of the balls used up maxSubsteps\n",
+               (stats.ballsStepped > 0) ? 100.0 * stats.maxSubstepsReached / stats.ballsStepped : 0.0);
+    }
+    if (statsPath) {
+        printf("stats      : %s %s\n", writeCollisionStatsCSV(statsPath, &stats, steps) ? "written to" : "could not write", statsPath);
+    }
+    if (profilePath) {
+        printf("profile    : last %d frames, average per frame:\n", getProfileFrameCount());
+        for (int p = 0; p < PROFILE_PHASE_COUNT; p++) {
+            printf("  %-18s %.3f ms\n", getProfilePhaseName((ProfilePhase)p), getProfilePhaseAverage((ProfilePhase)p) * 1000.0);
+        }
+        char csvPath[512], tracePath[512];
+        snprintf(csvPath, sizeof(csvPath), "%s.csv", profilePath);
+        snprintf(tracePath, sizeof(tracePath), "%s.json", profilePath);
+        bool written = writeProfileCSV(csvPath) && writeProfileTrace(tracePath);
+        printf("  %s %s.csv and %s.json\n", written ? "written to" : "could not write", profilePath, profilePath);
+    }
+}
+
+// Replay a recorded session: same seed, same scene, the recorded input of every frame
+static int runReplay(int argc, char** argv) {
+    const char* replayPath = argv[2];
+    int threadCount = (argc > 3) ? atoi(argv[3]) : 0;
+    const char* profilePath = (argc > 4 && strcmp(argv[4], "-") != 0) ? argv[4] : NULL;
+    const char* statsPath = (argc > 5) ? argv[5] : NULL;
+
+    Replay replay;
+    initReplay(&replay, 0, NULL);
+    if (!loadReplay(&replay, replayPath)) {
+        printf("could not read the replay %s\n", replayPath);
+        return 1;
+    }
+    setProfilerEnabled(profilePath != NULL);
+
+    Simulation sim;
+    initSimulation(&sim, threadCount);
+    seedSimulation(&sim, replay.seed);
+    if (replay.scene[0] == '\0') {
+        createArcScene(&sim);
+    } else if (!loadScene(&sim, replay.scene)) {
+        freeReplay(&replay);
+        freeSimulation(&sim);
+        return 1;
+    }
+    resetCollisionStats();
+
+    double start = nowSeconds();
+    for (int f = 0; f < replay.frameCount; f++) {
+        profileBeginFrame();
+        applyReplayFrame(&sim, &replay.frames[f]);
+        profileEndFrame();
+    }
+    double totalTime = nowSeconds() - start;
+
+    bool identical = hashSimulationState(&sim) == replay.stateHash && sim.frame == replay.steps;
+    printf("replay     : %s, %d frames, %lld steps (%d threads, seed %u, %s)\n", replayPath, replay.frameCount,
+           sim.frame, sim.threads.threadCount, replay.seed, replay.scene[0] ? replay.scene : "arc scene");
+    printf("balls      : %d left (%d asleep)\n", Count_BouncingObjects(&sim.balls), sim.balls.asleepCount);
+    printf("objects    : %d left\n", Count_GameObjects(sim.objects));
+    printf("total      : %.3f s (%.1f frames/s, %.1f steps/s)\n", totalTime, replay.frameCount / totalTime, sim.frame / totalTime);
+    printf("final state: %s\n", identical ? "identical to the recorded session" : "DIFFERENT from the recorded session");
+    printReport(sim.frame, profilePath, statsPath);
+
+    freeReplay(&replay);
+    freeSimulation(&sim);
+    freeGameObjectPools();
+    freeCollisionEffectPool();
+    return identical ? 0 : 1;
+}
+
+// Step a scene file's world for a number of frames
+static int runScene(int argc, char** argv) {
+    const char* scenePath = argv[2];
+    int frames = (argc > 3) ? atoi(argv[3]) : 1200;
+    int threadCount = (argc > 4) ? atoi(argv[4]) : 0;
+    const char* profilePath = (argc > 5 && strcmp(argv[5], "-") != 0) ? argv[5] : NULL;
+    const char* statsPath = (argc > 6) ? argv[6] : NULL;
+    setProfilerEnabled(profilePath != NULL);
+
+    Simulation sim;
+    initSimulation(&sim, threadCount);
+    double loadStart = nowSeconds();
+    if (!loadScene(&sim, scenePath)) {
+        freeSimulation(&sim);
+        return 1;
+    }
+    double loadTime = nowSeconds() - loadStart;
+    resetCollisionStats();
+
+    double totalTime = 0.0, minTime = 1e30, maxTime = 0.0;
+    for (int f = 0; f < frames; f++) {
+        double start = nowSeconds();
+        profileBeginFrame();
+        stepSimulation(&sim, HEADLESS_DT);
+        profileEndFrame();
+        double elapsed = nowSeconds() - start;
+
+        totalTime += elapsed;
+        if (elapsed < minTime) minTime = elapsed;
+        if (elapsed > maxTime) maxTime = elapsed;
+    }
+
+    printf("scene      : %s, loaded in %.3f ms (%d emitters)\n", scenePath, loadTime * 1000.0, sim.emitterCount);
+    printf("frames     : %d (dt = %.4f s, %d threads)\n", frames, HEADLESS_DT, sim.threads.threadCount);
+    printf("balls      : %d left (%d asleep)\n", Count_BouncingObjects(&sim.balls), sim.balls.asleepCount);
+    printf("objects    : %d left\n", Count_GameObjects(sim.objects));
+    if (frames > 0) {
+        printf("step time  : %.3f ms avg, %.3f ms min, %.3f ms max\n",
+               totalTime * 1000.0 / frames, minTime * 1000.0, maxTime * 1000.0);
+        printf("total      : %.3f s (%.1f steps/s)\n", totalTime, frames / totalTime);
+    }
+    printReport(frames, profilePath, statsPath);
+
+    freeSimulation(&sim);
+    freeGameObjectPools();
+    freeCollisionEffectPool();
+    return 0;
+}
+
+int main(int argc, char** argv) {
+    if (argc > 2 && strcmp(argv[1], "--replay") == 0) return runReplay(argc, argv);
+    if (argc > 2 && strcmp(argv[1], "--scene") == 0) return runScene(argc, argv);
+
+    int frames = (argc > 1) ? atoi(argv[1]) : 1200;
+    int ballTarget = (argc > 2) ? atoi(argv[2]) : 2000;
+    int threadCount = (argc > 3) ? atoi(argv[3]) : 0;
+    unsigned int seed = (argc > 4) ? (unsigned int)atoi(argv[4]) : 1234;
+    const char* profilePath = (argc > 5 && strcmp(argv[5], "-") != 0) ? argv[5] : NULL;
+    const char* statsPath = (argc > 6) ? argv[6] : NULL;
+    setProfilerEnabled(profilePath != NULL);
+
+    Simulation sim;
+    initSimulation(&sim, threadCount);
+    seedSimulation(&sim, seed);
+    createArcScene(&sim);
+    resetCollisionStats();
+
+    int spawned = 0;
+    double totalTime = 0.0, minTime = 1e30, maxTime = 0.0;
+    for (int f = 0; f < frames; f++) {
+        for (int i = 0; i < HEADLESS_SPAWN_BURST && spawned < ballTarget; i++, spawned++) {
+            spawnRandomBall(&sim, (Vector2){ SCREEN_WIDTH * 0.5f, SCREEN_HEIGHT * 0.5f });
+        }
+
+        double start = nowSeconds();
+        profileBeginFrame();
+        stepSimulation(&sim, HEADLESS_DT);
+        profileEndFrame();
+        double elapsed = nowSeconds() - start;
+
+        totalTime += elapsed;
+        if (elapsed < minTime) minTime = elapsed;
+        if (elapsed > maxTime) maxTime = elapsed;
+    }
+
+    printf("frames     : %d (dt = %.4f s, %d threads, seed %u)\n", frames, HEADLESS_DT, sim.threads.threadCount, seed);
+    printf("balls      : %d spawned, %d left (%d asleep)\n", spawned, Count_BouncingObjects(&sim.balls), sim.balls.asleepCount);
+    printf("objects    : %d left\n", Count_GameObjects(sim.objects));
+    if (frames > 0) {
+        printf("step time  : %.3f ms avg, %.3f ms min, %.3f ms max\n",
+               totalTime * 1000.0 / frames, minTime * 1000.0, maxTime * 1000.0);
+        printf("total      : %.3f s (%.1f steps/s)\n", totalTime, frames / totalTime);
+    }
+    printReport(frames, profilePath, statsPath);
+
+    freeSimulation(&sim);
+    freeGameObjectPools();
+    freeCollisionEffectPool();
+    return 0;
+}
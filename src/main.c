@@ -2,6 +2,7 @@
 #include "../include/common.h" // Includes raymath.h indirectly
 #include <stdio.h>  // For debug prints
 #include <stdlib.h> // For malloc, free
+#include <time.h>   // For time
 
 // Prototypes for functions in objects.c
 // GameObject related
@@ -11,11 +12,9 @@ GameObject* createArcCircleObject(Vector2 position, Vector2 velocity, float radi
 void addObjectToList(GameObject** head, GameObject* newObject);
 void freeObjectList(GameObject** head);
 void updateObjectList(GameObject* head, float dt);
-void renderObjectList(GameObject* head);
+void renderObjectList(GameObject* head, float alpha);
 GameObject* createGameObjectWithEffects(GameObject* baseObject, CollisionEffect* effectsList);
 void addCollisionEffectsToGameObject(GameObject* obj, CollisionEffect* effectsList);
-void addCollisionEffectsToBouncingObject(BouncingObject* obj, CollisionEffect* effectsList);
-int Count_BouncingObjects(BouncingObject* head);
 int Count_GameObjects(GameObject* head);
 
 // Collision effects
@@ -27,203 +26,55 @@ CollisionEffect* createSoundPlayEffect(Sound sound, bool continuous);
 void addEffectToList(CollisionEffect** head, CollisionEffect* newEffect);
 void applyEffects(BouncingObject* bouncingObj, GameObject* gameObj, bool isOngoingCollision);
 
-// Handle collisions between bouncing objects
-void handleBallToBallCollisions(BouncingObject* bouncingObjectList, float dt);
+// Collision counters panel (S key): per-frame averages over the last STATS_WINDOW_FRAMES frames
+#define STATS_WINDOW_FRAMES 60
 
-// Screen boundary collision for a bouncing object
-static void applyScreenBoundaryCollisions(BouncingObject* obj) {
-    bool reflected = false;
-    
-    if (obj->position.x - obj->radius < 0) {
-        obj->position.x = obj->radius + EPSILON2; // Push out
-        if (obj->velocity.x < 0) obj->velocity.x *= -1; // Reflect
-        reflected = true;
-    } else if (obj->position.x + obj->radius > SCREEN_WIDTH) {
-        obj->position.x = SCREEN_WIDTH - obj->radius - EPSILON2; // Push out
-        if (obj->velocity.x > 0) obj->velocity.x *= -1; // Reflect
-        reflected = true;
-    }
-    
-    if (obj->position.y - obj->radius < 0) {
-        obj->position.y = obj->radius + EPSILON2; // Push out
-        if (obj->velocity.y < 0) obj->velocity.y *= -1; // Reflect
-        reflected = true;
-    } else if (obj->position.y + obj->radius > SCREEN_HEIGHT) {
-        obj->position.y = SCREEN_HEIGHT - obj->radius - EPSILON2; // Push out
-        if (obj->velocity.y > 0) obj->velocity.y *= -1; // Reflect
-        reflected = true;
-    }
-    
-    if (reflected) { // Apply slight damping on wall hit
-        obj->velocity = Vector2Scale(obj->velocity, 0.99f);
+static void drawCollisionStatsPanel(const CollisionStats* stats, int frames, int x, int y) {
+    static const char* shapeNames[SHAPE_TYPE_COUNT] = { "rectangle", "diamond", "arc" };
+    double perFrame = (frames > 0) ? 1.0 / frames : 0.0;
+    DrawRectangle(x, y, 330, 330, Fade(BLACK, 0.6f));
+    int line = y + 6;
+    DrawText(TextFormat("Collisions per frame (%d frames)", frames), x + 6, line, 12, WHITE);
+    DrawText(TextFormat("bounds tests      %10.1f  (%.0f%% culled)", stats->boundsTests * perFrame,
+                        (stats->boundsTests > 0) ? 100.0 * (1.0 - (double)stats->narrowphaseCalls / stats->boundsTests) : 0.0),
+             x + 6, line += 16, 12, WHITE);
+    DrawText(TextFormat("narrowphase calls %10.1f  (%.0f%% hit)", stats->narrowphaseCalls * perFrame,
+                        (stats->narrowphaseCalls > 0) ? 100.0 * stats->narrowphaseHits / stats->narrowphaseCalls : 0.0),
+             x + 6, line += 16, 12, WHITE);
+    for (int s = 0; s < SHAPE_TYPE_COUNT; s++) {
+        DrawText(TextFormat("  %-15s %10.1f", shapeNames[s], stats->narrowphaseByShape[s] * perFrame), x + 6, line += 16, 12, WHITE);
     }
-}
+    DrawText(TextFormat("ball pair tests   %10.1f  (%.0f%% touch)", stats->ballPairTests * perFrame,
+                        (stats->ballPairTests > 0) ? 100.0 * stats->ballPairContacts / stats->ballPairTests : 0.0),
+             x + 6, line += 16, 12, WHITE);
+    DrawText(TextFormat("max substeps hit  %10.1f  of %.1f balls", stats->maxSubstepsReached * perFrame, stats->ballsStepped * perFrame),
+             x + 6, line += 16, 12, WHITE);
 
-// Handle collisions between bouncing objects
-void handleBallToBallCollisions(BouncingObject* bouncingObjectList, float dt) {
-    // For each pair of balls, check for collisions
-    for (BouncingObject* ball1 = bouncingObjectList; ball1 != NULL; ball1 = ball1->next) {
-        // Skip if this ball shouldn't interact with other bouncing objects
-        if (!ball1->interactWithOtherBouncingObjects) continue;
-        
-        for (BouncingObject* ball2 = ball1->next; ball2 != NULL; ball2 = ball2->next) {
-            // Skip if the second ball shouldn't interact with other bouncing objects
-            if (!ball2->interactWithOtherBouncingObjects) continue;
-            
-            // Calculate distance between centers
-            float distance = Vector2Distance(ball1->position, ball2->position);
-            float minDistance = ball1->radius + ball2->radius;
-            
-            // Check for collision (overlap)
-            if (distance < minDistance) {
-                // Calculate normal vector from ball1 to ball2
-                Vector2 normal = Vector2Normalize(Vector2Subtract(ball2->position, ball1->position));
-                
-                // Calculate overlap amount
-                float overlap = minDistance - distance;
-                
-                // Separate the balls to avoid persistent collision
-                // Distribute movement based on masses (heavier ball moves less)
-                float totalMass = ball1->mass + ball2->mass;
-                float ball1Ratio = ball2->mass / totalMass;
-                float ball2Ratio = ball1->mass / totalMass;
-                
-                // Push balls apart
-                ball1->position = Vector2Subtract(ball1->position, Vector2Scale(normal, overlap * ball1Ratio));
-                ball2->position = Vector2Add(ball2->position, Vector2Scale(normal, overlap * ball2Ratio));
-                
-                // Collision response (elastic collision formula)
-                // Calculate relative velocity
-                Vector2 relativeVelocity = Vector2Subtract(ball1->velocity, ball2->velocity);
-                
-                // Calculate impulse strength
-                float impulseMagnitude = (-(1 + ball1->restitution * ball2->restitution) * 
-                                         Vector2DotProduct(relativeVelocity, normal)) / 
-                                         (1/ball1->mass + 1/ball2->mass);
-                
-                // Apply impulse to velocities
-                ball1->velocity = Vector2Add(ball1->velocity, 
-                                           Vector2Scale(normal, impulseMagnitude / ball1->mass));
-                                           
-                ball2->velocity = Vector2Subtract(ball2->velocity, 
-                                                Vector2Scale(normal, impulseMagnitude / ball2->mass));
-            }
-        }
+    // Substep histogram: share of the balls by number of substeps used
+    DrawText("substeps used per ball", x + 6, line += 22, 12, WHITE);
+    int barBottom = line + 16 + 90;
+    int barWidth = 300 / COLLISION_STATS_SUBSTEP_BUCKETS;
+    for (int b = 0; b < COLLISION_STATS_SUBSTEP_BUCKETS; b++) {
+        double share = (stats->ballsStepped > 0) ? (double)stats->substepHistogram[b] / stats->ballsStepped : 0.0;
+        int height = (int)(share * 90.0);
+        int barX = x + 12 + b * barWidth;
+        DrawRectangle(barX, barBottom - height, barWidth - 2, height, ORANGE);
+        DrawText(TextFormat("%d", b), barX + 2, barBottom + 4, 10, WHITE);
     }
 }
 
+// Renderer comparison (C key): the world is frozen and the frame rate uncapped, then each ball
+// renderer draws RENDER_COMPARE_FRAMES frames; the first RENDER_COMPARE_WARMUP frames of each
+// are not timed
+#define RENDER_COMPARE_FRAMES 240
+#define RENDER_COMPARE_WARMUP 20
 
-// Find and handle all collisions for a single bouncing object with all game objects
-// Returns the number of collisions handled
-int handleBouncingObjectCollisions(BouncingObject* bouncingObj, GameObject* objectList, float dt, int maxSubsteps) {
-    float remainingTimeThisFrame = dt;
-    int substeps = 0;
-    
-    // Check for initial overlap with any object and resolve it before starting simulation
-    for (GameObject* obj = objectList; obj != NULL; obj = obj->next) {
-        float dummy_toi;
-        Vector2 normal;
-        // If already colliding (collision with time=0), push the bouncing object out
-        if (obj->checkCollision(obj, bouncingObj, EPSILON2, &dummy_toi, &normal) && dummy_toi < EPSILON2) {
-            if (Vector2LengthSqr(normal) > EPSILON2) {
-                // Push bouncing object out along collision normal to resolve overlap
-                bouncingObj->position = Vector2Add(bouncingObj->position, 
-                                                  Vector2Scale(normal, bouncingObj->radius * 0.1f));
-            }
-        }
-    }
-    
-    while (remainingTimeThisFrame > EPSILON2 && substeps < maxSubsteps) {
-        float timeToFirstCollision = remainingTimeThisFrame; // Assume no collision initially
-        GameObject* firstCollidingObject = NULL;
-        Vector2 firstCollisionNormal = {0,0};
-        
-        // 1. Find the earliest collision time with any object
-        for (GameObject* obj = objectList; obj != NULL; obj = obj->next) {
-            float toi_candidate;
-            Vector2 normal_candidate;
-            
-            // Check collision for the current remaining time slice
-            if (obj->checkCollision(obj, bouncingObj, remainingTimeThisFrame, 
-                                   &toi_candidate, &normal_candidate)) {
-                // Ensure toi_candidate is valid and the earliest
-                if (toi_candidate >= -EPSILON2 && toi_candidate < timeToFirstCollision) {
-                    timeToFirstCollision = toi_candidate;
-                    firstCollidingObject = obj;
-                    firstCollisionNormal = normal_candidate;
-                }
-            }
-        }
-        
-        // Ensure non-negative time step
-        timeToFirstCollision = fmaxf(0.0f, timeToFirstCollision);
-
-        // 2. Advance bouncing object by timeToFirstCollision
-        bouncingObj->position = Vector2Add(bouncingObj->position, 
-                                          Vector2Scale(bouncingObj->velocity, timeToFirstCollision));
-        
-        // 3. Update the objects (they move independently)
-        //updateObjectList(objectList, timeToFirstCollision);
-        
-        // 4. Reduce remaining time for this frame
-        remainingTimeThisFrame -= timeToFirstCollision;
-        
-        // 5. If a collision occurred, resolve it
-        if (firstCollidingObject != NULL) {
-            bool isValidNormal = (Vector2LengthSqr(firstCollisionNormal) > EPSILON2);
-            
-            // Collision response - velocity reflection with restitution
-            if (isValidNormal) {
-                // Calculate reflected velocity with restitution factor
-                bouncingObj->velocity = Vector2Scale(
-                    Vector2Reflect(bouncingObj->velocity, firstCollisionNormal), 
-                    bouncingObj->restitution
-                );
-                
-                // Avoid precision issues by nudging away from collision surface
-                bouncingObj->position = Vector2Add(
-                    bouncingObj->position, 
-                    Vector2Scale(firstCollisionNormal, bouncingObj->radius * 0.05f)
-                );
-            } else {
-                // Fallback for invalid normal - push away from object center
-                Vector2 pushDir = Vector2Normalize(
-                    Vector2Subtract(bouncingObj->position, firstCollidingObject->position)
-                );
-                
-                if (Vector2LengthSqr(pushDir) > EPSILON2) {
-                    // Push away from object
-                    bouncingObj->position = Vector2Add(
-                        bouncingObj->position, 
-                        Vector2Scale(pushDir, bouncingObj->radius * 0.1f)
-                    );
-                    
-                    // Simple reflection based on direction to object center
-                    bouncingObj->velocity = Vector2Scale(
-                        Vector2Reflect(bouncingObj->velocity, pushDir), 
-                        bouncingObj->restitution
-                    );
-                }
-            }
-            
-            // Apply any collision effects (on initial collision only)
-            applyEffects(bouncingObj, firstCollidingObject, false);
-        }
-        
-        substeps++;
-    }
-    
-    return substeps;
-}
+// Usage: bouncing_ball [scene]
+//   scene: scene file to build the world from (see scene.c), the arc scene by default
+int main(int argc, char** argv) {
+    const char* scenePath = (argc > 1) ? argv[1] : NULL;
 
-void onArcEscape(GameObject* arc, BouncingObject* ball) {
-    if (!arc) return;
-    (void)ball; // Unused parameter
-    // Mark the arc for deletion when a ball escapes through it
-    arc->markedForDeletion = true;
-}
 
-int main(void) {
     // Initialize window and set target FPS
     InitWindow(SCREEN_WIDTH, SCREEN_HEIGHT, "Multi-Object Physics Simulation");
     SetTargetFPS(120);
@@ -243,40 +94,51 @@ int main(void) {
     Rectangle decreaseButton = { SCREEN_WIDTH/2 - 100, SCREEN_HEIGHT - 40, 30, 30 };
     Rectangle increaseButton = { SCREEN_WIDTH/2 + 70, SCREEN_HEIGHT - 40, 30, 30 };
     Rectangle speedDisplay = { SCREEN_WIDTH/2 - 65, SCREEN_HEIGHT - 40, 130, 30 };
-   
-    // --- Create the static and moving objects ---
-    GameObject* staticObjectList = NULL; // Objects that don't bounce but can be collided with
-    BouncingObject* bouncingObjectList = NULL; // Objects that bounce around
-    
-
-    // Create 5 Red Arcs which disappear when balls escape through them
-    for (int i = 0; i < 10; i++) {
-        GameObject* arc = createArcCircleObject(            (Vector2){ SCREEN_WIDTH*0.5f, SCREEN_HEIGHT*0.5f }, 
-            (Vector2){ 0, 0 }, 
-            50 + i*25,
-            0.0f, // Start angle
-            300.0f, // End angle
-            5.0f, // Thickness
-            RED, 
-            false, // Static
-            60.0f+i*20, // No rotation speed
-            false // Remove escaped balls
-        );
-        addEscapeCallbackToArcCircle(arc, onArcEscape);
-        addObjectToList(&staticObjectList, arc);
 
+    // Ball renderer: one textured quad per ball (batched) or DrawCircleV per ball
+    bool batchedBalls = true;
+    bool batchedBeforeCompare = true;
+    int compareFrame = -1;              // Frame of the running renderer comparison, -1 if none
+    double compareTime[2] = { 0, 0 };   // Time spent by each renderer (0: DrawCircleV, 1: batched)
+    float compareFps[2] = { 0, 0 };     // Result of the last comparison
+   
+    // --- Create the world: static and moving objects, bouncing objects ---
+    uint32_t seed = (uint32_t)time(NULL);
+    Simulation sim;
+    initSimulation(&sim, 0); // Collision passes run on every core
+    seedSimulation(&sim, seed);
+    if (scenePath == NULL) {
+        createArcScene(&sim);
+    } else if (!loadScene(&sim, scenePath)) {
+        freeSimulation(&sim);
+        freeGameObjectPools();
+        freeCollisionEffectPool();
+        CloseWindow();
+        return 1;
     }
+
+    // The input of every frame is recorded from the start, so the session can be replayed
+    // headless (written to replay.bin on R and when quitting)
+    Replay replay;
+    initReplay(&replay, seed, scenePath);
+    bool recording = true;
     
     
+    bool showProfiler = false; // P: frame profiler overlay (records while shown)
+    bool showStats = false;    // S: collision counters panel
+    CollisionStats statsAtWindowStart = getCollisionStats();
+    CollisionStats shownStats = {0};
+    int statsWindowFrame = 0;
+    int shownStatsFrames = 0;
+
     // Main game loop
     while (!WindowShouldClose()) {        // Get the elapsed time for this frame
-        float dt = GetFrameTime() * timeMultiplier;  // Apply time multiplier to control simulation speed
-        
-        // Update all static objects (especially important for rotating objects like arcCircle)
-        updateObjectList(staticObjectList, dt);
+        profileBeginFrame();
+        // Input of this frame for the simulation: the world advances by frameTime * timeMultiplier
+        ReplayFrame input = { .frameTime = GetFrameTime(), .timeMultiplier = timeMultiplier, .mouse = GetMousePosition() };
         
         // Handle speed controller buttons
-        Vector2 mousePoint = GetMousePosition();
+        Vector2 mousePoint = input.mouse;
         
         // Check decrease button
         if ((CheckCollisionPointRec(mousePoint, decreaseButton) && IsMouseButtonPressed(MOUSE_BUTTON_LEFT)) || IsKeyPressed(KEY_LEFT)) {
@@ -294,70 +156,128 @@ int main(void) {
             }
         }
         
-        // Handle keyboard input - add new bouncing objects with mouse click
-        if (IsMouseButtonPressed(MOUSE_BUTTON_LEFT) || IsKeyDown(KEY_SPACE)) {
-            // Don't create a ball if clicking on speed controls
-            if (!CheckCollisionPointRec(mousePoint, decreaseButton) && 
-                !CheckCollisionPointRec(mousePoint, increaseButton) &&
-                !CheckCollisionPointRec(mousePoint, speedDisplay)){
-                int repetition = 1;
-                    if (IsMouseButtonDown(MOUSE_BUTTON_RIGHT)){
-                        repetition = 25;
+        // P: show the profiler, D: dump the recorded frames
+        if (IsKeyPressed(KEY_P)) {
+            showProfiler = !showProfiler;
+            setProfilerEnabled(showProfiler);
+        }
+        if (IsKeyPressed(KEY_D) && getProfileFrameCount() > 0) {
+            bool written = writeProfileCSV("profile.csv") && writeProfileTrace("profile_trace.json");
+            printf("%s\n", written ? "Profile written to profile.csv and profile_trace.json" : "Could not write the profile");
+        }
+
+        if (IsKeyPressed(KEY_S)) showStats = !showStats;
+
+        // F5: save the world, F9: load it back
+        if (IsKeyPressed(KEY_F5)) {
+            printf("%s\n", saveSimulationSnapshot(&sim, "snapshot.bin") ? "World saved to snapshot.bin" : "Could not save the world");
+        }
+        if (IsKeyPressed(KEY_F9)) {
+            if (loadSimulationSnapshot(&sim, "snapshot.bin")) {
+                printf("World loaded from snapshot.bin\n");
+                if (recording) printf("Recording stopped: a replay starts from the scene, not from a snapshot\n");
+                recording = false;
+            } else {
+                printf("Could not load snapshot.bin\n");
+            }
+        }
+
+        // R: write the session recorded so far
+        if (IsKeyPressed(KEY_R) && recording) {
+            printf("%s\n", saveReplay(&replay, &sim, "replay.bin") ? "Replay written to replay.bin" : "Could not write replay.bin");
+        }
+
+        // B: switch ball renderer, C: compare both renderers
+        if (IsKeyPressed(KEY_B) && compareFrame < 0) batchedBalls = !batchedBalls;
+        if (IsKeyPressed(KEY_C) && compareFrame < 0) {
+            compareFrame = 0;
+            compareTime[0] = compareTime[1] = 0.0;
+            batchedBeforeCompare = batchedBalls;
+            SetTargetFPS(0);
+        }
+        if (compareFrame >= 0) {
+            // GetFrameTime is the time of the previous frame, drawn by the renderer of the previous compareFrame
+            int timedFrame = compareFrame - 1;
+            if (timedFrame >= 0 && timedFrame % RENDER_COMPARE_FRAMES >= RENDER_COMPARE_WARMUP) {
+                compareTime[timedFrame / RENDER_COMPARE_FRAMES] += GetFrameTime();
+            }
+            if (compareFrame == 2 * RENDER_COMPARE_FRAMES) {
+                for (int r = 0; r < 2; r++) {
+                    compareFps[r] = (float)((RENDER_COMPARE_FRAMES - RENDER_COMPARE_WARMUP) / compareTime[r]);
                 }
-                Vector2 mousePos = GetMousePosition();
-                do {
-                    Vector2 speed ={
-                        (float)(100 + rand() % 200) * (rand() % 2 == 0 ? 1 : -1),
-                        (float)(100 + rand() % 200) * (rand() % 2 == 0 ? 1 : -1)
-                    };
-                    BouncingObject* newBall = createBouncingObject(
-                        mousePos, 
-                        speed, 
-                        10 + (rand() % 20), // Random size
-                        (Color){ 255, 255, 0, 255 }, // Yellow color
-                        0.5f + ((float)rand() / RAND_MAX) * 2.5f, // Random mass between 0.5 and 3.0
-                        1.0f, // Restitution (bounciness)
-                        true // By default, allow interaction with other bouncing objects
-                    );
-                    addBouncingObjectToList(&bouncingObjectList, newBall);
-                    repetition--;
-                } while (repetition > 0);
+                compareFrame = -1;
+                batchedBalls = batchedBeforeCompare;
+                SetTargetFPS(120);
+            } else {
+                batchedBalls = compareFrame >= RENDER_COMPARE_FRAMES;
+                input.frameTime = 0.0f; // Same world for both renderers
             }
         }
-        
-        // Process physics for all bouncing objects
-        for (BouncingObject* ball = bouncingObjectList; ball != NULL; ball = ball->next) {
-            // Handle collisions with all static and moving non-bouncing objects
-            handleBouncingObjectCollisions(ball, staticObjectList, dt, 10);
-            
-            // Apply simple screen boundary collisions
-            applyScreenBoundaryCollisions(ball);
+
+        // Left click or space adds a ball at the mouse (25 with the right button held),
+        // except on the speed controls
+        if (IsMouseButtonPressed(MOUSE_BUTTON_LEFT)) input.input |= REPLAY_INPUT_LEFT_PRESSED;
+        if (IsMouseButtonDown(MOUSE_BUTTON_RIGHT)) input.input |= REPLAY_INPUT_RIGHT_DOWN;
+        if (IsKeyDown(KEY_SPACE)) input.input |= REPLAY_INPUT_SPACE_DOWN;
+        if (CheckCollisionPointRec(mousePoint, decreaseButton) ||
+            CheckCollisionPointRec(mousePoint, increaseButton) ||
+            CheckCollisionPointRec(mousePoint, speedDisplay)) {
+            input.input |= REPLAY_INPUT_OVER_CONTROLS;
         }
-          // Handle collisions between bouncing objects
-        handleBallToBallCollisions(bouncingObjectList, dt);
-        
-        // Remove any balls marked for deletion (e.g. those that have escaped through arcs)
-        removeMarkedBouncingObjects(&bouncingObjectList);
         
-        // Remove any game objects marked for deletion (e.g. arcs that had balls escape through them)
-        removeMarkedGameObjects(&staticObjectList);
+        // Spawn the balls, then advance the world in fixed steps: object updates, collisions,
+        // removal of marked objects
+        if (recording && !recordReplayFrame(&replay, &input)) {
+            printf("Recording stopped: out of memory\n");
+            recording = false;
+        }
+        applyReplayFrame(&sim, &input);
+
+        // Counters of the last window of frames (the threads' counters are merged when read)
+        if (++statsWindowFrame == STATS_WINDOW_FRAMES) {
+            CollisionStats now = getCollisionStats();
+            shownStats = now;
+            accumulateCollisionStats(&shownStats, &statsAtWindowStart, -1);
+            shownStatsFrames = statsWindowFrame;
+            statsAtWindowStart = now;
+            statsWindowFrame = 0;
+        }
+        float alpha = getSimulationAlpha(&sim); // Draw between the last two steps
         
         // Begin drawing
         BeginDrawing();
+        profileBegin(PROFILE_RENDER);
         ClearBackground(DARKGRAY);
         
         // Render all objects
-        renderObjectList(staticObjectList);
-        renderBouncingObjectList(bouncingObjectList);
+        renderObjectList(sim.objects, alpha);
+        if (batchedBalls) {
+            renderBouncingObjectListBatched(&sim.balls, alpha);
+        } else {
+            renderBouncingObjectList(&sim.balls, alpha);
+        }
         
         // Display instructions
         int displayPadding = -20;
         DrawText("Left click: Add new random bouncing ball", 10, displayPadding+=30, 20, WHITE);
         DrawText("Right click + Left click: Add 50 balls at once", 10, displayPadding+=30, 20, WHITE);
+        DrawText("B: Switch ball renderer, C: Compare renderers", 10, displayPadding+=30, 20, WHITE);
+        DrawText("P: Profiler, D: Dump profile (CSV and trace), S: Collision stats", 10, displayPadding+=30, 20, WHITE);
+        DrawText("F5: Save the world, F9: Load it back", 10, displayPadding+=30, 20, WHITE);
+        DrawText(recording ? TextFormat("R: Write replay (%d frames recorded)", replay.frameCount) : "Not recording (snapshot loaded)",
+                 10, displayPadding+=30, 20, WHITE);
         DrawText("ESC: Quit", 10, displayPadding+=30, 20, WHITE);
         DrawFPS(SCREEN_WIDTH - 100, 10);
-        DrawText(TextFormat("Bouncing Objects: %d", Count_BouncingObjects(bouncingObjectList)), 10, displayPadding+=30, 20, WHITE);
-        DrawText(TextFormat("Static Objects: %d", Count_GameObjects(staticObjectList)), 10, displayPadding+=30, 20, WHITE);
+        DrawText(TextFormat("Bouncing Objects: %d (%d awake, %d asleep)", Count_BouncingObjects(&sim.balls),
+                            Count_BouncingObjects(&sim.balls) - sim.balls.asleepCount, sim.balls.asleepCount), 10, displayPadding+=30, 20, WHITE);
+        DrawText(TextFormat("Static Objects: %d", Count_GameObjects(sim.objects)), 10, displayPadding+=30, 20, WHITE);
+        if (scenePath) DrawText(TextFormat("Scene: %s (%d emitters)", scenePath, sim.emitterCount), 10, displayPadding+=30, 20, WHITE);
+        DrawText(TextFormat("Ball renderer: %s", batchedBalls ? "batched quads" : "DrawCircleV"), 10, displayPadding+=30, 20, WHITE);
+        if (compareFrame >= 0) {
+            DrawText(TextFormat("Comparing renderers... %d%%", compareFrame * 100 / (2 * RENDER_COMPARE_FRAMES)), 10, displayPadding+=30, 20, YELLOW);
+        } else if (compareFps[0] > 0.0f) {
+            DrawText(TextFormat("DrawCircleV: %.0f FPS, batched: %.0f FPS", compareFps[0], compareFps[1]), 10, displayPadding+=30, 20, YELLOW);
+        }
 
         // Render speed controller UI
         DrawRectangleRec(decreaseButton, LIGHTGRAY);
@@ -367,12 +287,26 @@ int main(void) {
         DrawText(">", increaseButton.x + 10, increaseButton.y + 5, 20, BLACK);
         DrawText(TextFormat("x%.2f", timeMultiplier), speedDisplay.x + 10, speedDisplay.y + 5, 20, WHITE);
 
+        if (showStats) drawCollisionStatsPanel(&shownStats, shownStatsFrames, SCREEN_WIDTH - 740, 40);
+        if (showProfiler) {
+            drawProfilerOverlay((Rectangle){ SCREEN_WIDTH - 370, 40, 360, 300 }, 1.0f / 120.0f);
+        }
+        profileEnd(PROFILE_RENDER);
+
         EndDrawing();
+        profileEndFrame();
+        if (compareFrame >= 0) compareFrame++;
     }
     
     // Cleanup
-    freeObjectList(&staticObjectList);
-    freeBouncingObjectList(&bouncingObjectList);
+    if (recording && replay.frameCount > 0) {
+        printf("%s\n", saveReplay(&replay, &sim, "replay.bin") ? "Replay written to replay.bin" : "Could not write replay.bin");
+    }
+    freeReplay(&replay);
+    freeSimulation(&sim);
+    freeGameObjectPools();
+    freeCollisionEffectPool();
+    freeBallRenderer();
     
     CloseWindow();
     return 0;
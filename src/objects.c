@@ -3,6 +3,9 @@
 #include <stdio.h>  // For debug prints (optional)
 #include <math.h>   // For sqrtf, fabsf, fmaxf
 
+// Building with -DHEADLESS compiles out every raylib drawing and audio call, so the
+// simulation can be linked without raylib (benchmarks, machines without a display)
+
 // --- Physics Helper Implementations ---
 
 // Closest point on segment AB to point P
@@ -77,6 +80,63 @@ bool sweptBallToStaticPointCollision(Vector2 point,
     return false;
 }
 
+// Hit of a moving ball on the inside of a static segment (its endpoints are tested separately),
+// given the segment's start, unit direction, unit normal (-dir.y, dir.x) and length.
+// Only a hit earlier than `before` is reported; t is not clamped to 0.
+static bool sweptBallToSegmentLine(Vector2 segP1, Vector2 segDirNormalized, Vector2 segPerpDir, float segLength,
+                                   Vector2 ballPos, Vector2 ballVel, float ballRadius,
+                                   float dt_max, float before, float* t, Vector2* normal) {
+    Vector2 relPos = Vector2Subtract(ballPos, segP1);
+
+    // Distance from ball center to the infinite line defined by the segment
+    // d = (C - P1) . PerpDir
+    float distToLine = Vector2DotProduct(relPos, segPerpDir);
+    // Velocity component towards the line
+    // v_perp = V . PerpDir
+    float velCompTowardsLine = Vector2DotProduct(ballVel, segPerpDir);
+
+    if (fabsf(velCompTowardsLine) < EPSILON2) { // Ball moving parallel to segment line
+        return false;
+    }
+
+    // Time to reach distance R from line: (R - d) / v_perp or (-R - d) / v_perp
+    float t_line1 = (ballRadius - distToLine) / velCompTowardsLine;
+    float t_line2 = (-ballRadius - distToLine) / velCompTowardsLine;
+    
+    float t_line_collision = -1.0f;
+    if (t_line1 >= -EPSILON2 && t_line1 <= dt_max + EPSILON2) {
+        t_line_collision = t_line1;
+    }
+    if (t_line2 >= -EPSILON2 && t_line2 <= dt_max + EPSILON2) {
+        if (t_line_collision < -EPSILON2 || t_line2 < t_line_collision) {
+            t_line_collision = t_line2;
+        }
+    }
+
+    if (t_line_collision < -EPSILON2 || t_line_collision >= before) return false;
+
+    // Check if the collision point on the line is within the segment's projection
+    Vector2 ballCenterAtToi = Vector2Add(ballPos, Vector2Scale(ballVel, t_line_collision));
+    // Point on segment line closest to ballCenterAtToi (this is ballCenterAtToi - (dist_at_toi * segPerpDir))
+    Vector2 collisionPointOnLine = Vector2Subtract(ballCenterAtToi, Vector2Scale(segPerpDir, Vector2DotProduct(Vector2Subtract(ballCenterAtToi, segP1), segPerpDir)));
+    
+    // Project this point onto the segment vector (from segP1)
+    float projection = Vector2DotProduct(Vector2Subtract(collisionPointOnLine, segP1), segDirNormalized);
+
+    if (projection < -EPSILON2 || projection > segLength + EPSILON2) return false; // Collision point is off the segment
+
+    *t = t_line_collision;
+    // Normal is from line to ball. If ball hit from "positive" side of segPerpDir, normal is segPerpDir.
+    // If hit from "negative" side, normal is -segPerpDir.
+    // This is equivalent to: normal = sign(distToLine_at_impact) * segPerpDir
+    // Or, more simply, normal = normalize(ball_center_at_toi - collisionPointOnLine)
+    *normal = Vector2Normalize(Vector2Subtract(ballCenterAtToi, collisionPointOnLine));
+    if (Vector2LengthSqr(*normal) < EPSILON2) { // Should not happen if velCompTowardsLine != 0
+        *normal = (distToLine > 0) ? segPerpDir : Vector2Negate(segPerpDir);
+    }
+    return true;
+}
+
 // Swept collision: ball moving towards a static line segment
 bool sweptBallToStaticSegmentCollision(Vector2 segP1, Vector2 segP2,
                                        Vector2 ballPos, Vector2 ballVel, float ballRadius,
@@ -116,60 +176,16 @@ bool sweptBallToStaticSegmentCollision(Vector2 segP1, Vector2 segP2,
     }
 
     // Project ball's position relative to segP1 onto segmentVec and its perpendicular
-    Vector2 relPos = Vector2Subtract(ballPos, segP1);
     Vector2 segDirNormalized = Vector2Normalize(segmentVec);
     Vector2 segPerpDir = {-segDirNormalized.y, segDirNormalized.x}; // Normal to the segment's direction
 
-    // Distance from ball center to the infinite line defined by the segment
-    // d = (C - P1) . PerpDir
-    float distToLine = Vector2DotProduct(relPos, segPerpDir);
-    // Velocity component towards the line
-    // v_perp = V . PerpDir
-    float velCompTowardsLine = Vector2DotProduct(ballVel, segPerpDir);
-
-    if (fabsf(velCompTowardsLine) < EPSILON2) { // Ball moving parallel to segment line
-        if (collided) {
-            *toi = min_valid_toi;
-            *normal = final_normal;
-        }
-        return collided;
-    }
-
-    // Time to reach distance R from line: (R - d) / v_perp or (-R - d) / v_perp
-    float t_line1 = (ballRadius - distToLine) / velCompTowardsLine;
-    float t_line2 = (-ballRadius - distToLine) / velCompTowardsLine;
-    
-    float t_line_collision = -1.0f;
-    if (t_line1 >= -EPSILON2 && t_line1 <= dt_max + EPSILON2) {
-        t_line_collision = t_line1;
-    }
-    if (t_line2 >= -EPSILON2 && t_line2 <= dt_max + EPSILON2) {
-        if (t_line_collision < -EPSILON2 || t_line2 < t_line_collision) {
-            t_line_collision = t_line2;
-        }
-    }
-
-    if (t_line_collision >= -EPSILON2 && t_line_collision < min_valid_toi) {
-        // Check if the collision point on the line is within the segment's projection
-        Vector2 ballCenterAtToi = Vector2Add(ballPos, Vector2Scale(ballVel, t_line_collision));
-        // Point on segment line closest to ballCenterAtToi (this is ballCenterAtToi - (dist_at_toi * segPerpDir))
-        Vector2 collisionPointOnLine = Vector2Subtract(ballCenterAtToi, Vector2Scale(segPerpDir, Vector2DotProduct(Vector2Subtract(ballCenterAtToi, segP1), segPerpDir)));
-        
-        // Project this point onto the segment vector (from segP1)
-        float projection = Vector2DotProduct(Vector2Subtract(collisionPointOnLine, segP1), segDirNormalized);
-
-        if (projection >= -EPSILON2 && projection <= sqrtf(segmentLenSq) + EPSILON2) { // Collision point is on the segment
-            min_valid_toi = t_line_collision;
-            // Normal is from line to ball. If ball hit from "positive" side of segPerpDir, normal is segPerpDir.
-            // If hit from "negative" side, normal is -segPerpDir.
-            // This is equivalent to: normal = sign(distToLine_at_impact) * segPerpDir
-            // Or, more simply, normal = normalize(ball_center_at_toi - collisionPointOnLine)
-            final_normal = Vector2Normalize(Vector2Subtract(ballCenterAtToi, collisionPointOnLine));
-            if (Vector2LengthSqr(final_normal) < EPSILON2) { // Should not happen if velCompTowardsLine != 0
-                final_normal = (distToLine > 0) ? segPerpDir : Vector2Negate(segPerpDir);
-            }
-            collided = true;
-        }
+    float t_line;
+    Vector2 line_normal;
+    if (sweptBallToSegmentLine(segP1, segDirNormalized, segPerpDir, sqrtf(segmentLenSq),
+                               ballPos, ballVel, ballRadius, dt_max, min_valid_toi, &t_line, &line_normal)) {
+        min_valid_toi = t_line;
+        final_normal = line_normal;
+        collided = true;
     }
     
     if (collided) {
@@ -184,6 +200,48 @@ bool sweptBallToStaticSegmentCollision(Vector2 segP1, Vector2 segP2,
 }
 
 
+// --- Object Storage ---
+
+// GameObjects and their shape data come from these pools instead of malloc, so creating
+// objects (scenes, snapshots) costs a pointer pop once the pools have grown
+typedef union {
+    ShapeDataRectangle rectangle;
+    ShapeDataDiamond diamond;
+    ShapeDataArcCircle arc;
+} ShapeDataStorage;
+
+static ObjectPool gameObjectPool = OBJECT_POOL_INIT(sizeof(GameObject), 64);
+static ObjectPool shapeDataPool = OBJECT_POOL_INIT(sizeof(ShapeDataStorage), 64);
+
+// Take a GameObject and room for its shape data from the pools, NULL if out of memory
+GameObject* allocGameObject(void) {
+    GameObject* obj = (GameObject*)poolAlloc(&gameObjectPool);
+    if (!obj) return NULL;
+    obj->shapeData = poolAlloc(&shapeDataPool);
+    if (!obj->shapeData) {
+        poolFree(&gameObjectPool, obj);
+        return NULL;
+    }
+    return obj;
+}
+
+// Destroy an object (it must be out of any list) and give it back to the pools
+void freeGameObject(GameObject* obj) {
+    removeObjectFromTree(obj);
+    freeEffectList(&obj->onCollisionEffects);
+    if (obj->destroy) {
+        obj->destroy(obj);
+    }
+    poolFree(&shapeDataPool, obj->shapeData);
+    poolFree(&gameObjectPool, obj);
+}
+
+// Release the memory of the object pools. Every object must have been freed before.
+void freeGameObjectPools(void) {
+    freeObjectPool(&gameObjectPool);
+    freeObjectPool(&shapeDataPool);
+}
+
 // --- Object List Management ---
 void addObjectToList(GameObject** head, GameObject* newObject) {
     if (!newObject) return;
@@ -196,10 +254,7 @@ void freeObjectList(GameObject** head) {
     GameObject* next;
     while (current != NULL) {
         next = current->next;
-        if (current->destroy) {
-            current->destroy(current);
-        }
-        free(current);
+        freeGameObject(current);
         current = next;
     }
     *head = NULL;
@@ -207,20 +262,32 @@ void freeObjectList(GameObject** head) {
 
 void updateObjectList(GameObject* head, float dt) {
     for (GameObject* current = head; current != NULL; current = current->next) {
+        current->previousPosition = current->position;
         if (current->update) {
             current->update(current, dt);
         }
     }
 }
 
-void renderObjectList(GameObject* head) {
+// alpha: see GameObject.render
+void renderObjectList(GameObject* head, float alpha) {
     for (GameObject* current = head; current != NULL; current = current->next) {
         if (current->render) {
-            current->render(current);
+            current->render(current, alpha);
         }
     }
 }
 
+#ifndef HEADLESS
+// Position to draw an object at, between its previous and current position.
+// Objects that jumped (screen wrap) are drawn where they are now.
+static Vector2 getRenderPosition(const GameObject* self, float alpha) {
+    Vector2 delta = Vector2Subtract(self->position, self->previousPosition);
+    if (fabsf(delta.x) > SCREEN_WIDTH * 0.5f || fabsf(delta.y) > SCREEN_HEIGHT * 0.5f) return self->position;
+    return Vector2Add(self->previousPosition, Vector2Scale(delta, alpha));
+}
+#endif
+
 // Remove all game objects marked for deletion
 void removeMarkedGameObjects(GameObject** head) {
     GameObject* current = *head;
@@ -239,11 +306,7 @@ void removeMarkedGameObjects(GameObject** head) {
             }
             
             // Free resources associated with this object
-            freeEffectList(&current->onCollisionEffects);
-            if (current->destroy) {
-                current->destroy(current);
-            }
-            free(current);
+            freeGameObject(current);
         } else {
             prev = current;
         }
@@ -252,6 +315,52 @@ void removeMarkedGameObjects(GameObject** head) {
     }
 }
 
+// --- Bounding Volumes ---
+
+// Recompute the cached axis-aligned bounding box of an object from its position and shape
+void updateGameObjectBounds(GameObject* obj) {
+    if (!obj || !obj->shapeData) return;
+    Vector2 halfExtents = {0, 0};
+    switch (obj->type) {
+        case SHAPE_RECTANGLE: {
+            ShapeDataRectangle* data = (ShapeDataRectangle*)obj->shapeData;
+            halfExtents = (Vector2){ data->width / 2.0f, data->height / 2.0f };
+        } break;
+        case SHAPE_DIAMOND: {
+            ShapeDataDiamond* data = (ShapeDataDiamond*)obj->shapeData;
+            halfExtents = (Vector2){ data->halfWidth, data->halfHeight };
+        } break;
+        case SHAPE_CIRCLE_ARC: {
+            // Whole circle, so the box doesn't depend on the rotation
+            ShapeDataArcCircle* data = (ShapeDataArcCircle*)obj->shapeData;
+            float outerRadius = data->radius + data->thickness / 2.0f;
+            halfExtents = (Vector2){ outerRadius, outerRadius };
+        } break;
+    }
+    obj->boundsMin = Vector2Subtract(obj->position, halfExtents);
+    obj->boundsMax = Vector2Add(obj->position, halfExtents);
+
+    // Keep the broadphase tree in sync with the new bounds
+    if (obj->tree) moveObjectInTree(obj);
+}
+
+// Conservative test: can the ball, moving for dt relative to the object, touch the object's bounds?
+// When this returns false, checkCollision is guaranteed to find nothing for this time step.
+bool canBallReachGameObject(const BouncingObject* ball, const GameObject* obj, float dt) {
+    Vector2 relVel = Vector2Subtract(ball->velocity, obj->velocity);
+    Vector2 endPos = Vector2Add(ball->position, Vector2Scale(relVel, dt));
+    float reach = ball->radius + BOUNDS_MARGIN;
+
+    // Swept AABB of the ball over the time step
+    float minX = fminf(ball->position.x, endPos.x) - reach;
+    float maxX = fmaxf(ball->position.x, endPos.x) + reach;
+    float minY = fminf(ball->position.y, endPos.y) - reach;
+    float maxY = fmaxf(ball->position.y, endPos.y) + reach;
+
+    return maxX >= obj->boundsMin.x && minX <= obj->boundsMax.x &&
+           maxY >= obj->boundsMin.y && minY <= obj->boundsMax.y;
+}
+
 // --- Generic Object Functions ---
 static void updateGenericMovingObject(GameObject* self, float dt) {
     if (!self || self->isStatic) return;
@@ -262,8 +371,11 @@ static void updateGenericMovingObject(GameObject* self, float dt) {
     if (self->position.x > SCREEN_WIDTH + 50) self->position.x = -40;
     if (self->position.y < -50) self->position.y = SCREEN_HEIGHT + 40;
     if (self->position.y > SCREEN_HEIGHT + 50) self->position.y = -40;
+
+    updateGameObjectBounds(self);
 }
 
+// Free what the shape data owns (the shape data itself goes back to its pool with the object)
 static void destroyGenericShapeData(GameObject* self) {
     if (self && self->shapeData) {
         // Free any callback lists for ArcCircle objects
@@ -271,23 +383,28 @@ static void destroyGenericShapeData(GameObject* self) {
             ShapeDataArcCircle* arcData = (ShapeDataArcCircle*)self->shapeData;
             freeArcCircleCallbackList(&arcData->onCollisionCallbacks);
             freeArcCircleCallbackList(&arcData->onEscapeCallbacks);
+            free(arcData->meshDirs);
+            arcData->meshDirs = NULL;
         }
-        
-        free(self->shapeData);
-        self->shapeData = NULL;
     }
 }
 
 // --- Rectangle Object ---
-static void renderRectangleObj(GameObject* self) {
+static void renderRectangleObj(GameObject* self, float alpha) {
+#ifndef HEADLESS
     ShapeDataRectangle* data = (ShapeDataRectangle*)self->shapeData;
+    Vector2 position = getRenderPosition(self, alpha);
     // DrawRectanglePro takes center, dimensions, origin (for rotation), rotation, color
     DrawRectanglePro(
-        (Rectangle){self->position.x, self->position.y, data->width, data->height},
+        (Rectangle){position.x, position.y, data->width, data->height},
         (Vector2){data->width / 2.0f, data->height / 2.0f}, // Origin at center
         0.0f, // No rotation for now
         data->color
     );
+#else
+    (void)self;
+    (void)alpha;
+#endif
 }
 
 static bool checkCollisionRectangleObj(GameObject* self, BouncingObject* bouncingObj, float dt_step, float* timeOfImpact, Vector2* collisionNormal) {    ShapeDataRectangle* data = (ShapeDataRectangle*)self->shapeData;
@@ -299,45 +416,27 @@ static bool checkCollisionRectangleObj(GameObject* self, BouncingObject* bouncin
     float hh = data->height / 2.0f;
     Vector2 objPos = self->position; // Current position of the object for segment calculation
 
-    Vector2 p1 = {objPos.x - hw, objPos.y - hh}; // Top-left
-    Vector2 p2 = {objPos.x + hw, objPos.y - hh}; // Top-right
-    Vector2 p3 = {objPos.x + hw, objPos.y + hh}; // Bottom-right
-    Vector2 p4 = {objPos.x - hw, objPos.y + hh}; // Bottom-left
-
-    Vector2 segments[4][2] = {
-        {p1, p2}, {p2, p3}, {p3, p4}, {p4, p1}
+    Vector2 vertices[4] = {
+        {objPos.x - hw, objPos.y - hh}, // Top-left
+        {objPos.x + hw, objPos.y - hh}, // Top-right
+        {objPos.x + hw, objPos.y + hh}, // Bottom-right
+        {objPos.x - hw, objPos.y + hh}  // Bottom-left
     };
 
-    float min_toi = dt_step + EPSILON2; // Initialize with a value larger than dt_step
-    bool collided_overall = false;    for (int i = 0; i < 4; ++i) {
-        float current_segment_toi;
-        Vector2 current_segment_normal;
-        // Pass bouncing object's current position, its RELATIVE velocity, and segment (considered static in this call)
-        if (sweptBallToStaticSegmentCollision(segments[i][0], segments[i][1],
-                                              bouncingObj->position, relBallVel, bouncingObj->radius,
-                                              dt_step, &current_segment_toi, &current_segment_normal)) {
-            if (current_segment_toi >= -EPSILON2 && current_segment_toi < min_toi) {
-                min_toi = current_segment_toi;
-                *collisionNormal = current_segment_normal; // Normal from segment towards ball
-                collided_overall = true;
-            }
-        }
-    }
-
-    if (collided_overall) {
-        *timeOfImpact = min_toi;
-    }
-    return collided_overall;
+    // Pass bouncing object's current position, its RELATIVE velocity, and the edges (considered static in this call)
+    // The normal goes from the edge towards the ball
+    return sweptBallToStaticPolygonCollision(vertices, 4, bouncingObj->position, relBallVel, bouncingObj->radius,
+                                             dt_step, timeOfImpact, collisionNormal);
 }
 
 GameObject* createRectangleObject(Vector2 position, Vector2 velocity, float width, float height, Color color, bool isStatic) {
-    GameObject* obj = (GameObject*)malloc(sizeof(GameObject));
+    GameObject* obj = allocGameObject();
     if (!obj) return NULL;
-    ShapeDataRectangle* data = (ShapeDataRectangle*)malloc(sizeof(ShapeDataRectangle));
-    if (!data) { free(obj); return NULL; }
+    ShapeDataRectangle* data = (ShapeDataRectangle*)obj->shapeData;
 
     data->width = width; data->height = height; data->color = color;    obj->type = SHAPE_RECTANGLE;
     obj->position = position;
+    obj->previousPosition = position;
     obj->velocity = isStatic ? (Vector2){0,0} : velocity;
     obj->shapeData = data;
     obj->isStatic = isStatic;
@@ -347,19 +446,29 @@ GameObject* createRectangleObject(Vector2 position, Vector2 velocity, float widt
     obj->update = updateGenericMovingObject;
     obj->destroy = destroyGenericShapeData;
     obj->next = NULL;
+    obj->onCollisionEffects = NULL;
+    obj->surfaceVelocity = NULL;
+    obj->tree = NULL;
+    obj->treeProxy = AABB_TREE_NULL;
+    updateGameObjectBounds(obj);
     return obj;
 }
 
 // --- Diamond Object ---
-static void renderDiamondObj(GameObject* self) {
+static void renderDiamondObj(GameObject* self, float alpha) {
+#ifndef HEADLESS
     ShapeDataDiamond* data = (ShapeDataDiamond*)self->shapeData;
-    Vector2 p = self->position;
+    Vector2 p = getRenderPosition(self, alpha);
     float hw = data->halfWidth; float hh = data->halfHeight;
     Vector2 top = {p.x, p.y - hh}; Vector2 right = {p.x + hw, p.y};
     Vector2 bottom = {p.x, p.y + hh}; Vector2 left = {p.x - hw, p.y};
     DrawLineV(top, right, data->color); DrawLineV(right, bottom, data->color);
     DrawLineV(bottom, left, data->color); DrawLineV(left, top, data->color);
     // Or fill with triangles: DrawTriangle(top, left, right, data->color); DrawTriangle(bottom, left, right, data->color);
+#else
+    (void)self;
+    (void)alpha;
+#endif
 }
 
 static bool checkCollisionDiamondObj(GameObject* self, BouncingObject* bouncingObj, float dt_step, float* timeOfImpact, Vector2* collisionNormal) {    ShapeDataDiamond* data = (ShapeDataDiamond*)self->shapeData;
@@ -367,39 +476,19 @@ static bool checkCollisionDiamondObj(GameObject* self, BouncingObject* bouncingO
     Vector2 p = self->position;
     float hw = data->halfWidth; float hh = data->halfHeight;
 
-    Vector2 topV = {p.x, p.y - hh}; Vector2 rightV = {p.x + hw, p.y};
-    Vector2 bottomV = {p.x, p.y + hh}; Vector2 leftV = {p.x - hw, p.y};
-    Vector2 segments[4][2] = { {topV, rightV}, {rightV, bottomV}, {bottomV, leftV}, {leftV, topV} };
-    
-    float min_toi = dt_step + EPSILON2;
-    bool collided_overall = false;
-
-    for (int i = 0; i < 4; ++i) {
-        float current_segment_toi;
-        Vector2 current_segment_normal;        if (sweptBallToStaticSegmentCollision(segments[i][0], segments[i][1],
-                                              bouncingObj->position, relBallVel, bouncingObj->radius,
-                                              dt_step, &current_segment_toi, &current_segment_normal)) {
-            if (current_segment_toi >= -EPSILON2 && current_segment_toi < min_toi) {
-                min_toi = current_segment_toi;
-                *collisionNormal = current_segment_normal;
-                collided_overall = true;
-            }
-        }
-    }
-    if (collided_overall) {
-        *timeOfImpact = min_toi;
-    }
-    return collided_overall;
+    Vector2 vertices[4] = { {p.x, p.y - hh}, {p.x + hw, p.y}, {p.x, p.y + hh}, {p.x - hw, p.y} }; // Top, right, bottom, left
+    return sweptBallToStaticPolygonCollision(vertices, 4, bouncingObj->position, relBallVel, bouncingObj->radius,
+                                             dt_step, timeOfImpact, collisionNormal);
 }
 
 GameObject* createDiamondObject(Vector2 position, Vector2 velocity, float diagWidth, float diagHeight, Color color, bool isStatic) {
-    GameObject* obj = (GameObject*)malloc(sizeof(GameObject));
+    GameObject* obj = allocGameObject();
     if (!obj) return NULL;
-    ShapeDataDiamond* data = (ShapeDataDiamond*)malloc(sizeof(ShapeDataDiamond));
-    if (!data) { free(obj); return NULL; }
+    ShapeDataDiamond* data = (ShapeDataDiamond*)obj->shapeData;
 
     data->halfWidth = diagWidth / 2.0f; data->halfHeight = diagHeight / 2.0f; data->color = color;    obj->type = SHAPE_DIAMOND;
     obj->position = position;
+    obj->previousPosition = position;
     obj->velocity = isStatic ? (Vector2){0,0} : velocity;
     obj->shapeData = data;
     obj->isStatic = isStatic;
@@ -409,22 +498,145 @@ GameObject* createDiamondObject(Vector2 position, Vector2 velocity, float diagWi
     obj->update = updateGenericMovingObject;
     obj->destroy = destroyGenericShapeData;
     obj->next = NULL;
+    obj->onCollisionEffects = NULL;
+    obj->surfaceVelocity = NULL;
+    obj->tree = NULL;
+    obj->treeProxy = AABB_TREE_NULL;
+    updateGameObjectBounds(obj);
     return obj;
 }
 
 // --- Arc Circle Object ---
-static void renderArcCircleObj(GameObject* self) {
+// Call every callback of a list, or queue the calls if the ball defers its events
+static void runArcCallbacks(ArcCircleCallbackNode* callbacks, GameObject* arc, BouncingObject* ball) {
+    for (ArcCircleCallbackNode* node = callbacks; node != NULL; node = node->next) {
+        if (!node->callback) continue;
+        CollisionEvent event = { .type = COLLISION_EVENT_ARC_CALLBACK, .ball = ball->handle, .object = arc, .callback = node->callback };
+        if (ball->deferredEvents) {
+            pushCollisionEvent(ball->deferredEvents, &event);
+        } else {
+            node->callback(arc, ball);
+        }
+    }
+}
+
+#define ARC_MESH_MAX_ERROR 0.25f     // Largest gap (pixels) between the outer edge and its chords
+#define ARC_MESH_MIN_SEGMENTS 4
+#define ARC_MESH_MAX_SEGMENTS 512
+
+#ifndef HEADLESS
+// Tessellate the arc once: enough segments for its chords to stay within ARC_MESH_MAX_ERROR of
+// the outer circle, so large rings stay smooth and small ones cheap. Returns false if out of memory.
+static bool buildArcMesh(ShapeDataArcCircle* data) {
+    float start = fminf(data->startAngle, data->endAngle) * DEG2RAD;
+    float span = fminf(fabsf(data->endAngle - data->startAngle), 360.0f) * DEG2RAD;
+    float outerRadius = fmaxf(data->outerRadius, ARC_MESH_MAX_ERROR);
+
+    // A chord of angle a is at r*(1 - cos(a/2)) from the circle in its middle
+    float maxStep = 2.0f * acosf(fmaxf(1.0f - ARC_MESH_MAX_ERROR / outerRadius, -1.0f));
+    int segments = (int)ceilf(span / maxStep);
+    if (segments < ARC_MESH_MIN_SEGMENTS) segments = ARC_MESH_MIN_SEGMENTS;
+    if (segments > ARC_MESH_MAX_SEGMENTS) segments = ARC_MESH_MAX_SEGMENTS;
+
+    Vector2* dirs = (Vector2*)malloc((size_t)(segments + 1) * sizeof(Vector2));
+    if (!dirs) return false;
+    for (int k = 0; k <= segments; k++) {
+        float angle = start + span * (float)k / (float)segments;
+        dirs[k] = (Vector2){ cosf(angle), sinf(angle) };
+    }
+    data->meshDirs = dirs;
+    data->meshSegments = segments;
+    return true;
+}
+
+// Triangle strip of the ring being drawn, reused from arc to arc
+static Vector2* arcStripPoints = NULL;
+static int arcStripCapacity = 0;
+
+static bool reserveArcStrip(int count) {
+    if (count <= arcStripCapacity) return true;
+    Vector2* newPoints = (Vector2*)realloc(arcStripPoints, (size_t)count * sizeof(Vector2));
+    if (!newPoints) return false;
+    arcStripPoints = newPoints;
+    arcStripCapacity = count;
+    return true;
+}
+#endif
+
+static void renderArcCircleObj(GameObject* self, float alpha) {
+#ifndef HEADLESS
     ShapeDataArcCircle* data = (ShapeDataArcCircle*)self->shapeData;
-    // Draw the arc
-    DrawRing(
-        self->position,
-        data->radius - data->thickness/2,
-        data->radius + data->thickness/2,
-        data->startAngle + data->rotation,
-        data->endAngle + data->rotation,
-        36, // Number of segments (for smoother arcs)
-        data->color
-    );
+    // Interpolate the rotation the short way round (the rotation wraps at 360 degrees)
+    float turn = data->rotation - data->previousRotation;
+    if (turn > 180.0f) turn -= 360.0f;
+    if (turn < -180.0f) turn += 360.0f;
+    float rotation = data->previousRotation + turn * alpha;
+    Vector2 center = getRenderPosition(self, alpha);
+
+    int pointCount = 0;
+    if (data->meshDirs || buildArcMesh(data)) pointCount = 2 * (data->meshSegments + 1);
+    if (pointCount == 0 || !reserveArcStrip(pointCount)) {
+        // Out of memory: tessellate this frame's ring on the fly
+        DrawRing(center, data->innerRadius, data->outerRadius, data->startAngle + rotation,
+                 data->endAngle + rotation, 36, data->color);
+        return;
+    }
+
+    // Cached directions turned by the rotation, outer and inner point alternately
+    // (the winding of DrawRing, so backface culling keeps the triangles)
+    float c = cosf(rotation * DEG2RAD);
+    float s = sinf(rotation * DEG2RAD);
+    for (int k = 0; k <= data->meshSegments; k++) {
+        Vector2 dir = data->meshDirs[k];
+        Vector2 turned = { dir.x * c - dir.y * s, dir.x * s + dir.y * c };
+        arcStripPoints[2 * k] = (Vector2){ center.x + turned.x * data->outerRadius, center.y + turned.y * data->outerRadius };
+        arcStripPoints[2 * k + 1] = (Vector2){ center.x + turned.x * data->innerRadius, center.y + turned.y * data->innerRadius };
+    }
+    DrawTriangleStrip(arcStripPoints, pointCount, data->color);
+#else
+    (void)self;
+    (void)alpha;
+#endif
+}
+
+static ArcCap makeArcCap(Vector2 inner, Vector2 outer) {
+    ArcCap cap;
+    Vector2 segmentVec = Vector2Subtract(outer, inner);
+    float segmentLenSq = Vector2LengthSqr(segmentVec);
+    cap.degenerate = segmentLenSq < EPSILON2;
+    cap.direction = Vector2Normalize(segmentVec);
+    cap.normal = (Vector2){ -cap.direction.y, cap.direction.x };
+    cap.length = sqrtf(segmentLenSq);
+    return cap;
+}
+
+// Refresh the cached geometry of an arc (end directions, radii, corners and caps),
+// after its angles, its rotation or its position changed
+static void updateArcGeometry(GameObject* self) {
+    ShapeDataArcCircle* data = (ShapeDataArcCircle*)self->shapeData;
+    Vector2 center = self->position;
+
+    float startRad = (data->startAngle + data->rotation) * DEG2RAD;
+    float endRad = (data->endAngle + data->rotation) * DEG2RAD;
+    data->startDir = (Vector2){ cosf(startRad), sinf(startRad) };
+    data->endDir = (Vector2){ cosf(endRad), sinf(endRad) };
+
+    float span = data->endAngle - data->startAngle;
+    data->fullCircle = span >= 360.0f;
+    span = fmodf(span, 360.0f);
+    if (span < 0) span += 360.0f;
+    data->wideArc = span > 180.0f;
+
+    data->innerRadius = data->radius - data->thickness/2.0f;
+    data->outerRadius = data->radius + data->thickness/2.0f;
+    data->outerRadiusSq = data->outerRadius * data->outerRadius;
+
+    data->startOuter = (Vector2){ center.x + data->outerRadius * data->startDir.x, center.y + data->outerRadius * data->startDir.y };
+    data->endOuter = (Vector2){ center.x + data->outerRadius * data->endDir.x, center.y + data->outerRadius * data->endDir.y };
+    data->startInner = (Vector2){ center.x + data->innerRadius * data->startDir.x, center.y + data->innerRadius * data->startDir.y };
+    data->endInner = (Vector2){ center.x + data->innerRadius * data->endDir.x, center.y + data->innerRadius * data->endDir.y };
+    data->startCap = makeArcCap(data->startInner, data->startOuter);
+    data->endCap = makeArcCap(data->endInner, data->endOuter);
 }
 
 static void updateArcCircleObj(GameObject* self, float dt) {
@@ -432,6 +644,7 @@ static void updateArcCircleObj(GameObject* self, float dt) {
     
     // Update rotation regardless of whether the object is static
     ShapeDataArcCircle* data = (ShapeDataArcCircle*)self->shapeData;
+    data->previousRotation = data->rotation;
     data->rotation += data->rotationSpeed * dt;
     
     // Only update position if the object is not static
@@ -439,54 +652,159 @@ static void updateArcCircleObj(GameObject* self, float dt) {
         // Update position based on velocity
         self->position = Vector2Add(self->position, Vector2Scale(self->velocity, dt));
     }
-    // Normalize rotation to avoid large values over time
-    while (data->rotation > 360.0f) {
-        data->rotation -= 360.0f;
-    }
-    while (data->rotation < 0.0f) {
-        data->rotation += 360.0f;
-    }
+    // Normalize rotation to [0, 360] to avoid large values over time. fmodf rather than a loop
+    // subtracting 360, which never ends once the rotation is so large that subtracting 360
+    // doesn't change it (same result for ordinary values: an exact 360 is kept as before)
+    if (data->rotation > 360.0f) data->rotation = fmodf(data->rotation, 360.0f);
+    if (data->rotation < 0.0f) data->rotation = fmodf(data->rotation, 360.0f) + 360.0f;
     
     // Basic screen wrap for objects (optional)
     if (self->position.x < -50) self->position.x = SCREEN_WIDTH + 40;
     if (self->position.x > SCREEN_WIDTH + 50) self->position.x = -40;
     if (self->position.y < -50) self->position.y = SCREEN_HEIGHT + 40;
     if (self->position.y > SCREEN_HEIGHT + 50) self->position.y = -40;
+
+    updateArcGeometry(self);
+    updateGameObjectBounds(self);
 }
 
-static bool isBallInsideCircle(Vector2 ballPos, Vector2 circlePos, float circleRadius, float thickness)
+// Whether the ball center is within the arc's outer circle
+static bool isBallInsideCircle(Vector2 ballPos, Vector2 circlePos, const ShapeDataArcCircle* data)
 {
-    // Calculate the distance between the ball center and the circle center
-    float distance = Vector2Distance(ballPos, circlePos);
-    
-    // Check if the ball is within the circle zone (considering the radius and thickness)
-    float outerRadius = circleRadius + thickness/2;
-    
-    return distance <= outerRadius;
+    return Vector2DistanceSqr(ballPos, circlePos) <= data->outerRadiusSq;
 }
 
 // Check if a point is within the angular range of an arc
-static bool isPointWithinArcAngles(Vector2 point, Vector2 center, float startAngle, float endAngle, float currentRotation)
+// Whether the direction from the center to the point lies between the arc's start and end angles
+// (going from start to end by increasing angle), using the cached end directions:
+// the sign of cross(a, b) tells whether b is less than 180 degrees after a
+static bool isPointWithinArcAngles(Vector2 point, Vector2 center, const ShapeDataArcCircle* data)
 {
-    // Calculate the angle of the point relative to the center (in degrees)
-    float dx = point.x - center.x;
-    float dy = point.y - center.y;
-    float pointAngle = atan2f(dy, dx) * RAD2DEG;
-    
-    // Normalize to [0, 360] range
-    if (pointAngle < 0) pointAngle += 360.0f;
-    
-    // Apply the rotation offset and normalize
-    float effectiveStart = fmodf(startAngle + currentRotation, 360.0f);
-    float effectiveEnd = fmodf(endAngle + currentRotation, 360.0f);
-    
-    // Handle cases where the arc crosses the 0-degree line
-    if (effectiveStart <= effectiveEnd) {
-        return (pointAngle >= effectiveStart && pointAngle <= effectiveEnd);
-    } else {
-        // Arc wraps around from 360 back to 0
-        return (pointAngle >= effectiveStart || pointAngle <= effectiveEnd);
+    if (data->fullCircle) return true;
+
+    Vector2 d = Vector2Subtract(point, center);
+    float afterStart = data->startDir.x * d.y - data->startDir.y * d.x;  // cross(startDir, d)
+    float beforeEnd = d.x * data->endDir.y - d.y * data->endDir.x;       // cross(d, endDir)
+
+    if (data->wideArc) {
+        // Outside only in the gap, which is less than 180 degrees wide: after the end and before the start
+        return afterStart >= 0.0f || beforeEnd >= 0.0f;
     }
+    return afterStart >= 0.0f && beforeEnd >= 0.0f;
+}
+
+// --- Swept rotation (ShapeDataArcCircle.sweptRotation) ---
+//
+// Otherwise the arc is tested frozen at `rotation`, its pose at the end of the step. In swept
+// mode it turns from previousRotation at rotationSpeed during the step: a point seen at some
+// time of the step is turned back by the angle the arc still lags behind `rotation` at that
+// time, then tested against the cached geometry (which is at `rotation`).
+
+#define ARC_CCD_TOLERANCE 0.05f     // Gap (pixels) under which a ball touches a cap
+#define ARC_CCD_MAX_ITERATIONS 4096 // Safety cap of a cap test (a few hundred steps at most in practice)
+
+// Angle (degrees) between the arc's pose `elapsed` seconds into the step and its current rotation
+static float arcPoseLag(const ShapeDataArcCircle* data, float elapsed) {
+    return data->previousRotation + data->rotationSpeed * elapsed - data->rotation;
+}
+
+// isPointWithinArcAngles with the arc lagging lagDeg degrees behind its current rotation
+static bool isPointWithinArcAnglesAt(Vector2 point, Vector2 center, const ShapeDataArcCircle* data, float lagDeg)
+{
+    if (lagDeg != 0.0f) {
+        point = Vector2Add(center, Vector2Rotate(Vector2Subtract(point, center), -lagDeg * DEG2RAD));
+    }
+    return isPointWithinArcAngles(point, center, data);
+}
+
+// Closest point to p on a cap starting at `inner`
+static Vector2 closestPointOnCap(Vector2 p, Vector2 inner, const ArcCap* cap) {
+    float along = Clamp(Vector2DotProduct(Vector2Subtract(p, inner), cap->direction), 0.0f, cap->length);
+    return Vector2Add(inner, Vector2Scale(cap->direction, along));
+}
+
+// Ball against both caps of a turning arc, by conservative advancement in the arc's frame:
+// the ball is moved by steps that can't jump over a cap (the gap divided by a bound of the
+// speed at which it can close) until it touches one while moving into it, or the step ends.
+// A slow approach or a long graze takes many steps; a test still running after
+// ARC_CCD_MAX_ITERATIONS reports a hit where it stands rather than letting the ball through.
+static bool sweptBallToTurningCaps(const ShapeDataArcCircle* data, Vector2 center, Vector2 ballPos, Vector2 ballVel,
+                                   float ballRadius, float startLag, float dt_max, float* toi, Vector2* normal) {
+    float omega = data->rotationSpeed * DEG2RAD;
+    Vector2 relPos = Vector2Subtract(ballPos, center);
+    float speed = Vector2Length(ballVel);
+    // Speed of the ball in the arc's frame: its own plus the arc's turning speed at its distance
+    float speedBound = speed + fabsf(omega) * (Vector2Length(relPos) + speed * dt_max);
+
+    float t = 0.0f;
+    for (int i = 0; t <= dt_max; i++) {
+        float lag = (startLag + data->rotationSpeed * t) * DEG2RAD;
+        Vector2 local = Vector2Add(center, Vector2Rotate(Vector2Add(relPos, Vector2Scale(ballVel, t)), -lag));
+        Vector2 closestStart = closestPointOnCap(local, data->startInner, &data->startCap);
+        Vector2 closestEnd = closestPointOnCap(local, data->endInner, &data->endCap);
+        float distStart = Vector2Distance(local, closestStart);
+        float distEnd = Vector2Distance(local, closestEnd);
+        Vector2 closest = (distStart <= distEnd) ? closestStart : closestEnd;
+        float gap = fminf(distStart, distEnd) - ballRadius;
+
+        bool outOfIterations = i == ARC_CCD_MAX_ITERATIONS - 1;
+        if (gap <= ARC_CCD_TOLERANCE || outOfIterations) {
+            // Back to the world's orientation: normal from the cap to the ball, velocity of the contact point
+            Vector2 n = Vector2Rotate(Vector2Normalize(Vector2Subtract(local, closest)), lag);
+            if (Vector2LengthSqr(n) < EPSILON2) { // Ball center on the cap
+                n = Vector2Normalize(Vector2Negate(ballVel));
+            }
+            Vector2 contactOffset = Vector2Rotate(Vector2Subtract(closest, center), lag);
+            Vector2 capVelocity = { -contactOffset.y * omega, contactOffset.x * omega };
+            if (outOfIterations || Vector2DotProduct(Vector2Subtract(ballVel, capVelocity), n) < 0.0f) {
+                *toi = t;
+                *normal = n;
+                return true;
+            }
+            gap = ARC_CCD_TOLERANCE; // Separating: move on
+        }
+        if (speedBound < EPSILON2) return false;
+        t += gap / speedBound;
+    }
+    return false;
+}
+
+// Swept mode escape: whether the ball crosses the outer circle outwards within dt_max, before
+// hitToi, at an angle which is in the gap at the arc's pose of that time (*crossTime)
+static bool ballEscapesTurningArc(const ShapeDataArcCircle* data, Vector2 center, Vector2 ballPos, Vector2 ballVel,
+                                  float startLag, float dt_max, float hitToi, float* crossTime) {
+    Vector2 relPos = Vector2Subtract(ballPos, center);
+    float a = Vector2DotProduct(ballVel, ballVel);
+    float b = 2.0f * Vector2DotProduct(relPos, ballVel);
+    float c = Vector2DotProduct(relPos, relPos) - data->outerRadiusSq;
+    if (c > 0.0f || a < EPSILON2) return false; // Already outside, or not moving
+
+    float t_cross = (-b + sqrtf(b * b - 4.0f * a * c)) / (2.0f * a);
+    if (t_cross > dt_max || t_cross > hitToi) return false;
+
+    Vector2 crossing = Vector2Add(ballPos, Vector2Scale(ballVel, t_cross));
+    *crossTime = t_cross;
+    return !isPointWithinArcAnglesAt(crossing, center, data, startLag + data->rotationSpeed * t_cross);
+}
+
+// A ball escaped through the gap of an arc: run the arc's escape callbacks, and mark the ball
+// for deletion if the arc removes escaped balls
+static void escapeThroughArc(GameObject* arc, BouncingObject* ball) {
+    ShapeDataArcCircle* data = (ShapeDataArcCircle*)arc->shapeData;
+    runArcCallbacks(data->onEscapeCallbacks, arc, ball);
+    if (data->removeEscapedBalls) {
+        ball->markedForDeletion = true;
+    }
+}
+
+// Run the escapes the last collision query of the ball recorded (swept arcs) whose crossing
+// comes no later than hitTime, the ball's earliest hit on any object: the ball bounces there,
+// so it never reaches the later crossings. Clears the list for the next query.
+void runPendingArcEscapes(BouncingObject* ball, float hitTime) {
+    for (int k = 0; k < ball->pendingEscapeCount; k++) {
+        if (ball->pendingEscapeTimes[k] <= hitTime) escapeThroughArc(ball->pendingEscapeArcs[k], ball);
+    }
+    ball->pendingEscapeCount = 0;
 }
 
 static bool checkCollisionArcCircleObj(GameObject* self, BouncingObject* bouncingObj, float dt_step, float* timeOfImpact, Vector2* collisionNormal)
@@ -507,9 +825,12 @@ static bool checkCollisionArcCircleObj(GameObject* self, BouncingObject* bouncin
     bool collided = false;
     Vector2 final_normal = {0,0};
     
-    // Calculate inner and outer radii of the arc circle
-    float innerRadius = data->radius - data->thickness/2.0f;
-    float outerRadius = data->radius + data->thickness/2.0f;
+    // Inner and outer radii of the arc circle
+    float innerRadius = data->innerRadius;
+    float outerRadius = data->outerRadius;
+    
+    // Swept mode: how far the arc lags behind its current rotation at the start of this test
+    float startLag = data->sweptRotation ? arcPoseLag(data, bouncingObj->frameElapsed) : 0.0f;
     
     // 1. Check for collision with the outer circle boundary
     {
@@ -568,7 +889,8 @@ static bool checkCollisionArcCircleObj(GameObject* self, BouncingObject* bouncin
                     Vector2 normal = Vector2Subtract(ballPosAtToi, arcCenter);
                     
                     // Check if the collision point is within the angular range of the arc
-                    if (isPointWithinArcAngles(ballPosAtToi, arcCenter, data->startAngle, data->endAngle, data->rotation)) {
+                    float hitLag = data->sweptRotation ? startLag + data->rotationSpeed * t_collision : 0.0f;
+                    if (isPointWithinArcAnglesAt(ballPosAtToi, arcCenter, data, hitLag)) {
                         min_toi = t_collision;
                         final_normal = Vector2Normalize(normal);
                         collided = true;
@@ -613,7 +935,8 @@ static bool checkCollisionArcCircleObj(GameObject* self, BouncingObject* bouncin
                         Vector2 normal = Vector2Subtract(arcCenter, ballPosAtToi);
                         
                         // Check if the collision point is within the angular range of the arc
-                        if (isPointWithinArcAngles(ballPosAtToi, arcCenter, data->startAngle, data->endAngle, data->rotation)) {
+                        float hitLag = data->sweptRotation ? startLag + data->rotationSpeed * t_collision : 0.0f;
+                        if (isPointWithinArcAnglesAt(ballPosAtToi, arcCenter, data, hitLag)) {
                             min_toi = t_collision;
                             final_normal = Vector2Normalize(normal);
                             collided = true;
@@ -625,36 +948,24 @@ static bool checkCollisionArcCircleObj(GameObject* self, BouncingObject* bouncin
     }
     
     // 3. Check for collision with the end points of the arc (if they exist)
-    if (data->endAngle - data->startAngle < 360.0f) {
-        // Calculate the end points of the arc
-        float startRad = (data->startAngle + data->rotation) * DEG2RAD;
-        float endRad = (data->endAngle + data->rotation) * DEG2RAD;
-        
-        Vector2 startOuter = {
-            arcCenter.x + outerRadius * cosf(startRad),
-            arcCenter.y + outerRadius * sinf(startRad)
-        };
-        
-        Vector2 endOuter = {
-            arcCenter.x + outerRadius * cosf(endRad),
-            arcCenter.y + outerRadius * sinf(endRad)
-        };
-        
-        // If thickness > 0, we also need to check inner endpoints
-        Vector2 startInner = {
-            arcCenter.x + innerRadius * cosf(startRad),
-            arcCenter.y + innerRadius * sinf(startRad)
-        };
-        
-        Vector2 endInner = {
-            arcCenter.x + innerRadius * cosf(endRad),
-            arcCenter.y + innerRadius * sinf(endRad)
-        };
-        
+    if (data->endAngle - data->startAngle < 360.0f && data->sweptRotation) {
+        // The ends turn during the step: both caps, corners included, in the arc's frame
+        float current_toi;
+        Vector2 current_normal;
+        if (sweptBallToTurningCaps(data, arcCenter, bouncingObj->position, relBallVel, bouncingObj->radius,
+                                   startLag, dt_step, &current_toi, &current_normal)) {
+            if (current_toi < min_toi) {
+                min_toi = current_toi;
+                final_normal = current_normal;
+                collided = true;
+            }
+        }
+    } else if (data->endAngle - data->startAngle < 360.0f) {
+        // The end points of the arc are cached by updateArcGeometry
         // Check collision with start outer endpoint
         float current_toi;
         Vector2 current_normal;
-        if (sweptBallToStaticPointCollision(startOuter, bouncingObj->position, relBallVel,
+        if (sweptBallToStaticPointCollision(data->startOuter, bouncingObj->position, relBallVel,
                                            bouncingObj->radius, dt_step, &current_toi, &current_normal)) {
             if (current_toi < min_toi) {
                 min_toi = current_toi;
@@ -664,7 +975,7 @@ static bool checkCollisionArcCircleObj(GameObject* self, BouncingObject* bouncin
         }
         
         // Check collision with end outer endpoint
-        if (sweptBallToStaticPointCollision(endOuter, bouncingObj->position, relBallVel,
+        if (sweptBallToStaticPointCollision(data->endOuter, bouncingObj->position, relBallVel,
                                            bouncingObj->radius, dt_step, &current_toi, &current_normal)) {
             if (current_toi < min_toi) {
                 min_toi = current_toi;
@@ -675,7 +986,7 @@ static bool checkCollisionArcCircleObj(GameObject* self, BouncingObject* bouncin
         
         // Check collision with start inner endpoint (if there's thickness)
         if (innerRadius > EPSILON2) {
-            if (sweptBallToStaticPointCollision(startInner, bouncingObj->position, relBallVel,
+            if (sweptBallToStaticPointCollision(data->startInner, bouncingObj->position, relBallVel,
                                                bouncingObj->radius, dt_step, &current_toi, &current_normal)) {
                 if (current_toi < min_toi) {
                     min_toi = current_toi;
@@ -685,7 +996,7 @@ static bool checkCollisionArcCircleObj(GameObject* self, BouncingObject* bouncin
             }
             
             // Check collision with end inner endpoint
-            if (sweptBallToStaticPointCollision(endInner, bouncingObj->position, relBallVel,
+            if (sweptBallToStaticPointCollision(data->endInner, bouncingObj->position, relBallVel,
                                                bouncingObj->radius, dt_step, &current_toi, &current_normal)) {
                 if (current_toi < min_toi) {
                     min_toi = current_toi;
@@ -695,27 +1006,18 @@ static bool checkCollisionArcCircleObj(GameObject* self, BouncingObject* bouncin
             }
             
             // If the arc isn't a full circle, check collisions with the straight segments
-            // connecting the inner and outer endpoints
-            Vector2 startSegment[2] = { startInner, startOuter };
-            Vector2 endSegment[2] = { endInner, endOuter };
-            
-            // Check collision with start segment
-            if (sweptBallToStaticSegmentCollision(startSegment[0], startSegment[1],
-                                                 bouncingObj->position, relBallVel, bouncingObj->radius,
-                                                 dt_step, &current_toi, &current_normal)) {
-                if (current_toi < min_toi) {
-                    min_toi = current_toi;
-                    final_normal = current_normal;
-                    collided = true;
-                }
-            }
-            
-            // Check collision with end segment
-            if (sweptBallToStaticSegmentCollision(endSegment[0], endSegment[1],
-                                                 bouncingObj->position, relBallVel, bouncingObj->radius,
-                                                 dt_step, &current_toi, &current_normal)) {
-                if (current_toi < min_toi) {
-                    min_toi = current_toi;
+            // connecting the inner and outer endpoints. Their endpoints were tested just above,
+            // so only the inside of each segment is left (same result as
+            // sweptBallToStaticSegmentCollision, which would test the endpoints again)
+            const ArcCap* caps[2] = { &data->startCap, &data->endCap };
+            const Vector2 capStarts[2] = { data->startInner, data->endInner };
+            for (int i = 0; i < 2; i++) {
+                if (caps[i]->degenerate) continue;
+                if (sweptBallToSegmentLine(capStarts[i], caps[i]->direction, caps[i]->normal, caps[i]->length,
+                                           bouncingObj->position, relBallVel, bouncingObj->radius,
+                                           dt_step, min_toi, &current_toi, &current_normal)
+                    && fmaxf(0.0f, current_toi) < min_toi) {
+                    min_toi = fmaxf(0.0f, current_toi);
                     final_normal = current_normal;
                     collided = true;
                 }
@@ -723,60 +1025,53 @@ static bool checkCollisionArcCircleObj(GameObject* self, BouncingObject* bouncin
         }
     }    // Check if the ball is escaping through the gap of the arc (NOT through the arc itself)
     if (data->onEscapeCallbacks != NULL) {
-        // Determine if ball is inside the circle now or will be after moving
-        Vector2 ballPosAfterStep = Vector2Add(bouncingObj->position, Vector2Scale(bouncingObj->velocity, dt_step));
-        bool ballIsInsideNow = isBallInsideCircle(bouncingObj->position, arcCenter, data->radius, data->thickness);
-        bool ballWillBeInsideAfter = isBallInsideCircle(ballPosAfterStep, arcCenter, data->radius, data->thickness);
-        
-        // We only care about balls that are either:
-        // 1. Going from inside to outside (escaping)
-        // 2. Already outside with velocity pointing away from circle
-        if (!ballIsInsideNow && !ballWillBeInsideAfter) {
-            // Ball is already outside and staying outside, no escape event
-            return collided;
-        }
-        
-        // If the ball is leaving the circle's interior
-        if (ballIsInsideNow && !ballWillBeInsideAfter) {
-            // Calculate angle of ball position to check if it's leaving through the gap
-            Vector2 ballRelPos = Vector2Subtract(bouncingObj->position, arcCenter);
-            float ballAngle = atan2f(ballRelPos.y, ballRelPos.x) * RAD2DEG;
-            if (ballAngle < 0) ballAngle += 360.0f;
-            
-            // Calculate exit trajectory and intersection with circle boundary
-            Vector2 trajectory = Vector2Normalize(bouncingObj->velocity);
-            float outerRadius = data->radius + data->thickness/2;
-            
-            // Project the position to the boundary to determine the escape point
-            Vector2 escapePoint = Vector2Add(arcCenter, Vector2Scale(Vector2Normalize(ballRelPos), outerRadius));
-            
-            // IMPORTANT: Check if the escape point is NOT within the arc angles
-            // This means the ball is escaping through the GAP, not through the arc itself
-            if (!isPointWithinArcAngles(escapePoint, arcCenter, data->startAngle, data->endAngle, data->rotation)) {
-                // Ball is escaping through the GAP (not the arc), call all escape callbacks
-                for (ArcCircleCallbackNode* node = data->onEscapeCallbacks; node != NULL; node = node->next) {
-                    if (node->callback) {
-                        node->callback(self, bouncingObj);
-                    }
+        bool escaping = false;
+        if (data->sweptRotation) {
+            // Where the ball actually crosses the circle, at the arc's pose of that time. Another
+            // object may stop the ball before that, which only the end of the query knows: the
+            // escape is recorded for runPendingArcEscapes (run now only if the list is full)
+            float crossTime;
+            if (ballEscapesTurningArc(data, arcCenter, bouncingObj->position, relBallVel,
+                                      startLag, dt_step, collided ? min_toi : FLT_MAX, &crossTime)) {
+                int k = bouncingObj->pendingEscapeCount;
+                if (k < BALL_MAX_PENDING_ESCAPES) {
+                    bouncingObj->pendingEscapeArcs[k] = self;
+                    bouncingObj->pendingEscapeTimes[k] = crossTime;
+                    bouncingObj->pendingEscapeCount++;
+                } else {
+                    escaping = true;
                 }
+            }
+        } else {
+            // Determine if ball is inside the circle now or will be after moving
+            Vector2 ballPosAfterStep = Vector2Add(bouncingObj->position, Vector2Scale(bouncingObj->velocity, dt_step));
+            bool ballIsInsideNow = isBallInsideCircle(bouncingObj->position, arcCenter, data);
+            bool ballWillBeInsideAfter = isBallInsideCircle(ballPosAfterStep, arcCenter, data);
+            
+            // If the ball is leaving the circle's interior (a ball staying outside never escapes;
+            // don't return early here, the collision outputs below must still be written)
+            if (ballIsInsideNow && !ballWillBeInsideAfter) {
+                // Direction of the ball from the center, to check if it's leaving through the gap
+                Vector2 ballRelPos = Vector2Subtract(bouncingObj->position, arcCenter);
                 
-                // If the arc is configured to remove escaped balls, mark the ball for deletion
-                if (data->removeEscapedBalls) {
-                    bouncingObj->markedForDeletion = true;
-                }
+                // Project the position to the boundary to determine the escape point
+                Vector2 escapePoint = Vector2Add(arcCenter, Vector2Scale(Vector2Normalize(ballRelPos), outerRadius));
+                
+                // IMPORTANT: Check if the escape point is NOT within the arc angles
+                // This means the ball is escaping through the GAP, not through the arc itself
+                escaping = !isPointWithinArcAngles(escapePoint, arcCenter, data);
             }
         }
+        
+        if (escaping) {
+            // Ball is escaping through the GAP (not the arc), call all escape callbacks
+            escapeThroughArc(self, bouncingObj);
+        }
     }
     
     if (collided) {
         // If colliding, call all collision callbacks
-        if (data->onCollisionCallbacks != NULL) {
-            for (ArcCircleCallbackNode* node = data->onCollisionCallbacks; node != NULL; node = node->next) {
-                if (node->callback) {
-                    node->callback(self, bouncingObj);
-                }
-            }
-        }
+        runArcCallbacks(data->onCollisionCallbacks, self, bouncingObj);
         
         *timeOfImpact = min_toi;
         *collisionNormal = final_normal;
@@ -786,26 +1081,27 @@ static bool checkCollisionArcCircleObj(GameObject* self, BouncingObject* bouncin
 }
 
 GameObject* createArcCircleObject(Vector2 position, Vector2 velocity, float radius, float startAngle, float endAngle, float thickness, Color color, bool isStatic, float rotationSpeed, bool removeEscapedBalls) {
-    GameObject* obj = (GameObject*)malloc(sizeof(GameObject));
+    GameObject* obj = allocGameObject();
     if (!obj) return NULL;
     
-    ShapeDataArcCircle* data = (ShapeDataArcCircle*)malloc(sizeof(ShapeDataArcCircle));
-    if (!data) { 
-        free(obj); 
-        return NULL; 
-    }
+    ShapeDataArcCircle* data = (ShapeDataArcCircle*)obj->shapeData;
     
     data->radius = radius;
     data->startAngle = startAngle;
     data->endAngle = endAngle;
     data->thickness = thickness;
     data->color = color;    data->rotation = 0.0f;
+    data->previousRotation = 0.0f;
     data->rotationSpeed = rotationSpeed;
     data->removeEscapedBalls = removeEscapedBalls;
+    data->sweptRotation = false;
     data->onCollisionCallbacks = NULL;  // Initialize callback lists to empty
     data->onEscapeCallbacks = NULL;
+    data->meshDirs = NULL;              // Tessellated on the first draw
+    data->meshSegments = 0;
       obj->type = SHAPE_CIRCLE_ARC;
     obj->position = position;
+    obj->previousPosition = position;
     obj->velocity = isStatic ? (Vector2){0,0} : velocity;
     obj->shapeData = data;
     obj->isStatic = isStatic;
@@ -816,6 +1112,11 @@ GameObject* createArcCircleObject(Vector2 position, Vector2 velocity, float radi
     obj->destroy = destroyGenericShapeData;
     obj->next = NULL;
     obj->onCollisionEffects = NULL;
+    obj->surfaceVelocity = NULL;
+    obj->tree = NULL;
+    obj->treeProxy = AABB_TREE_NULL;
+    updateArcGeometry(obj);
+    updateGameObjectBounds(obj);
     
     return obj;
 }
@@ -866,104 +1167,80 @@ void addEscapeCallbackToArcCircle(GameObject* arcCircle, ArcCircleCallback callb
     data->onEscapeCallbacks = newNode;
 }
 
-// --- BouncingObject Management Functions ---
+// Velocity of a point of an arc's surface: the arc's own plus its rotation's at that point
+static Vector2 arcSurfaceVelocity(GameObject* self, Vector2 point) {
+    ShapeDataArcCircle* data = (ShapeDataArcCircle*)self->shapeData;
+    float omega = data->rotationSpeed * DEG2RAD;
+    Vector2 offset = Vector2Subtract(point, self->position);
+    return Vector2Add(self->velocity, (Vector2){ -offset.y * omega, offset.x * omega });
+}
 
-// Create a new bouncing object
-BouncingObject* createBouncingObject(Vector2 position, Vector2 velocity, float radius, Color color, float mass, float restitution, bool interactWithOtherBouncingObjects) {
-    BouncingObject* obj = (BouncingObject*)malloc(sizeof(BouncingObject));
-    if (!obj) return NULL;
+// Collide with an ArcCircle as it turns during each step instead of frozen at its current
+// rotation: its ends can't go through balls at large time steps, bounces take the speed of
+// its surface into account, and escapes are judged at the rotation it has when the ball
+// crosses its circle. Off by default.
+void setArcCircleSweptRotation(GameObject* arcCircle, bool enabled) {
+    if (!arcCircle || arcCircle->type != SHAPE_CIRCLE_ARC) return;
     
-    obj->position = position;
-    obj->velocity = velocity;
-    obj->radius = radius;
-    obj->color = color;
-    obj->mass = (mass > 0.0f) ? mass : 1.0f; // Ensure positive mass
-    obj->restitution = Clamp(restitution, 0.0f, 1.0f); // Ensure valid restitution
-    obj->interactWithOtherBouncingObjects = interactWithOtherBouncingObjects;
-    obj->markedForDeletion = false; // Initially not marked for deletion
-    obj->onCollisionEffects = NULL;
-    obj->next = NULL;
+    ShapeDataArcCircle* data = (ShapeDataArcCircle*)arcCircle->shapeData;
+    if (!data) return;
     
-    return obj;
+    data->sweptRotation = enabled;
+    arcCircle->surfaceVelocity = enabled ? arcSurfaceVelocity : NULL;
 }
 
-// Add a bouncing object to a linked list
-void addBouncingObjectToList(BouncingObject** head, BouncingObject* newObject) {
-    if (!newObject) return;
-    newObject->next = *head;
-    *head = newObject;
-}
+// --- Restoring objects ---
 
-// Free a linked list of bouncing objects
-void freeBouncingObjectList(BouncingObject** head) {
-    BouncingObject* current = *head;
-    BouncingObject* next;
-    
-    while (current != NULL) {
-        next = current->next;
-        // Free any effects attached to this object
-        freeEffectList(&current->onCollisionEffects);
-        free(current);
-        current = next;
+// Set the function pointers of an object from its type, and rebuild what is derived from its
+// fields (arc geometry, bounds), for objects whose fields were copied in directly (snapshots).
+// The object must not be in a tree yet.
+void bindGameObject(GameObject* obj) {
+    obj->update = updateGenericMovingObject;
+    obj->destroy = destroyGenericShapeData;
+    obj->surfaceVelocity = NULL;
+    switch (obj->type) {
+        case SHAPE_RECTANGLE:
+            obj->render = renderRectangleObj;
+            obj->checkCollision = checkCollisionRectangleObj;
+            break;
+        case SHAPE_DIAMOND:
+            obj->render = renderDiamondObj;
+            obj->checkCollision = checkCollisionDiamondObj;
+            break;
+        case SHAPE_CIRCLE_ARC: {
+            ShapeDataArcCircle* data = (ShapeDataArcCircle*)obj->shapeData;
+            obj->render = renderArcCircleObj;
+            obj->checkCollision = checkCollisionArcCircleObj;
+            obj->update = updateArcCircleObj;
+            if (data->sweptRotation) obj->surfaceVelocity = arcSurfaceVelocity;
+            data->meshDirs = NULL;
+            data->meshSegments = 0;
+            updateArcGeometry(obj);
+        } break;
     }
-    
-    *head = NULL;
+    obj->tree = NULL;
+    obj->treeProxy = AABB_TREE_NULL;
+    updateGameObjectBounds(obj);
 }
 
-// Remove all bouncing objects marked for deletion
-void removeMarkedBouncingObjects(BouncingObject** head) {
-    BouncingObject* current = *head;
-    BouncingObject* prev = NULL;
-    BouncingObject* next = NULL;
-    
-    while (current != NULL) {
-        next = current->next;
-        
-        if (current->markedForDeletion) {
-            // If it's the head of the list
-            if (prev == NULL) {
-                *head = next;
-            } else {
-                prev->next = next;
-            }
-            
-            // Free resources associated with this object
-            freeEffectList(&current->onCollisionEffects);
-            free(current);
-        } else {
-            prev = current;
-        }
-        
-        current = next;
-    }
-}
+// --- Collision Effect Functions ---
 
-// Update all bouncing objects in a list
-void updateBouncingObjectList(BouncingObject* head, float dt) {
-    for (BouncingObject* current = head; current != NULL; current = current->next) {
-        // Update position based on velocity
-        current->position = Vector2Add(current->position, Vector2Scale(current->velocity, dt));
-        
-        // Basic screen wrap for bouncing objects (optional)
-        if (current->position.x < -50) current->position.x = SCREEN_WIDTH + 40;
-        if (current->position.x > SCREEN_WIDTH + 50) current->position.x = -40;
-        if (current->position.y < -50) current->position.y = SCREEN_HEIGHT + 40;
-        if (current->position.y > SCREEN_HEIGHT + 50) current->position.y = -40;
-    }
-}
+// All effects come from this pool, so spawning and deleting balls with effects
+// doesn't go through malloc/free once the pool has grown to the working set
+static ObjectPool effectPool = OBJECT_POOL_INIT(sizeof(CollisionEffect), 256);
 
-// Render all bouncing objects in a list
-void renderBouncingObjectList(BouncingObject* head) {
-    for (BouncingObject* current = head; current != NULL; current = current->next) {
-        DrawCircleV(current->position, current->radius, current->color);
-    }
+const ObjectPool* getCollisionEffectPool(void) {
+    return &effectPool;
 }
 
-// --- Collision Effect Functions ---
+// Release the memory of the effect pool. Every effect must have been freed before.
+void freeCollisionEffectPool(void) {
+    freeObjectPool(&effectPool);
+}
 
 // Create a color change effect
 CollisionEffect* createColorChangeEffect(Color newColor, bool continuous) {
-    CollisionEffect* effect = (CollisionEffect*)malloc(sizeof(CollisionEffect));
+    CollisionEffect* effect = (CollisionEffect*)poolAlloc(&effectPool);
     if (!effect) return NULL;
     
     effect->type = EFFECT_COLOR_CHANGE;
@@ -976,7 +1253,7 @@ CollisionEffect* createColorChangeEffect(Color newColor, bool continuous) {
 
 // Create a velocity boost effect
 CollisionEffect* createVelocityBoostEffect(float factor, bool continuous) {
-    CollisionEffect* effect = (CollisionEffect*)malloc(sizeof(CollisionEffect));
+    CollisionEffect* effect = (CollisionEffect*)poolAlloc(&effectPool);
     if (!effect) return NULL;
     
     effect->type = EFFECT_VELOCITY_BOOST;
@@ -989,7 +1266,7 @@ CollisionEffect* createVelocityBoostEffect(float factor, bool continuous) {
 
 // Create a velocity dampen effect
 CollisionEffect* createVelocityDampenEffect(float factor, bool continuous) {
-    CollisionEffect* effect = (CollisionEffect*)malloc(sizeof(CollisionEffect));
+    CollisionEffect* effect = (CollisionEffect*)poolAlloc(&effectPool);
     if (!effect) return NULL;
     
     effect->type = EFFECT_VELOCITY_DAMPEN;
@@ -1002,7 +1279,7 @@ CollisionEffect* createVelocityDampenEffect(float factor, bool continuous) {
 
 // Create a size change effect
 CollisionEffect* createSizeChangeEffect(float factor, bool continuous) {
-    CollisionEffect* effect = (CollisionEffect*)malloc(sizeof(CollisionEffect));
+    CollisionEffect* effect = (CollisionEffect*)poolAlloc(&effectPool);
     if (!effect) return NULL;
     
     effect->type = EFFECT_SIZE_CHANGE;
@@ -1015,7 +1292,7 @@ CollisionEffect* createSizeChangeEffect(float factor, bool continuous) {
 
 // Create a sound play effect
 CollisionEffect* createSoundPlayEffect(Sound sound, bool continuous) {
-    CollisionEffect* effect = (CollisionEffect*)malloc(sizeof(CollisionEffect));
+    CollisionEffect* effect = (CollisionEffect*)poolAlloc(&effectPool);
     if (!effect) return NULL;
     
     effect->type = EFFECT_SOUND_PLAY;
@@ -1028,7 +1305,7 @@ CollisionEffect* createSoundPlayEffect(Sound sound, bool continuous) {
 
 // Create a ball disappear effect
 CollisionEffect* createBallDisappearEffect(int particleCount, Color particleColor, bool continuous) {
-    CollisionEffect* effect = (CollisionEffect*)malloc(sizeof(CollisionEffect));
+    CollisionEffect* effect = (CollisionEffect*)poolAlloc(&effectPool);
     if (!effect) return NULL;
     
     effect->type = EFFECT_BALL_DISAPPEAR;
@@ -1042,7 +1319,7 @@ CollisionEffect* createBallDisappearEffect(int particleCount, Color particleColo
 
 // Create a ball spawn effect
 CollisionEffect* createBallSpawnEffect(Vector2 position, float radius, Color color, bool continuous) {
-    CollisionEffect* effect = (CollisionEffect*)malloc(sizeof(CollisionEffect));
+    CollisionEffect* effect = (CollisionEffect*)poolAlloc(&effectPool);
     if (!effect) return NULL;
     
     effect->type = EFFECT_BALL_SPAWN;
@@ -1055,6 +1332,17 @@ CollisionEffect* createBallSpawnEffect(Vector2 position, float radius, Color col
     return effect;
 }
 
+// Copy of an effect from the pool, outside of any list
+CollisionEffect* cloneCollisionEffect(const CollisionEffect* source) {
+    CollisionEffect* effect = (CollisionEffect*)poolAlloc(&effectPool);
+    if (!effect) return NULL;
+    
+    *effect = *source;
+    effect->next = NULL;
+    
+    return effect;
+}
+
 // Add an effect to a list of effects
 void addEffectToList(CollisionEffect** head, CollisionEffect* newEffect) {
     if (!newEffect) return;
@@ -1069,13 +1357,23 @@ void freeEffectList(CollisionEffect** head) {
     
     while (current != NULL) {
         next = current->next;
-        free(current);
+        poolFree(&effectPool, current);
         current = next;
     }
     
     *head = NULL;
 }
 
+// Play a sound triggered by a ball's collision, or queue it if the ball defers its events
+static void playEffectSound(BouncingObject* ball, Sound sound, bool toggle) {
+    CollisionEvent event = { .type = COLLISION_EVENT_SOUND, .ball = ball->handle, .sound = sound, .toggleSound = toggle };
+    if (ball->deferredEvents) {
+        pushCollisionEvent(ball->deferredEvents, &event);
+    } else {
+        runCollisionEvent(&event, ball);
+    }
+}
+
 // Apply all applicable effects from both bouncing object and game object during a collision
 void applyEffects(BouncingObject* bouncingObj, GameObject* gameObj, bool isOngoingCollision) {
     // Apply effects attached to the bouncing object
@@ -1105,7 +1403,7 @@ void applyEffects(BouncingObject* bouncingObj, GameObject* gameObj, bool isOngoi
                 
             case EFFECT_SOUND_PLAY:
                 if (!isOngoingCollision || effect->continuous) { // Only play sound once for non-continuous
-                    IsSoundPlaying(effect->params.soundEffect.sound) ? StopSound(effect->params.soundEffect.sound) : PlaySound(effect->params.soundEffect.sound);
+                    playEffectSound(bouncingObj, effect->params.soundEffect.sound, true);
                 }
                 break;
                 
@@ -1150,7 +1448,7 @@ void applyEffects(BouncingObject* bouncingObj, GameObject* gameObj, bool isOngoi
                     
                 case EFFECT_SOUND_PLAY:
                     if (!isOngoingCollision || effect->continuous) { // Only play sound once for non-continuous
-                        PlaySound(effect->params.soundEffect.sound);
+                        playEffectSound(bouncingObj, effect->params.soundEffect.sound, false);
                     }
                     break;
                 case EFFECT_BALL_DISAPPEAR:
@@ -1162,6 +1460,25 @@ void applyEffects(BouncingObject* bouncingObj, GameObject* gameObj, bool isOngoi
     }
 }
 
+// Run a collision side effect on the main thread (immediately or after a parallel pass)
+void runCollisionEvent(const CollisionEvent* event, BouncingObject* ball) {
+    switch (event->type) {
+        case COLLISION_EVENT_ARC_CALLBACK:
+            event->callback(event->object, ball);
+            break;
+
+        case COLLISION_EVENT_SOUND:
+#ifndef HEADLESS
+            if (event->toggleSound && IsSoundPlaying(event->sound)) {
+                StopSound(event->sound);
+            } else {
+                PlaySound(event->sound);
+            }
+#endif
+            break;
+    }
+}
+
 // --- Add Collision Effects to Objects ---
 
 // Helper function to add collision effects to a GameObject
@@ -1169,11 +1486,6 @@ void addCollisionEffectsToGameObject(GameObject* obj, CollisionEffect* effectsLi
     obj->onCollisionEffects = effectsList;
 }
 
-// Helper function to add collision effects to a BouncingObject
-void addCollisionEffectsToBouncingObject(BouncingObject* obj, CollisionEffect* effectsList) {
-    obj->onCollisionEffects = effectsList;
-}
-
 // Create a GameObject with predefined collision effects
 GameObject* createGameObjectWithEffects(GameObject* baseObject, CollisionEffect* effectsList) {
     if (!baseObject) return NULL;
@@ -1182,15 +1494,6 @@ GameObject* createGameObjectWithEffects(GameObject* baseObject, CollisionEffect*
     return baseObject;
 }
 
-// Count the number of bouncing objects in a list
-int Count_BouncingObjects(BouncingObject* head) {
-    int count = 0;
-    for (BouncingObject* current = head; current != NULL; current = current->next) {
-        count++;
-    }
-    return count;
-}
-
 // Count the number of game objects in a list
 int Count_GameObjects(GameObject* head) {
     int count = 0;
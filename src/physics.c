@@ -0,0 +1,867 @@
+#include "../include/common.h"
+#include <stdlib.h> // For realloc, free
+#include <math.h>   // For fminf, fmaxf, sqrtf
+#include <stdio.h>  // For fopen, fprintf
+
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define PHYSICS_SSE2
+#endif
+
+// --- Ball vs GameObject Collisions ---
+
+// Visit every object the ball may touch during dt: a tree query when a tree is given,
+// otherwise the whole list. Objects whose bounds are out of reach are skipped.
+void forEachCandidateObject(BouncingObject* ball, GameObject* objectList, AABBTree* objectTree,
+                            float dt, AABBTreeVisitor visit, void* userData) {
+    if (objectTree) {
+        // Swept box of the ball, widened by how far the fastest object can move meanwhile
+        Vector2 endPos = Vector2Add(ball->position, Vector2Scale(ball->velocity, dt));
+        float reach = ball->radius + BOUNDS_MARGIN + objectTree->maxObjectSpeed * dt;
+        Vector2 queryMin = { fminf(ball->position.x, endPos.x) - reach, fminf(ball->position.y, endPos.y) - reach };
+        Vector2 queryMax = { fmaxf(ball->position.x, endPos.x) + reach, fmaxf(ball->position.y, endPos.y) + reach };
+        queryAABBTree(objectTree, queryMin, queryMax, visit, userData);
+        return;
+    }
+
+    for (GameObject* obj = objectList; obj != NULL; obj = obj->next) {
+        if (!visit(obj, userData)) return;
+    }
+}
+
+// Collision counters, one slot per thread of the pool (a NULL pool uses slot 0).
+// Each thread adds its counts once per range, so the hot loops only touch locals.
+static CollisionStats threadStats[THREAD_POOL_MAX_THREADS];
+
+void resetCollisionStats(void) {
+    for (int t = 0; t < THREAD_POOL_MAX_THREADS; t++) threadStats[t] = (CollisionStats){0};
+}
+
+// total += sign * counts, field by field (sign -1 gives the counts between two readings)
+void accumulateCollisionStats(CollisionStats* total, const CollisionStats* counts, int sign) {
+    total->narrowphaseCalls += sign * counts->narrowphaseCalls;
+    total->ballPairTests += sign * counts->ballPairTests;
+    for (int s = 0; s < SHAPE_TYPE_COUNT; s++) total->narrowphaseByShape[s] += sign * counts->narrowphaseByShape[s];
+    total->narrowphaseHits += sign * counts->narrowphaseHits;
+    total->boundsTests += sign * counts->boundsTests;
+    total->ballPairContacts += sign * counts->ballPairContacts;
+    total->ballsStepped += sign * counts->ballsStepped;
+    for (int b = 0; b < COLLISION_STATS_SUBSTEP_BUCKETS; b++) total->substepHistogram[b] += sign * counts->substepHistogram[b];
+    total->maxSubstepsReached += sign * counts->maxSubstepsReached;
+}
+
+// Add counts made outside of this file (e.g. by the event-driven mode) to a thread's slot
+void addCollisionStats(int threadIndex, CollisionStats counts) {
+    accumulateCollisionStats(&threadStats[threadIndex], &counts, 1);
+}
+
+CollisionStats getCollisionStats(void) {
+    CollisionStats total = {0};
+    for (int t = 0; t < THREAD_POOL_MAX_THREADS; t++) accumulateCollisionStats(&total, &threadStats[t], 1);
+    return total;
+}
+
+// One counter per line (name, total, per frame), ratios and the substep histogram included
+bool writeCollisionStatsCSV(const char* path, const CollisionStats* stats, long long frames) {
+    static const char* shapeNames[SHAPE_TYPE_COUNT] = { "rectangle", "diamond", "arc" };
+    FILE* file = fopen(path, "w");
+    if (!file) return false;
+    double perFrame = (frames > 0) ? 1.0 / (double)frames : 0.0;
+    fprintf(file, "counter,total,per_frame\n");
+    fprintf(file, "bounds_tests,%lld,%.2f\n", stats->boundsTests, stats->boundsTests * perFrame);
+    fprintf(file, "narrowphase_calls,%lld,%.2f\n", stats->narrowphaseCalls, stats->narrowphaseCalls * perFrame);
+    for (int s = 0; s < SHAPE_TYPE_COUNT; s++) {
+        fprintf(file, "narrowphase_%s,%lld,%.2f\n", shapeNames[s], stats->narrowphaseByShape[s], stats->narrowphaseByShape[s] * perFrame);
+    }
+    fprintf(file, "narrowphase_hits,%lld,%.2f\n", stats->narrowphaseHits, stats->narrowphaseHits * perFrame);
+    fprintf(file, "ball_pair_tests,%lld,%.2f\n", stats->ballPairTests, stats->ballPairTests * perFrame);
+    fprintf(file, "ball_pair_contacts,%lld,%.2f\n", stats->ballPairContacts, stats->ballPairContacts * perFrame);
+    fprintf(file, "balls_stepped,%lld,%.2f\n", stats->ballsStepped, stats->ballsStepped * perFrame);
+    fprintf(file, "max_substeps_reached,%lld,%.2f\n", stats->maxSubstepsReached, stats->maxSubstepsReached * perFrame);
+    for (int b = 0; b < COLLISION_STATS_SUBSTEP_BUCKETS; b++) {
+        fprintf(file, "substeps_%d%s,%lld,%.2f\n", b, (b == COLLISION_STATS_SUBSTEP_BUCKETS - 1) ? "_or_more" : "",
+                stats->substepHistogram[b], stats->substepHistogram[b] * perFrame);
+    }
+
+    // Early-out ratios: share of the candidates each stage got rid of
+    fprintf(file, "bounds_cull_ratio,%.4f,\n", (stats->boundsTests > 0) ? 1.0 - (double)stats->narrowphaseCalls / stats->boundsTests : 0.0);
+    fprintf(file, "narrowphase_miss_ratio,%.4f,\n", (stats->narrowphaseCalls > 0) ? 1.0 - (double)stats->narrowphaseHits / stats->narrowphaseCalls : 0.0);
+    fprintf(file, "ball_pair_miss_ratio,%.4f,\n", (stats->ballPairTests > 0) ? 1.0 - (double)stats->ballPairContacts / stats->ballPairTests : 0.0);
+    return fclose(file) == 0;
+}
+
+typedef struct {
+    BouncingObject* ball;
+    CollisionStats* counts;
+} InitialOverlapQuery;
+
+// If the ball already overlaps the object (collision with time=0), push it out
+static bool visitInitialOverlap(GameObject* obj, void* userData) {
+    InitialOverlapQuery* query = (InitialOverlapQuery*)userData;
+    BouncingObject* bouncingObj = query->ball;
+    query->counts->boundsTests++;
+    if (!canBallReachGameObject(bouncingObj, obj, EPSILON2)) return true;
+
+    float dummy_toi;
+    Vector2 normal;
+    query->counts->narrowphaseCalls++;
+    query->counts->narrowphaseByShape[obj->type]++;
+    if (obj->checkCollision(obj, bouncingObj, EPSILON2, &dummy_toi, &normal) && dummy_toi < EPSILON2) {
+        query->counts->narrowphaseHits++;
+        if (Vector2LengthSqr(normal) > EPSILON2) {
+            // Push bouncing object out along collision normal to resolve overlap
+            bouncingObj->position = Vector2Add(bouncingObj->position, 
+                                              Vector2Scale(normal, bouncingObj->radius * 0.1f));
+        }
+    }
+    return true;
+}
+
+// Earliest collision found so far during one substep
+typedef struct {
+    BouncingObject* ball;
+    float dt;            // Time slice being tested
+    float toi;           // Earliest time of impact found so far
+    GameObject* object;  // Object hit at that time (NULL if none)
+    Vector2 normal;
+    CollisionStats* counts;
+} EarliestHitQuery;
+
+static bool visitEarliestHit(GameObject* obj, void* userData) {
+    EarliestHitQuery* hit = (EarliestHitQuery*)userData;
+    // Skip the narrowphase when the ball can't reach the object's bounds this substep
+    hit->counts->boundsTests++;
+    if (!canBallReachGameObject(hit->ball, obj, hit->dt)) return true;
+
+    float toi_candidate;
+    Vector2 normal_candidate;
+    
+    // Check collision for the current remaining time slice
+    hit->counts->narrowphaseCalls++;
+    hit->counts->narrowphaseByShape[obj->type]++;
+    if (obj->checkCollision(obj, hit->ball, hit->dt, &toi_candidate, &normal_candidate)) {
+        hit->counts->narrowphaseHits++;
+        // Ensure toi_candidate is valid and the earliest
+        if (toi_candidate >= -EPSILON2 && toi_candidate < hit->toi) {
+            hit->toi = toi_candidate;
+            hit->object = obj;
+            hit->normal = normal_candidate;
+        }
+    }
+    return true;
+}
+
+// Collision response of a ball touching an object: reflect its velocity on the normal (relative
+// to the object's surface if it moves), nudge it off the surface and apply the object's effects
+void resolveBallObjectHit(BouncingObject* bouncingObj, GameObject* object, Vector2 normal) {
+    bool isValidNormal = (Vector2LengthSqr(normal) > EPSILON2);
+    
+    // Collision response - velocity reflection with restitution
+    if (isValidNormal && object->surfaceVelocity) {
+        // Moving surface: reflect the velocity relative to the surface at the contact point,
+        // only if the ball moves into it (a surface catching up with the ball pushes it along)
+        Vector2 contact = Vector2Subtract(bouncingObj->position, Vector2Scale(normal, bouncingObj->radius));
+        Vector2 surfaceVelocity = object->surfaceVelocity(object, contact);
+        Vector2 relativeVelocity = Vector2Subtract(bouncingObj->velocity, surfaceVelocity);
+        if (Vector2DotProduct(relativeVelocity, normal) < 0.0f) {
+            bouncingObj->velocity = Vector2Add(surfaceVelocity, Vector2Scale(
+                Vector2Reflect(relativeVelocity, normal),
+                bouncingObj->restitution
+            ));
+        }
+        
+        // Avoid precision issues by nudging away from collision surface
+        bouncingObj->position = Vector2Add(
+            bouncingObj->position, 
+            Vector2Scale(normal, bouncingObj->radius * 0.05f)
+        );
+    } else if (isValidNormal) {
+        // Calculate reflected velocity with restitution factor
+        bouncingObj->velocity = Vector2Scale(
+            Vector2Reflect(bouncingObj->velocity, normal), 
+            bouncingObj->restitution
+        );
+        
+        // Avoid precision issues by nudging away from collision surface
+        bouncingObj->position = Vector2Add(
+            bouncingObj->position, 
+            Vector2Scale(normal, bouncingObj->radius * 0.05f)
+        );
+    } else {
+        // Fallback for invalid normal - push away from object center
+        Vector2 pushDir = Vector2Normalize(
+            Vector2Subtract(bouncingObj->position, object->position)
+        );
+        
+        if (Vector2LengthSqr(pushDir) > EPSILON2) {
+            // Push away from object
+            bouncingObj->position = Vector2Add(
+                bouncingObj->position, 
+                Vector2Scale(pushDir, bouncingObj->radius * 0.1f)
+            );
+            
+            // Simple reflection based on direction to object center
+            bouncingObj->velocity = Vector2Scale(
+                Vector2Reflect(bouncingObj->velocity, pushDir), 
+                bouncingObj->restitution
+            );
+        }
+    }
+    
+    // Apply any collision effects (on initial collision only)
+    applyEffects(bouncingObj, object, false);
+}
+
+// Body of handleBouncingObjectCollisions, adding what it did to *counts
+static int collideWithObjects(BouncingObject* bouncingObj, GameObject* objectList, AABBTree* objectTree, float dt, int maxSubsteps, CollisionStats* counts) {
+    float remainingTimeThisFrame = dt;
+    int substeps = 0;
+    
+    // Check for initial overlap with any object and resolve it before starting simulation
+    bouncingObj->frameElapsed = 0.0f;
+    InitialOverlapQuery overlap = { bouncingObj, counts };
+    forEachCandidateObject(bouncingObj, objectList, objectTree, EPSILON2, visitInitialOverlap, &overlap);
+    bouncingObj->pendingEscapeCount = 0; // The first substep's query finds these crossings again
+    
+    while (remainingTimeThisFrame > EPSILON2 && substeps < maxSubsteps) {
+        bouncingObj->frameElapsed = dt - remainingTimeThisFrame;
+        EarliestHitQuery hit = {
+            .ball = bouncingObj,
+            .dt = remainingTimeThisFrame,
+            .toi = remainingTimeThisFrame, // Assume no collision initially
+            .object = NULL,
+            .normal = {0,0},
+            .counts = counts
+        };
+        
+        // 1. Find the earliest collision time with any object
+        forEachCandidateObject(bouncingObj, objectList, objectTree, remainingTimeThisFrame, visitEarliestHit, &hit);
+        runPendingArcEscapes(bouncingObj, hit.toi);
+        float timeToFirstCollision = hit.toi;
+        GameObject* firstCollidingObject = hit.object;
+        Vector2 firstCollisionNormal = hit.normal;
+        
+        // Ensure non-negative time step
+        timeToFirstCollision = fmaxf(0.0f, timeToFirstCollision);
+
+        // 2. Advance bouncing object by timeToFirstCollision
+        bouncingObj->position = Vector2Add(bouncingObj->position, 
+                                          Vector2Scale(bouncingObj->velocity, timeToFirstCollision));
+        
+        // 3. Update the objects (they move independently)
+        //updateObjectList(objectList, timeToFirstCollision);
+        
+        // 4. Reduce remaining time for this frame
+        remainingTimeThisFrame -= timeToFirstCollision;
+        
+        // 5. If a collision occurred, resolve it
+        if (firstCollidingObject != NULL) {
+            resolveBallObjectHit(bouncingObj, firstCollidingObject, firstCollisionNormal);
+        }
+        
+        substeps++;
+    }
+
+    counts->ballsStepped++;
+    counts->substepHistogram[(substeps < COLLISION_STATS_SUBSTEP_BUCKETS) ? substeps : COLLISION_STATS_SUBSTEP_BUCKETS - 1]++;
+    if (remainingTimeThisFrame > EPSILON2) counts->maxSubstepsReached++;
+    
+    return substeps;
+}
+
+// Find and handle all collisions for a single bouncing object with all game objects
+// objectTree is optional: when given, candidates come from the tree instead of walking objectList
+// Returns the number of collisions handled
+// Counts go to the first slot of the collision counters: call it from one thread at a time.
+int handleBouncingObjectCollisions(BouncingObject* bouncingObj, GameObject* objectList, AABBTree* objectTree, float dt, int maxSubsteps) {
+    return collideWithObjects(bouncingObj, objectList, objectTree, dt, maxSubsteps, &threadStats[0]);
+}
+
+// Screen boundary collision for a bouncing object
+void applyScreenBoundaryCollisions(BouncingObject* obj) {
+    bool reflected = false;
+    
+    if (obj->position.x - obj->radius < 0) {
+        obj->position.x = obj->radius + EPSILON2; // Push out
+        if (obj->velocity.x < 0) obj->velocity.x *= -1; // Reflect
+        reflected = true;
+    } else if (obj->position.x + obj->radius > SCREEN_WIDTH) {
+        obj->position.x = SCREEN_WIDTH - obj->radius - EPSILON2; // Push out
+        if (obj->velocity.x > 0) obj->velocity.x *= -1; // Reflect
+        reflected = true;
+    }
+    
+    if (obj->position.y - obj->radius < 0) {
+        obj->position.y = obj->radius + EPSILON2; // Push out
+        if (obj->velocity.y < 0) obj->velocity.y *= -1; // Reflect
+        reflected = true;
+    } else if (obj->position.y + obj->radius > SCREEN_HEIGHT) {
+        obj->position.y = SCREEN_HEIGHT - obj->radius - EPSILON2; // Push out
+        if (obj->velocity.y > 0) obj->velocity.y *= -1; // Reflect
+        reflected = true;
+    }
+    
+    if (reflected) { // Apply slight damping on wall hit
+        obj->velocity = Vector2Scale(obj->velocity, 0.99f);
+    }
+}
+
+// Same as applyScreenBoundaryCollisions, on ball `i` of the store
+static inline void applyScreenBoundaryToBall(BallStore* store, int i) {
+    float x = store->posX[i], y = store->posY[i];
+    float vx = store->velX[i], vy = store->velY[i];
+    float r = store->radius[i];
+    bool reflected = false;
+
+    if (x - r < 0) {
+        x = r + EPSILON2;
+        if (vx < 0) vx *= -1;
+        reflected = true;
+    } else if (x + r > SCREEN_WIDTH) {
+        x = SCREEN_WIDTH - r - EPSILON2;
+        if (vx > 0) vx *= -1;
+        reflected = true;
+    }
+    if (y - r < 0) {
+        y = r + EPSILON2;
+        if (vy < 0) vy *= -1;
+        reflected = true;
+    } else if (y + r > SCREEN_HEIGHT) {
+        y = SCREEN_HEIGHT - r - EPSILON2;
+        if (vy > 0) vy *= -1;
+        reflected = true;
+    }
+    if (reflected) {
+        vx *= 0.99f;
+        vy *= 0.99f;
+    }
+
+    store->posX[i] = x;
+    store->posY[i] = y;
+    store->velX[i] = vx;
+    store->velY[i] = vy;
+}
+
+#ifdef PHYSICS_SSE2
+static inline __m128 selectPs(__m128 mask, __m128 a, __m128 b) {
+    return _mm_or_ps(_mm_and_ps(mask, a), _mm_andnot_ps(mask, b));
+}
+
+// One axis of the boundary test for 4 balls: push the position back inside [0, size], flip the
+// velocity if it points outwards, and return the mask of the balls that hit a wall
+static inline __m128 reflectAxis(__m128* pos, __m128* vel, __m128 r, __m128 size) {
+    const __m128 zero = _mm_setzero_ps();
+    const __m128 eps = _mm_set1_ps(EPSILON2);
+    const __m128 signBit = _mm_set1_ps(-0.0f);
+    __m128 low = _mm_cmplt_ps(_mm_sub_ps(*pos, r), zero);
+    __m128 high = _mm_andnot_ps(low, _mm_cmpgt_ps(_mm_add_ps(*pos, r), size));
+    *pos = selectPs(low, _mm_add_ps(r, eps), selectPs(high, _mm_sub_ps(_mm_sub_ps(size, r), eps), *pos));
+    __m128 flip = _mm_or_ps(_mm_and_ps(low, _mm_cmplt_ps(*vel, zero)), _mm_and_ps(high, _mm_cmpgt_ps(*vel, zero)));
+    *vel = _mm_xor_ps(*vel, _mm_and_ps(flip, signBit));
+    return _mm_or_ps(low, high);
+}
+#endif
+
+// Screen boundary collisions for balls [begin, end) of the store, 4 balls at a time without
+// branches. Gives exactly the same result as applyScreenBoundaryCollisions on every ball.
+void applyScreenBoundaryCollisionsRange(BallStore* store, int begin, int end) {
+    int i = begin;
+#ifdef PHYSICS_SSE2
+    const __m128 width = _mm_set1_ps((float)SCREEN_WIDTH);
+    const __m128 height = _mm_set1_ps((float)SCREEN_HEIGHT);
+    const __m128 damping = _mm_set1_ps(0.99f);
+    const __m128 one = _mm_set1_ps(1.0f);
+    for (; i + 4 <= end; i += 4) {
+        __m128 x = _mm_loadu_ps(&store->posX[i]), y = _mm_loadu_ps(&store->posY[i]);
+        __m128 vx = _mm_loadu_ps(&store->velX[i]), vy = _mm_loadu_ps(&store->velY[i]);
+        __m128 r = _mm_loadu_ps(&store->radius[i]);
+
+        __m128 reflected = _mm_or_ps(reflectAxis(&x, &vx, r, width), reflectAxis(&y, &vy, r, height));
+        __m128 scale = selectPs(reflected, damping, one); // Slight damping on wall hit (x1 is exact)
+
+        _mm_storeu_ps(&store->posX[i], x);
+        _mm_storeu_ps(&store->posY[i], y);
+        _mm_storeu_ps(&store->velX[i], _mm_mul_ps(vx, scale));
+        _mm_storeu_ps(&store->velY[i], _mm_mul_ps(vy, scale));
+    }
+#endif
+    for (; i < end; i++) {
+        applyScreenBoundaryToBall(store, i);
+    }
+}
+
+// Append an event to a buffer, growing it if needed
+bool pushCollisionEvent(CollisionEventBuffer* buffer, const CollisionEvent* event) {
+    if (buffer->count >= buffer->capacity) {
+        int newCapacity = (buffer->capacity > 0) ? buffer->capacity * 2 : 64;
+        CollisionEvent* newEvents = (CollisionEvent*)realloc(buffer->events, (size_t)newCapacity * sizeof(CollisionEvent));
+        if (!newEvents) return false;
+        buffer->events = newEvents;
+        buffer->capacity = newCapacity;
+    }
+    buffer->events[buffer->count++] = *event;
+    return true;
+}
+
+// One event buffer per thread. Threads get contiguous, ordered ranges of balls, so
+// reading the buffers in thread order replays the events in ball order.
+static CollisionEventBuffer threadEvents[THREAD_POOL_MAX_THREADS];
+
+typedef struct {
+    BallStore* balls;
+    GameObject* objectList;
+    AABBTree* objectTree;
+    float dt;
+    int maxSubsteps;
+    bool profiling;                                // Time the boundary sweeps (isProfilerRecording)
+    double boundaryStart[THREAD_POOL_MAX_THREADS]; // When each thread ran its sweep (profileNow)
+    double boundaryEnd[THREAD_POOL_MAX_THREADS];
+} ObjectCollisionJob;
+
+static void objectCollisionRange(void* userData, int begin, int end, int threadIndex) {
+    ObjectCollisionJob* job = (ObjectCollisionJob*)userData;
+    CollisionStats counts = {0};
+    for (int i = begin; i < end; i++) {
+        if (job->balls->flags[i] & BALL_FLAG_ASLEEP) continue; // Still, and nothing moving nearby
+
+        BouncingObject ball;
+        loadBouncingObject(job->balls, i, &ball);
+        ball.deferredEvents = &threadEvents[threadIndex];
+
+        // Handle collisions with all static and moving non-bouncing objects
+        collideWithObjects(&ball, job->objectList, job->objectTree, job->dt, job->maxSubsteps, &counts);
+
+        storeBouncingObject(job->balls, i, &ball);
+    }
+
+    // Apply simple screen boundary collisions, in one sweep over the range
+    if (job->profiling) job->boundaryStart[threadIndex] = profileNow();
+    applyScreenBoundaryCollisionsRange(job->balls, begin, end);
+    if (job->profiling) job->boundaryEnd[threadIndex] = profileNow();
+
+    accumulateCollisionStats(&threadStats[threadIndex], &counts, 1);
+}
+
+// Collide every ball with the GameObjects and the screen edges.
+// Balls only read the GameObjects, so they are split over the thread pool (threads may be NULL);
+// arc callbacks and sounds are deferred and run here afterwards, in ball order, whatever the
+// number of threads.
+void handleBouncingObjectListCollisions(BallStore* balls, GameObject* objectList, AABBTree* objectTree, float dt, int maxSubsteps, ThreadPool* threads) {
+    ObjectCollisionJob job = { balls, objectList, objectTree, dt, maxSubsteps, isProfilerRecording(), {0}, {0} };
+    int threadCount = threads ? threads->threadCount : 1;
+    for (int t = 0; t < threadCount; t++) threadEvents[t].count = 0;
+
+    runParallelRange(threads, balls->count, objectCollisionRange, &job);
+    if (job.profiling) {
+        // The longest sweep is the wall-clock time of the phase; the sum is its CPU time
+        int longest = 0;
+        double totalTime = 0.0;
+        for (int t = 0; t < threadCount; t++) {
+            double time = job.boundaryEnd[t] - job.boundaryStart[t];
+            totalTime += time;
+            if (time > job.boundaryEnd[longest] - job.boundaryStart[longest]) longest = t;
+        }
+        profileAddScope(PROFILE_SCREEN_BOUNDARIES, job.boundaryStart[longest], job.boundaryEnd[longest]);
+        profileAddThreadTime(PROFILE_SCREEN_BOUNDARIES, totalTime);
+    }
+
+    for (int t = 0; t < threadCount; t++) {
+        for (int e = 0; e < threadEvents[t].count; e++) {
+            const CollisionEvent* event = &threadEvents[t].events[e];
+            int index = getBallIndex(balls, event->ball);
+            if (index < 0) continue;
+
+            // Callbacks see (and may change) the ball as it is at the end of the pass
+            BouncingObject ball;
+            loadBouncingObject(balls, index, &ball);
+            runCollisionEvent(event, &ball);
+            storeBouncingObject(balls, index, &ball);
+        }
+    }
+}
+
+// --- Ball-to-Ball Collisions ---
+
+// Elastic collision impulse between balls i and j along `normal` (unit, from i to j)
+static void applyBallPairImpulse(BallStore* balls, int i, int j, Vector2 normal) {
+    float mass1 = balls->mass[i];
+    float mass2 = balls->mass[j];
+
+    // Calculate relative velocity along the normal
+    float relVelX = balls->velX[i] - balls->velX[j];
+    float relVelY = balls->velY[i] - balls->velY[j];
+    float relVelAlongNormal = relVelX * normal.x + relVelY * normal.y;
+
+    // Calculate impulse strength
+    float impulseMagnitude = (-(1 + balls->restitution[i] * balls->restitution[j]) * relVelAlongNormal) /
+                             (1/mass1 + 1/mass2);
+
+    // Apply impulse to velocities
+    balls->velX[i] += normal.x * impulseMagnitude / mass1;
+    balls->velY[i] += normal.y * impulseMagnitude / mass1;
+    balls->velX[j] -= normal.x * impulseMagnitude / mass2;
+    balls->velY[j] -= normal.y * impulseMagnitude / mass2;
+}
+
+// Balls which don't overlap at the end of the step may have gone through each other during it
+// (small fast balls, large dt). Each path over the step is taken as the straight line from the
+// position at the start of the step (prevX/prevY) to the current one; ball i moving relative
+// to ball j is then a swept ball of both radii against a point. If they touched on the way while
+// getting closer, both balls go back to where they touched and bounce there (the rest of their
+// step is lost, as for a ball which runs out of substeps). Returns true if they did.
+static bool resolveCrossingBallPair(BallStore* balls, int i, int j) {
+    Vector2 startI = { balls->prevX[i], balls->prevY[i] };
+    Vector2 startJ = { balls->prevX[j], balls->prevY[j] };
+    Vector2 moveI = { balls->posX[i] - startI.x, balls->posY[i] - startI.y };
+    Vector2 moveJ = { balls->posX[j] - startJ.x, balls->posY[j] - startJ.y };
+    Vector2 relStart = Vector2Subtract(startI, startJ);
+    Vector2 relMove = Vector2Subtract(moveI, moveJ);
+    float minDistance = balls->radius[i] + balls->radius[j];
+
+    // Touching at the start (the overlap test handled them then) or not getting closer
+    if (Vector2LengthSqr(relStart) <= minDistance * minDistance) return false;
+    if (Vector2DotProduct(relStart, relMove) >= 0.0f) return false;
+
+    float t;
+    Vector2 normalFromJ;
+    if (!sweptBallToStaticPointCollision(startJ, startI, relMove, minDistance, 1.0f, &t, &normalFromJ)) return false;
+    Vector2 normal = Vector2Negate(normalFromJ);
+
+    // The paths are only an estimate when a ball bounced on an obstacle during the step:
+    // leave the pair alone if the velocities now move the balls apart
+    float relVelAlongNormal = (balls->velX[i] - balls->velX[j]) * normal.x +
+                              (balls->velY[i] - balls->velY[j]) * normal.y;
+    if (relVelAlongNormal <= 0.0f) return false;
+
+    t = fminf(t, 1.0f);
+    balls->posX[i] = startI.x + moveI.x * t;
+    balls->posY[i] = startI.y + moveI.y * t;
+    balls->posX[j] = startJ.x + moveJ.x * t;
+    balls->posY[j] = startJ.y + moveJ.y * t;
+    applyBallPairImpulse(balls, i, j, normal);
+    return true;
+}
+
+// Resolve the collision between balls i and j of the store if they overlap,
+// or if they went through each other during the step. Returns true if they touched.
+static bool resolveBallPair(BallStore* balls, int i, int j) {
+    // Two sleeping balls stay as they settled
+    if (balls->flags[i] & balls->flags[j] & BALL_FLAG_ASLEEP) return false;
+
+    // Calculate distance between centers
+    float dx = balls->posX[j] - balls->posX[i];
+    float dy = balls->posY[j] - balls->posY[i];
+    float distance = sqrtf(dx * dx + dy * dy);
+    float minDistance = balls->radius[i] + balls->radius[j];
+
+    // Check for collision (overlap)
+    if (distance >= minDistance) {
+        return resolveCrossingBallPair(balls, i, j);
+    }
+
+    // Calculate normal vector from ball i to ball j
+    Vector2 normal = Vector2Normalize((Vector2){ dx, dy });
+
+    // Calculate overlap amount
+    float overlap = minDistance - distance;
+
+    // Separate the balls to avoid persistent collision
+    // Distribute movement based on masses (heavier ball moves less)
+    float mass1 = balls->mass[i];
+    float mass2 = balls->mass[j];
+    float totalMass = mass1 + mass2;
+    float ball1Ratio = mass2 / totalMass;
+    float ball2Ratio = mass1 / totalMass;
+
+    // Push balls apart
+    balls->posX[i] -= normal.x * overlap * ball1Ratio;
+    balls->posY[i] -= normal.y * overlap * ball1Ratio;
+    balls->posX[j] += normal.x * overlap * ball2Ratio;
+    balls->posY[j] += normal.y * overlap * ball2Ratio;
+
+    // Collision response (elastic collision formula)
+    applyBallPairImpulse(balls, i, j, normal);
+    return true;
+}
+
+// Scratch buffers reused from frame to frame by handleBallToBallCollisions:
+// circles of the interacting balls in the grid, and their index in the store
+static SpatialGrid ballGrid;
+static SpatialGrid fastGrid;    // Paths of the balls too fast for ballGrid
+static int* gridBallIndex = NULL;
+static float* gridX = NULL;
+static float* gridY = NULL;
+static float* gridRadius = NULL;
+static int* fastBall = NULL;    // Grid index of the balls whose path doesn't fit in a cell,
+static float* fastX = NULL;     // and the circle around that path
+static float* fastY = NULL;
+static float* fastRadius = NULL;
+static int gridCapacity = 0;
+
+static bool reserveGridScratch(int count) {
+    if (count <= gridCapacity) return true;
+    int newCapacity = (gridCapacity > 0) ? gridCapacity : 256;
+    while (newCapacity < count) newCapacity *= 2;
+
+    int* newIndex = (int*)realloc(gridBallIndex, newCapacity * sizeof(int));
+    if (!newIndex) return false;
+    gridBallIndex = newIndex;
+    float* newX = (float*)realloc(gridX, newCapacity * sizeof(float));
+    if (!newX) return false;
+    gridX = newX;
+    float* newY = (float*)realloc(gridY, newCapacity * sizeof(float));
+    if (!newY) return false;
+    gridY = newY;
+    float* newRadius = (float*)realloc(gridRadius, newCapacity * sizeof(float));
+    if (!newRadius) return false;
+    gridRadius = newRadius;
+    int* newFast = (int*)realloc(fastBall, newCapacity * sizeof(int));
+    if (!newFast) return false;
+    fastBall = newFast;
+    float* newFastX = (float*)realloc(fastX, newCapacity * sizeof(float));
+    if (!newFastX) return false;
+    fastX = newFastX;
+    float* newFastY = (float*)realloc(fastY, newCapacity * sizeof(float));
+    if (!newFastY) return false;
+    fastY = newFastY;
+    float* newFastRadius = (float*)realloc(fastRadius, newCapacity * sizeof(float));
+    if (!newFastRadius) return false;
+    fastRadius = newFastRadius;
+
+    gridCapacity = newCapacity;
+    return true;
+}
+
+// Resolve the pairs owned by the bands of one parity (see visitSpatialGridBandPairs)
+typedef struct {
+    BallStore* balls;
+    int phase;
+} ContactBatchJob;
+
+// Pairs of one range of bands
+typedef struct {
+    BallStore* balls;
+    long long contacts;
+} BandPairQuery;
+
+static bool visitResolvePair(int a, int b, void* userData) {
+    BandPairQuery* query = (BandPairQuery*)userData;
+    query->contacts += resolveBallPair(query->balls, gridBallIndex[a], gridBallIndex[b]);
+    return true;
+}
+
+// Pairs of one ball too fast for the grid cells (see handleBallToBallCollisions)
+typedef struct {
+    BallStore* balls;
+    int fast; // Index of the fast ball in the grid arrays
+    long long contacts;
+} FastBallQuery;
+
+static bool visitResolveFastPair(int b, void* userData) {
+    FastBallQuery* query = (FastBallQuery*)userData;
+    if (b != query->fast) query->contacts += resolveBallPair(query->balls, gridBallIndex[query->fast], gridBallIndex[b]);
+    return true;
+}
+
+static void contactBatchRange(void* userData, int begin, int end, int threadIndex) {
+    ContactBatchJob* job = (ContactBatchJob*)userData;
+    BandPairQuery query = { job->balls, 0 };
+    long long pairTests = 0;
+    for (int k = begin; k < end; k++) {
+        int band = job->phase + 2 * k;
+        pairTests += visitSpatialGridBandPairs(&ballGrid, gridX, gridY, gridRadius, band, visitResolvePair, &query);
+    }
+    threadStats[threadIndex].ballPairTests += pairTests;
+    threadStats[threadIndex].ballPairContacts += query.contacts;
+}
+
+// Handle collisions between bouncing objects, overlapping at the end of the step or gone
+// through each other during it (from prevX/prevY, see resolveCrossingBallPair)
+// Candidate pairs come from a uniform grid rebuilt every frame, so the cost is
+// roughly linear in the number of balls instead of quadratic.
+// Pairs are resolved band by band, even bands first, then odd bands; bands of the same
+// parity share no ball, so they are split over the thread pool (threads may be NULL).
+// The result doesn't depend on the number of threads.
+void handleBallToBallCollisions(BallStore* balls, float dt, ThreadPool* threads) {
+    (void)dt; // The paths over the step come from prevX/prevY, the time step is not needed
+
+    // 1. Gather the balls that interact with other bouncing objects
+    if (!reserveGridScratch(balls->count)) {
+        handleBallToBallCollisionsNaive(balls, dt);
+        return;
+    }
+    int count = 0;
+    float maxRadius = 0.0f;
+    for (int i = 0; i < balls->count; i++) {
+        if (!(balls->flags[i] & BALL_FLAG_INTERACT_WITH_BALLS)) continue;
+        gridBallIndex[count++] = i;
+        maxRadius = fmaxf(maxRadius, balls->radius[i]);
+    }
+    if (count < 2) return;
+
+    // A ball which moved further than its radius during the step is binned with a circle around
+    // its path, so that balls which went through each other are still a candidate pair. Slower
+    // balls keep their own circle: two of them can only graze each other without overlapping at
+    // the end. The cell size still comes from the largest ball: a path which doesn't fit in a
+    // cell is binned with the ball's own circle and tested after the bands (fastBall).
+    int fastCount = 0;
+    for (int k = 0; k < count; k++) {
+        int i = gridBallIndex[k];
+        float halfX = (balls->posX[i] - balls->prevX[i]) * 0.5f;
+        float halfY = (balls->posY[i] - balls->prevY[i]) * 0.5f;
+        float halfLengthSq = halfX * halfX + halfY * halfY;
+        float sweptRadius = balls->radius[i] + sqrtf(halfLengthSq);
+        bool movedFar = 4.0f * halfLengthSq > balls->radius[i] * balls->radius[i];
+        if (movedFar && sweptRadius <= maxRadius) {
+            gridX[k] = balls->prevX[i] + halfX;
+            gridY[k] = balls->prevY[i] + halfY;
+            gridRadius[k] = sweptRadius;
+            continue;
+        }
+        gridX[k] = balls->posX[i];
+        gridY[k] = balls->posY[i];
+        gridRadius[k] = balls->radius[i];
+        if (movedFar) {
+            fastBall[fastCount] = k;
+            fastX[fastCount] = balls->prevX[i] + halfX;
+            fastY[fastCount] = balls->prevY[i] + halfY;
+            fastRadius[fastCount] = sweptRadius;
+            fastCount++;
+        }
+    }
+
+    // 2. Broadphase: bin balls into the grid
+    if (!rebuildSpatialGrid(&ballGrid, gridX, gridY, gridRadius, count)) {
+        handleBallToBallCollisionsNaive(balls, dt);
+        return;
+    }
+
+    // 3. Narrowphase, even bands then odd bands: pairs are found with the paths at the start of
+    // the pass and resolveBallPair re-checks them, as earlier pairs may already
+    // have pushed the balls apart
+    for (int phase = 0; phase < 2; phase++) {
+        ContactBatchJob job = { balls, phase };
+        runParallelRange(threads, getSpatialGridPhaseBandCount(&ballGrid, phase), contactBatchRange, &job);
+    }
+
+    // 4. Balls whose path doesn't fit in a cell, on this thread: against the grid with a circle
+    // query, then against each other with a second grid of their paths. A pair met twice is
+    // resolved once, the second resolveBallPair finds the balls already apart.
+    if (fastCount == 0) return;
+    long long pairTests = 0;
+    long long contacts = 0;
+    for (int f = 0; f < fastCount; f++) {
+        FastBallQuery query = { balls, fastBall[f], 0 };
+        pairTests += visitSpatialGridCircle(&ballGrid, gridX, gridY, gridRadius, fastX[f], fastY[f], fastRadius[f],
+                                            visitResolveFastPair, &query);
+        contacts += query.contacts;
+    }
+    if (fastCount > 1 && rebuildSpatialGrid(&fastGrid, fastX, fastY, fastRadius, fastCount)) {
+        collectSpatialGridPairs(&fastGrid, fastX, fastY, fastRadius);
+        pairTests += fastGrid.candidateCount;
+        for (int p = 0; p < fastGrid.pairCount; p++) {
+            contacts += resolveBallPair(balls, gridBallIndex[fastBall[fastGrid.pairs[p].a]], gridBallIndex[fastBall[fastGrid.pairs[p].b]]);
+        }
+    }
+    threadStats[0].ballPairTests += pairTests;
+    threadStats[0].ballPairContacts += contacts;
+}
+
+// Reference implementation testing every pair of balls (O(n^2)), kept for benchmarks
+void handleBallToBallCollisionsNaive(BallStore* balls, float dt) {
+    (void)dt;
+    // For each pair of balls, check for collisions
+    for (int i = 0; i < balls->count; i++) {
+        // Skip if this ball shouldn't interact with other bouncing objects
+        if (!(balls->flags[i] & BALL_FLAG_INTERACT_WITH_BALLS)) continue;
+
+        for (int j = i + 1; j < balls->count; j++) {
+            // Skip if the second ball shouldn't interact with other bouncing objects
+            if (!(balls->flags[j] & BALL_FLAG_INTERACT_WITH_BALLS)) continue;
+
+            threadStats[0].ballPairTests++;
+            threadStats[0].ballPairContacts += resolveBallPair(balls, i, j);
+        }
+    }
+}
+
+// --- Sleeping balls ---
+
+typedef struct {
+    float x, y, radius;
+    float dt;
+    bool nearMovingObject;
+} WakeQuery;
+
+// Objects which may run into a still ball: the ones which move, and the rotating arcs
+static bool isMovingObject(const GameObject* obj) {
+    if (!obj->isStatic) return true;
+    return obj->type == SHAPE_CIRCLE_ARC && ((const ShapeDataArcCircle*)obj->shapeData)->rotationSpeed != 0.0f;
+}
+
+static bool visitMovingObject(GameObject* obj, void* userData) {
+    WakeQuery* query = (WakeQuery*)userData;
+    if (!isMovingObject(obj)) return true;
+
+    // Ball against the object's bounds, widened by how far the object moves in a step
+    float reach = query->radius + BOUNDS_MARGIN + Vector2Length(obj->velocity) * query->dt;
+    if (query->x < obj->boundsMin.x - reach || query->x > obj->boundsMax.x + reach ||
+        query->y < obj->boundsMin.y - reach || query->y > obj->boundsMax.y + reach) return true;
+
+    query->nearMovingObject = true;
+    return false;
+}
+
+// Balls slower than BALL_SLEEP_SPEED for sleepSteps steps in a row fall asleep: their velocity is
+// zeroed and the object pass skips them, as does the ball pass for pairs of sleeping balls, so a
+// settled pile costs almost nothing. A sleeping ball wakes when it is given a speed (a contact with
+// an awake ball, a callback), gets new effects (addCollisionEffectsToBouncingObject), or when a
+// moving object comes near; a ball near a moving object doesn't fall asleep.
+// sleepSteps <= 0 wakes every ball and keeps them awake.
+void updateSleepingBalls(BallStore* balls, GameObject* objectList, AABBTree* objectTree, float dt, int sleepSteps) {
+    if (sleepSteps <= 0) {
+        if (balls->asleepCount == 0) return;
+        for (int i = 0; i < balls->count; i++) wakeBall(balls, i);
+        balls->asleepCount = 0;
+        return;
+    }
+    if (sleepSteps > 255) sleepSteps = 255; // stillSteps is a uint8_t
+
+    bool anyMovingObject = false;
+    for (GameObject* obj = objectList; obj != NULL && !anyMovingObject; obj = obj->next) {
+        anyMovingObject = isMovingObject(obj);
+    }
+
+    const float sleepSpeedSq = BALL_SLEEP_SPEED * BALL_SLEEP_SPEED;
+    int asleepCount = 0;
+    for (int i = 0; i < balls->count; i++) {
+        float speedSq = balls->velX[i] * balls->velX[i] + balls->velY[i] * balls->velY[i];
+        if (speedSq >= sleepSpeedSq) {
+            wakeBall(balls, i);
+            continue;
+        }
+
+        bool asleep = (balls->flags[i] & BALL_FLAG_ASLEEP) != 0;
+        if (!asleep) {
+            if (balls->stillSteps[i] < 255) balls->stillSteps[i]++;
+            if (balls->stillSteps[i] < sleepSteps) continue;
+        }
+
+        if (anyMovingObject) {
+            BouncingObject ball = { .position = { balls->posX[i], balls->posY[i] }, .radius = balls->radius[i] };
+            WakeQuery query = { ball.position.x, ball.position.y, ball.radius, dt, false };
+            forEachCandidateObject(&ball, objectList, objectTree, dt, visitMovingObject, &query);
+            if (query.nearMovingObject) {
+                wakeBall(balls, i);
+                continue;
+            }
+        }
+
+        // Asleep: drop what is left of the speed, so the ball stays exactly where it settled
+        balls->flags[i] |= BALL_FLAG_ASLEEP;
+        balls->velX[i] = 0.0f;
+        balls->velY[i] = 0.0f;
+        asleepCount++;
+    }
+    balls->asleepCount = asleepCount;
+}
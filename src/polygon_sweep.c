@@ -0,0 +1,267 @@
+#include "../include/common.h"
+#include <math.h> // For sqrtf, fabsf, fmaxf
+
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define POLYGON_SWEEP_SSE2
+#endif
+
+// --- Swept ball vs static polygon, 4 vertices and 4 edges at a time ---
+//
+// Same tests as calling sweptBallToStaticSegmentCollision on every edge, but each vertex is
+// tested once (instead of once per edge it ends) and the vertex and edge tests of a batch of
+// 4 run in the 4 lanes of an SSE register. Lanes only compute times of impact; the normal is
+// computed once, for the earliest hit. Without SSE2 the same lanes run in a scalar loop.
+
+#define SWEEP_LANES 4
+#define SWEEP_NO_HIT 1e30f
+#define SWEEP_MAX_VERTICES 64 // Bigger polygons use the per-edge tests
+
+// Vertices i..i+3 of a polygon, and the end of the edges starting at them
+typedef struct {
+    float px[SWEEP_LANES], py[SWEEP_LANES]; // Vertex, start of the edge
+    float ex[SWEEP_LANES], ey[SWEEP_LANES]; // End of the edge
+} SweepBatch;
+
+typedef struct {
+    float bx, by;   // Ball position
+    float vx, vy;   // Ball velocity (relative to the polygon)
+    float radius;
+    float a;        // |velocity|^2, at least EPSILON2
+    float dtMax;
+} SweepBall;
+
+#ifdef POLYGON_SWEEP_SSE2
+static inline __m128 selectPs(__m128 mask, __m128 a, __m128 b) {
+    return _mm_or_ps(_mm_and_ps(mask, a), _mm_andnot_ps(mask, b));
+}
+
+// Earliest time in [-EPSILON2, dtMax + EPSILON2] at which the ball touches each vertex (tVertex)
+// and the inside of each edge (tEdge), SWEEP_NO_HIT when it doesn't
+static void sweepBatch(const SweepBatch* batch, const SweepBall* ball, float* tVertex, float* tEdge) {
+    const __m128 eps = _mm_set1_ps(EPSILON2);
+    const __m128 lo = _mm_set1_ps(-EPSILON2);
+    const __m128 hi = _mm_set1_ps(ball->dtMax + EPSILON2);
+    const __m128 noHit = _mm_set1_ps(SWEEP_NO_HIT);
+    const __m128 absMask = _mm_castsi128_ps(_mm_set1_epi32(0x7fffffff));
+    const __m128 bx = _mm_set1_ps(ball->bx), by = _mm_set1_ps(ball->by);
+    const __m128 vx = _mm_set1_ps(ball->vx), vy = _mm_set1_ps(ball->vy);
+    const __m128 r = _mm_set1_ps(ball->radius);
+
+    __m128 px = _mm_loadu_ps(batch->px), py = _mm_loadu_ps(batch->py);
+    __m128 relX = _mm_sub_ps(bx, px), relY = _mm_sub_ps(by, py);
+
+    // Vertices: |rel + vel*t|^2 = r^2, a*t^2 + b*t + c = 0 with a > 0, so t1 <= t2
+    __m128 a = _mm_set1_ps(ball->a);
+    __m128 b = _mm_mul_ps(_mm_set1_ps(2.0f), _mm_add_ps(_mm_mul_ps(relX, vx), _mm_mul_ps(relY, vy)));
+    __m128 c = _mm_sub_ps(_mm_add_ps(_mm_mul_ps(relX, relX), _mm_mul_ps(relY, relY)), _mm_mul_ps(r, r));
+    __m128 disc = _mm_sub_ps(_mm_mul_ps(b, b), _mm_mul_ps(_mm_mul_ps(_mm_set1_ps(4.0f), a), c));
+    __m128 hasRoot = _mm_cmpge_ps(disc, _mm_setzero_ps());
+    __m128 sq = _mm_sqrt_ps(_mm_max_ps(disc, _mm_setzero_ps()));
+    __m128 twoA = _mm_mul_ps(_mm_set1_ps(2.0f), a);
+    __m128 negB = _mm_sub_ps(_mm_setzero_ps(), b);
+    __m128 t1 = _mm_div_ps(_mm_sub_ps(negB, sq), twoA);
+    __m128 t2 = _mm_div_ps(_mm_add_ps(negB, sq), twoA);
+    __m128 in1 = _mm_and_ps(_mm_cmpge_ps(t1, lo), _mm_cmple_ps(t1, hi));
+    __m128 in2 = _mm_and_ps(_mm_cmpge_ps(t2, lo), _mm_cmple_ps(t2, hi));
+    __m128 tv = selectPs(in1, t1, selectPs(in2, t2, noHit));
+    _mm_storeu_ps(tVertex, selectPs(hasRoot, tv, noHit));
+
+    // Edges: signed distance to the edge's line goes from dist to +-r
+    __m128 segX = _mm_sub_ps(_mm_loadu_ps(batch->ex), px);
+    __m128 segY = _mm_sub_ps(_mm_loadu_ps(batch->ey), py);
+    __m128 lenSq = _mm_add_ps(_mm_mul_ps(segX, segX), _mm_mul_ps(segY, segY));
+    __m128 len = _mm_sqrt_ps(lenSq);
+    __m128 invLen = _mm_div_ps(_mm_set1_ps(1.0f), len);
+    __m128 dirX = _mm_mul_ps(segX, invLen), dirY = _mm_mul_ps(segY, invLen);
+    __m128 perpX = _mm_sub_ps(_mm_setzero_ps(), dirY), perpY = dirX;
+    __m128 dist = _mm_add_ps(_mm_mul_ps(relX, perpX), _mm_mul_ps(relY, perpY));
+    __m128 vPerp = _mm_add_ps(_mm_mul_ps(vx, perpX), _mm_mul_ps(vy, perpY));
+    __m128 tl1 = _mm_div_ps(_mm_sub_ps(r, dist), vPerp);
+    __m128 tl2 = _mm_div_ps(_mm_sub_ps(_mm_sub_ps(_mm_setzero_ps(), r), dist), vPerp);
+    in1 = _mm_and_ps(_mm_cmpge_ps(tl1, lo), _mm_cmple_ps(tl1, hi));
+    in2 = _mm_and_ps(_mm_cmpge_ps(tl2, lo), _mm_cmple_ps(tl2, hi));
+    __m128 take2 = _mm_and_ps(in2, _mm_or_ps(_mm_andnot_ps(in1, _mm_castsi128_ps(_mm_set1_epi32(-1))), _mm_cmplt_ps(tl2, tl1)));
+    __m128 tl = selectPs(take2, tl2, tl1);
+
+    // The ball must touch the line inside the segment
+    __m128 cx = _mm_sub_ps(_mm_add_ps(bx, _mm_mul_ps(vx, tl)), px);
+    __m128 cy = _mm_sub_ps(_mm_add_ps(by, _mm_mul_ps(vy, tl)), py);
+    __m128 projection = _mm_add_ps(_mm_mul_ps(cx, dirX), _mm_mul_ps(cy, dirY));
+    __m128 valid = _mm_and_ps(_mm_cmpge_ps(lenSq, eps), _mm_cmpge_ps(_mm_and_ps(vPerp, absMask), eps));
+    valid = _mm_and_ps(valid, _mm_or_ps(in1, in2));
+    valid = _mm_and_ps(valid, _mm_cmpge_ps(projection, lo));
+    valid = _mm_and_ps(valid, _mm_cmple_ps(projection, _mm_add_ps(len, eps)));
+    _mm_storeu_ps(tEdge, selectPs(valid, tl, noHit));
+}
+#else
+// Scalar version of the lanes above, for targets without SSE2
+static void sweepBatch(const SweepBatch* batch, const SweepBall* ball, float* tVertex, float* tEdge) {
+    const float hi = ball->dtMax + EPSILON2;
+    for (int l = 0; l < SWEEP_LANES; l++) {
+        float relX = ball->bx - batch->px[l], relY = ball->by - batch->py[l];
+
+        float b = 2.0f * (relX * ball->vx + relY * ball->vy);
+        float c = relX * relX + relY * relY - ball->radius * ball->radius;
+        float disc = b * b - 4.0f * ball->a * c;
+        tVertex[l] = SWEEP_NO_HIT;
+        if (disc >= 0.0f) {
+            float sq = sqrtf(disc);
+            float t1 = (-b - sq) / (2.0f * ball->a);
+            float t2 = (-b + sq) / (2.0f * ball->a);
+            if (t1 >= -EPSILON2 && t1 <= hi) tVertex[l] = t1;
+            else if (t2 >= -EPSILON2 && t2 <= hi) tVertex[l] = t2;
+        }
+
+        tEdge[l] = SWEEP_NO_HIT;
+        float segX = batch->ex[l] - batch->px[l], segY = batch->ey[l] - batch->py[l];
+        float lenSq = segX * segX + segY * segY;
+        if (lenSq < EPSILON2) continue;
+        float len = sqrtf(lenSq);
+        float dirX = segX * (1.0f / len), dirY = segY * (1.0f / len);
+        float dist = relX * -dirY + relY * dirX;
+        float vPerp = ball->vx * -dirY + ball->vy * dirX;
+        if (fabsf(vPerp) < EPSILON2) continue;
+        float tl1 = (ball->radius - dist) / vPerp;
+        float tl2 = (-ball->radius - dist) / vPerp;
+        bool in1 = tl1 >= -EPSILON2 && tl1 <= hi;
+        bool in2 = tl2 >= -EPSILON2 && tl2 <= hi;
+        if (!in1 && !in2) continue;
+        float tl = (in2 && (!in1 || tl2 < tl1)) ? tl2 : tl1;
+        float projection = (relX + ball->vx * tl) * dirX + (relY + ball->vy * tl) * dirY;
+        if (projection >= -EPSILON2 && projection <= len + EPSILON2) tEdge[l] = tl;
+    }
+}
+#endif
+
+// Normal of a hit on vertex `point` at time t (as in sweptBallToStaticPointCollision)
+static Vector2 vertexHitNormal(Vector2 point, Vector2 ballPos, Vector2 ballVel, float toi) {
+    Vector2 ballCenterAtToi = Vector2Add(ballPos, Vector2Scale(ballVel, toi));
+    Vector2 normal = Vector2Normalize(Vector2Subtract(ballCenterAtToi, point));
+    if (Vector2LengthSqr(normal) < EPSILON2) { // Degenerate case
+        normal = Vector2Normalize(Vector2Subtract(ballPos, point)); // Fallback to initial direction
+        if (Vector2LengthSqr(normal) < EPSILON2) normal = (Vector2){0, -1};
+    }
+    return normal;
+}
+
+// Normal of a hit on the inside of edge p1-p2 at time t (as in sweptBallToStaticSegmentCollision)
+static Vector2 edgeHitNormal(Vector2 p1, Vector2 p2, Vector2 ballPos, Vector2 ballVel, float t) {
+    Vector2 segDir = Vector2Normalize(Vector2Subtract(p2, p1));
+    Vector2 segPerpDir = { -segDir.y, segDir.x };
+    Vector2 ballCenterAtToi = Vector2Add(ballPos, Vector2Scale(ballVel, t));
+    float distAtToi = Vector2DotProduct(Vector2Subtract(ballCenterAtToi, p1), segPerpDir);
+    Vector2 normal = Vector2Normalize(Vector2Scale(segPerpDir, distAtToi)); // From the line to the ball
+    if (Vector2LengthSqr(normal) < EPSILON2) {
+        float distToLine = Vector2DotProduct(Vector2Subtract(ballPos, p1), segPerpDir);
+        normal = (distToLine > 0) ? segPerpDir : Vector2Negate(segPerpDir);
+    }
+    return normal;
+}
+
+// Reference path: one sweptBallToStaticSegmentCollision per edge, keeping the earliest hit
+static bool sweepEdgesOneByOne(const Vector2* vertices, int vertexCount,
+                               Vector2 ballPos, Vector2 ballVel, float ballRadius,
+                               float dt_max, float* toi, Vector2* normal) {
+    bool collided = false;
+    float minToi = dt_max + EPSILON2;
+    for (int i = 0; i < vertexCount; i++) {
+        float edgeToi;
+        Vector2 edgeNormal;
+        if (sweptBallToStaticSegmentCollision(vertices[i], vertices[(i + 1) % vertexCount],
+                                              ballPos, ballVel, ballRadius, dt_max, &edgeToi, &edgeNormal) &&
+            edgeToi < minToi) {
+            minToi = edgeToi;
+            *normal = edgeNormal;
+            collided = true;
+        }
+    }
+    if (collided) *toi = minToi;
+    return collided;
+}
+
+// Swept collision: ball moving towards the edges of a static closed polygon
+// (edges vertices[i] -> vertices[i + 1], the last one back to vertices[0]).
+// Returns the earliest time of impact within dt_max and the normal from the polygon to the ball,
+// the same hit as sweptBallToStaticSegmentCollision on every edge in order (sweepEdgesOneByOne).
+bool sweptBallToStaticPolygonCollision(const Vector2* vertices, int vertexCount,
+                                       Vector2 ballPos, Vector2 ballVel, float ballRadius,
+                                       float dt_max, float* toi, Vector2* normal) {
+    if (vertexCount <= 0) return false;
+
+    SweepBall ball = { ballPos.x, ballPos.y, ballVel.x, ballVel.y, ballRadius,
+                       Vector2DotProduct(ballVel, ballVel), dt_max };
+    if (ball.a < EPSILON2 || vertexCount > SWEEP_MAX_VERTICES) {
+        // (Almost) not moving, only resting contacts are possible (or a huge polygon): per-edge tests
+        return sweepEdgesOneByOne(vertices, vertexCount, ballPos, ballVel, ballRadius, dt_max, toi, normal);
+    }
+
+    // 1. Times of impact of every vertex and edge, 4 at a time
+    float tVertex[SWEEP_MAX_VERTICES], tEdge[SWEEP_MAX_VERTICES];
+    for (int first = 0; first < vertexCount; first += SWEEP_LANES) {
+        SweepBatch batch;
+        for (int l = 0; l < SWEEP_LANES; l++) {
+            // Lanes past the end repeat the first vertex of the batch, their results are ignored
+            int i = (first + l < vertexCount) ? first + l : first;
+            Vector2 end = vertices[(i + 1) % vertexCount];
+            batch.px[l] = vertices[i].x;
+            batch.py[l] = vertices[i].y;
+            batch.ex[l] = end.x;
+            batch.ey[l] = end.y;
+        }
+        float batchVertex[SWEEP_LANES], batchEdge[SWEEP_LANES];
+        sweepBatch(&batch, &ball, batchVertex, batchEdge);
+        for (int l = 0; l < SWEEP_LANES && first + l < vertexCount; l++) {
+            tVertex[first + l] = batchVertex[l];
+            tEdge[first + l] = batchEdge[l];
+        }
+    }
+
+    // 2. Earliest hit, picked edge by edge exactly like the per-edge tests: first vertex, second
+    // vertex, then the inside of the edge, each one only if strictly earlier (vertex times are
+    // clamped to 0, as sweptBallToStaticPointCollision returns them)
+    float bestToi = dt_max + EPSILON2;
+    float bestRawT = 0.0f;
+    int bestIndex = -1;
+    bool bestIsVertex = false;
+    for (int i = 0; i < vertexCount; i++) {
+        int next = (i + 1) % vertexCount;
+        float edgeMin = dt_max + EPSILON2;
+        int edgeIndex = -1;
+        bool edgeIsVertex = false;
+        if (tVertex[i] < SWEEP_NO_HIT && fmaxf(0.0f, tVertex[i]) < edgeMin) {
+            edgeMin = fmaxf(0.0f, tVertex[i]);
+            edgeIndex = i;
+            edgeIsVertex = true;
+        }
+        if (tVertex[next] < SWEEP_NO_HIT && fmaxf(0.0f, tVertex[next]) < edgeMin) {
+            edgeMin = fmaxf(0.0f, tVertex[next]);
+            edgeIndex = next;
+            edgeIsVertex = true;
+        }
+        if (tEdge[i] < SWEEP_NO_HIT && tEdge[i] < edgeMin) {
+            edgeMin = tEdge[i];
+            edgeIndex = i;
+            edgeIsVertex = false;
+        }
+        if (edgeIndex >= 0 && fmaxf(0.0f, edgeMin) < bestToi) {
+            bestToi = fmaxf(0.0f, edgeMin);
+            bestRawT = edgeMin;
+            bestIndex = edgeIndex;
+            bestIsVertex = edgeIsVertex;
+        }
+    }
+    if (bestIndex < 0) return false;
+
+    *toi = bestToi;
+    if (bestIsVertex) {
+        *normal = vertexHitNormal(vertices[bestIndex], ballPos, ballVel, bestToi);
+    } else {
+        *normal = edgeHitNormal(vertices[bestIndex], vertices[(bestIndex + 1) % vertexCount], ballPos, ballVel, bestRawT);
+    }
+    if (Vector2LengthSqr(*normal) < EPSILON2) { // Safety for zero normal
+        *normal = Vector2Normalize(Vector2Negate(ballVel));
+        if (Vector2LengthSqr(*normal) < EPSILON2) *normal = (Vector2){0, -1};
+    }
+    return true;
+}
@@ -0,0 +1,78 @@
+#include "../include/common.h"
+#include <stdlib.h> // For malloc, realloc, free
+
+// --- Fixed-size object pool ---
+//
+// Objects are carved out of slabs of `objectsPerSlab` objects. Freed objects are pushed
+// on an intrusive free list (the first bytes of a free object hold the next pointer),
+// so once enough slabs exist, allocation and release never call the system allocator.
+// Slabs are only given back by freeObjectPool.
+
+#define POOL_ALIGNMENT 16
+
+void initObjectPool(ObjectPool* pool, size_t objectSize, int objectsPerSlab) {
+    *pool = (ObjectPool)OBJECT_POOL_INIT(objectSize, objectsPerSlab);
+}
+
+// Free every slab. All objects of the pool become invalid; counters are kept.
+void freeObjectPool(ObjectPool* pool) {
+    for (int i = 0; i < pool->slabCount; i++) {
+        free(pool->slabs[i]);
+    }
+    free(pool->slabs);
+    pool->slabs = NULL;
+    pool->slabCount = 0;
+    pool->slabCapacity = 0;
+    pool->freeList = NULL;
+    pool->liveCount = 0;
+}
+
+// Allocate a new slab and push all of its objects on the free list
+static bool addSlab(ObjectPool* pool) {
+    if (pool->stride == 0) {
+        size_t size = (pool->objectSize > sizeof(void*)) ? pool->objectSize : sizeof(void*);
+        pool->stride = (size + POOL_ALIGNMENT - 1) & ~(size_t)(POOL_ALIGNMENT - 1);
+    }
+    if (pool->slabCount >= pool->slabCapacity) {
+        int newCapacity = (pool->slabCapacity > 0) ? pool->slabCapacity * 2 : 8;
+        void** newSlabs = (void**)realloc(pool->slabs, (size_t)newCapacity * sizeof(void*));
+        if (!newSlabs) return false;
+        pool->slabs = newSlabs;
+        pool->slabCapacity = newCapacity;
+        pool->systemAllocCount++;
+    }
+
+    char* slab = (char*)malloc(pool->stride * (size_t)pool->objectsPerSlab);
+    if (!slab) return false;
+    pool->slabs[pool->slabCount++] = slab;
+    pool->systemAllocCount++;
+
+    // Push in reverse so objects are handed out in address order
+    for (int i = pool->objectsPerSlab - 1; i >= 0; i--) {
+        void* object = slab + (size_t)i * pool->stride;
+        *(void**)object = pool->freeList;
+        pool->freeList = object;
+    }
+    return true;
+}
+
+// Take an object from the pool (contents are undefined), NULL if out of memory
+void* poolAlloc(ObjectPool* pool) {
+    if (!pool->freeList && !addSlab(pool)) return NULL;
+
+    void* object = pool->freeList;
+    pool->freeList = *(void**)object;
+    pool->liveCount++;
+    if (pool->liveCount > pool->peakLiveCount) pool->peakLiveCount = pool->liveCount;
+    pool->allocCount++;
+    return object;
+}
+
+// Give an object back to the pool it was allocated from
+void poolFree(ObjectPool* pool, void* object) {
+    if (!object) return;
+    *(void**)object = pool->freeList;
+    pool->freeList = object;
+    pool->liveCount--;
+    pool->freeCount++;
+}
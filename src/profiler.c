@@ -0,0 +1,265 @@
+#include "../include/common.h"
+#include <stdio.h>  // For fopen, fprintf
+#include <time.h>   // For clock_gettime
+
+// --- Frame profiler ---
+//
+// Scopes opened with profileBegin and closed with profileEnd are timed on the main thread and
+// recorded as markers of the current frame (between profileBeginFrame and profileEndFrame), with
+// their nesting depth. The last PROFILER_FRAME_COUNT frames are kept in a ring buffer, for the
+// overlay graph and the CSV / Chrome trace dumps. Work done on the worker threads is timed there
+// and added afterwards: the longest thread as a scope (profileAddScope), which keeps the markers
+// nested in wall-clock time, and the sum over the threads as a separate counter
+// (profileAddThreadTime).
+// Disabled, or outside of a frame (benchmarks), every call returns at once.
+
+typedef struct {
+    const char* name;
+    Color color;
+    bool stacked;  // Drawn as a slice of the frame bars (the other phases contain stacked ones)
+    bool threaded; // Run on the thread pool: its time summed over the threads is exported too
+} ProfilePhaseInfo;
+
+static const ProfilePhaseInfo phaseInfo[PROFILE_PHASE_COUNT] = {
+    [PROFILE_STEP]              = { "step",              LIGHTGRAY, false, false },
+    [PROFILE_UPDATE_OBJECTS]    = { "update objects",    SKYBLUE,   true,  false },
+    [PROFILE_BALL_VS_OBJECTS]   = { "ball vs objects",   ORANGE,    true,  false },
+    [PROFILE_SCREEN_BOUNDARIES] = { "screen boundaries", GOLD,      false, true },
+    [PROFILE_BALL_VS_BALL]      = { "ball vs ball",      RED,       true,  false },
+    [PROFILE_REMOVE_MARKED]     = { "deletion sweep",    VIOLET,    true,  false },
+    [PROFILE_SLEEP]             = { "sleeping balls",    BEIGE,     true,  false },
+    [PROFILE_RENDER]            = { "render",            LIME,      true,  false },
+};
+
+static ProfileFrame frames[PROFILER_FRAME_COUNT];
+static long long recordedFrames = 0; // Complete frames recorded since the profiler was enabled
+static bool enabled = false;
+static bool inFrame = false;
+
+// Scopes open in the current frame
+static int openPhase[PROFILER_MAX_DEPTH];
+static int openMarker[PROFILER_MAX_DEPTH]; // Index in the frame's markers, -1 if they were full
+static double openStart[PROFILER_MAX_DEPTH];
+static int depth = 0;
+
+static ProfileFrame* currentFrame(void) {
+    return &frames[recordedFrames % PROFILER_FRAME_COUNT];
+}
+
+double profileNow(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+}
+
+// Enabling starts a new recording (the frames recorded before are dropped)
+void setProfilerEnabled(bool enable) {
+    if (enable && !enabled) recordedFrames = 0;
+    enabled = enable;
+    inFrame = false;
+    depth = 0;
+}
+
+bool isProfilerRecording(void) {
+    return enabled && inFrame;
+}
+
+void profileBeginFrame(void) {
+    if (!enabled) return;
+    ProfileFrame* frame = currentFrame();
+    frame->startTime = profileNow();
+    frame->duration = 0.0f;
+    for (int p = 0; p < PROFILE_PHASE_COUNT; p++) {
+        frame->phaseTime[p] = 0.0f;
+        frame->threadTime[p] = 0.0f;
+    }
+    frame->markerCount = 0;
+    depth = 0;
+    inFrame = true;
+}
+
+void profileEndFrame(void) {
+    if (!isProfilerRecording()) return;
+    ProfileFrame* frame = currentFrame();
+    frame->duration = (float)(profileNow() - frame->startTime);
+    recordedFrames++;
+    inFrame = false;
+}
+
+void profileBegin(ProfilePhase phase) {
+    if (!isProfilerRecording() || depth >= PROFILER_MAX_DEPTH) return;
+    ProfileFrame* frame = currentFrame();
+    double now = profileNow();
+    int marker = -1;
+    if (frame->markerCount < PROFILER_MAX_MARKERS) {
+        marker = frame->markerCount++;
+        frame->markers[marker] = (ProfileMarker){ (uint8_t)phase, (uint8_t)depth, (float)(now - frame->startTime), 0.0f };
+    }
+    openPhase[depth] = phase;
+    openMarker[depth] = marker;
+    openStart[depth] = now;
+    depth++;
+}
+
+// Closes the innermost scope, which must be `phase` (otherwise nothing is recorded)
+void profileEnd(ProfilePhase phase) {
+    if (!isProfilerRecording() || depth == 0 || openPhase[depth - 1] != (int)phase) return;
+    depth--;
+    ProfileFrame* frame = currentFrame();
+    double now = profileNow();
+    frame->phaseTime[phase] += (float)(now - openStart[depth]);
+    if (openMarker[depth] >= 0) frame->markers[openMarker[depth]].end = (float)(now - frame->startTime);
+}
+
+// Scope timed elsewhere (e.g. on a worker thread) from profileNow times, recorded inside the
+// innermost open scope. It is clamped to that scope, so the markers stay nested.
+void profileAddScope(ProfilePhase phase, double start, double end) {
+    if (!isProfilerRecording()) return;
+    ProfileFrame* frame = currentFrame();
+    double parentStart = (depth > 0) ? openStart[depth - 1] : frame->startTime;
+    double now = profileNow();
+    if (start < parentStart) start = parentStart;
+    if (end > now) end = now;
+    if (end < start) end = start;
+
+    frame->phaseTime[phase] += (float)(end - start);
+    if (frame->markerCount < PROFILER_MAX_MARKERS) {
+        frame->markers[frame->markerCount++] = (ProfileMarker){ (uint8_t)phase, (uint8_t)depth,
+            (float)(start - frame->startTime), (float)(end - frame->startTime) };
+    }
+}
+
+// Time of a phase summed over the threads which ran it. Kept apart from the phase time, which
+// is wall-clock time: with several threads the sum can exceed the scope around the phase.
+void profileAddThreadTime(ProfilePhase phase, double seconds) {
+    if (!isProfilerRecording()) return;
+    currentFrame()->threadTime[phase] += (float)seconds;
+}
+
+const char* getProfilePhaseName(ProfilePhase phase) {
+    return phaseInfo[phase].name;
+}
+
+int getProfileFrameCount(void) {
+    return (recordedFrames < PROFILER_FRAME_COUNT) ? (int)recordedFrames : PROFILER_FRAME_COUNT;
+}
+
+const ProfileFrame* getProfileFrame(int framesAgo) {
+    if (framesAgo < 0 || framesAgo >= getProfileFrameCount()) return NULL;
+    return &frames[(recordedFrames - 1 - framesAgo) % PROFILER_FRAME_COUNT];
+}
+
+double getProfilePhaseAverage(ProfilePhase phase) {
+    int count = getProfileFrameCount();
+    if (count == 0) return 0.0;
+    double total = 0.0;
+    for (int f = 0; f < count; f++) total += getProfileFrame(f)->phaseTime[phase];
+    return total / count;
+}
+
+static void writeColumnName(FILE* file, ProfilePhase phase, const char* suffix) {
+    fputc(',', file);
+    for (const char* c = phaseInfo[phase].name; *c; c++) fputc(*c == ' ' ? '_' : *c, file); // update_objects_ms...
+    fprintf(file, "%s", suffix);
+}
+
+// One line per frame, oldest first: frame duration and time of every phase, then the time of
+// the threaded phases summed over the threads, in milliseconds
+bool writeProfileCSV(const char* path) {
+    FILE* file = fopen(path, "w");
+    if (!file) return false;
+    fprintf(file, "frame,start_ms,frame_ms");
+    for (int p = 0; p < PROFILE_PHASE_COUNT; p++) writeColumnName(file, (ProfilePhase)p, "_ms");
+    for (int p = 0; p < PROFILE_PHASE_COUNT; p++) {
+        if (phaseInfo[p].threaded) writeColumnName(file, (ProfilePhase)p, "_thread_sum_ms");
+    }
+    fprintf(file, "\n");
+
+    int count = getProfileFrameCount();
+    const ProfileFrame* first = getProfileFrame(count - 1);
+    for (int f = count - 1; f >= 0; f--) {
+        const ProfileFrame* frame = getProfileFrame(f);
+        fprintf(file, "%lld,%.3f,%.3f", recordedFrames - 1 - f, (frame->startTime - first->startTime) * 1000.0,
+                frame->duration * 1000.0);
+        for (int p = 0; p < PROFILE_PHASE_COUNT; p++) fprintf(file, ",%.4f", frame->phaseTime[p] * 1000.0);
+        for (int p = 0; p < PROFILE_PHASE_COUNT; p++) {
+            if (phaseInfo[p].threaded) fprintf(file, ",%.4f", frame->threadTime[p] * 1000.0);
+        }
+        fprintf(file, "\n");
+    }
+    return fclose(file) == 0;
+}
+
+// Chrome trace event format: one complete event ("ph":"X") per frame and per marker, in
+// microseconds from the oldest frame. Markers of the same frame are nested by their times.
+// The thread sums of the threaded phases are counters ("ph":"C"), one value per frame.
+bool writeProfileTrace(const char* path) {
+    FILE* file = fopen(path, "w");
+    if (!file) return false;
+    fprintf(file, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n");
+
+    int count = getProfileFrameCount();
+    const ProfileFrame* first = getProfileFrame(count - 1);
+    bool firstEvent = true;
+    for (int f = count - 1; f >= 0; f--) {
+        const ProfileFrame* frame = getProfileFrame(f);
+        double frameStart = (frame->startTime - first->startTime) * 1e6;
+        fprintf(file, "%s{\"name\":\"frame %lld\",\"ph\":\"X\",\"pid\":1,\"tid\":1,\"ts\":%.3f,\"dur\":%.3f}",
+                firstEvent ? "" : ",\n", recordedFrames - 1 - f, frameStart, frame->duration * 1e6);
+        firstEvent = false;
+        for (int m = 0; m < frame->markerCount; m++) {
+            const ProfileMarker* marker = &frame->markers[m];
+            if (marker->end < marker->start) continue; // Still open when the frame ended
+            fprintf(file, ",\n{\"name\":\"%s\",\"ph\":\"X\",\"pid\":1,\"tid\":1,\"ts\":%.3f,\"dur\":%.3f}",
+                    phaseInfo[marker->phase].name, frameStart + marker->start * 1e6,
+                    (marker->end - marker->start) * 1e6);
+        }
+        for (int p = 0; p < PROFILE_PHASE_COUNT; p++) {
+            if (!phaseInfo[p].threaded) continue;
+            fprintf(file, ",\n{\"name\":\"%s (sum over threads)\",\"ph\":\"C\",\"pid\":1,\"ts\":%.3f,\"args\":{\"ms\":%.4f}}",
+                    phaseInfo[p].name, frameStart, frame->threadTime[p] * 1000.0);
+        }
+    }
+    fprintf(file, "\n]}\n");
+    return fclose(file) == 0;
+}
+
+// Bars of the recorded frames, newest on the right, each stacked with the time of its phases,
+// against a line at frameBudget seconds (the graph is two budgets high); then the legend with
+// the average time of every phase
+void drawProfilerOverlay(Rectangle bounds, float frameBudget) {
+#ifndef HEADLESS
+    const int legendHeight = 16 * PROFILE_PHASE_COUNT + 8;
+    Rectangle graph = { bounds.x, bounds.y, bounds.width, bounds.height - legendHeight };
+    DrawRectangleRec(bounds, Fade(BLACK, 0.6f));
+
+    float scale = graph.height / (2.0f * frameBudget); // Pixels per second
+    float barWidth = graph.width / PROFILER_FRAME_COUNT;
+    int count = getProfileFrameCount();
+    for (int f = 0; f < count; f++) {
+        const ProfileFrame* frame = getProfileFrame(f);
+        float x = graph.x + graph.width - (f + 1) * barWidth;
+        float y = graph.y + graph.height;
+        for (int p = 0; p < PROFILE_PHASE_COUNT; p++) {
+            if (!phaseInfo[p].stacked) continue;
+            float height = fminf(frame->phaseTime[p] * scale, y - graph.y);
+            y -= height;
+            DrawRectangleRec((Rectangle){ x, y, fmaxf(barWidth, 1.0f), height }, phaseInfo[p].color);
+        }
+    }
+    float budgetY = graph.y + graph.height - frameBudget * scale;
+    DrawLine((int)graph.x, (int)budgetY, (int)(graph.x + graph.width), (int)budgetY, WHITE);
+    DrawText(TextFormat("%.1f ms", frameBudget * 1000.0f), (int)graph.x + 4, (int)budgetY - 12, 10, WHITE);
+
+    int textY = (int)(graph.y + graph.height) + 6;
+    for (int p = 0; p < PROFILE_PHASE_COUNT; p++) {
+        DrawRectangle((int)bounds.x + 6, textY + 2, 10, 10, phaseInfo[p].color);
+        DrawText(TextFormat("%-18s %6.2f ms", phaseInfo[p].name, getProfilePhaseAverage((ProfilePhase)p) * 1000.0),
+                 (int)bounds.x + 22, textY, 12, WHITE);
+        textY += 16;
+    }
+#else
+    (void)bounds;
+    (void)frameBudget;
+#endif
+}
@@ -0,0 +1,150 @@
+#include "../include/common.h"
+#include <stdio.h>  // For fopen, fwrite, fread, snprintf
+#include <stdlib.h> // For realloc, free
+#include <string.h> // For memcmp, memcpy
+
+// --- Input recording and replay ---
+//
+// A game session only depends on its seed, its scene and what the player did each frame: the
+// frame time, the time multiplier, where the mouse was and which spawn inputs were held. The game
+// records one ReplayFrame per frame and feeds it to applyReplayFrame, which is the only way
+// its input reaches the simulation; the headless binary feeds the recorded frames to the
+// same function as fast as it can, from the same seed and scene, and gets the same world.
+// The state hash saved with the replay tells whether it did.
+
+#define REPLAY_MAGIC "BBREPLY"         // 8 bytes with the terminating zero
+#define REPLAY_BYTE_ORDER 0x01020304u
+
+typedef struct {
+    char magic[8];
+    uint32_t version;
+    uint32_t byteOrder;
+    uint32_t seed;
+    int32_t frameCount;
+    uint64_t stateHash;
+    int64_t steps;
+    char scene[REPLAY_SCENE_PATH_MAX];
+} ReplayHeader;
+
+// scene: scene file the world is built from, NULL for the game's arc scene
+void initReplay(Replay* replay, uint32_t seed, const char* scene) {
+    *replay = (Replay){0};
+    replay->seed = seed;
+    if (scene) snprintf(replay->scene, sizeof(replay->scene), "%s", scene);
+}
+
+void freeReplay(Replay* replay) {
+    free(replay->frames);
+    initReplay(replay, 0, NULL);
+}
+
+bool recordReplayFrame(Replay* replay, const ReplayFrame* frame) {
+    if (replay->frameCount >= replay->frameCapacity) {
+        int newCapacity = (replay->frameCapacity > 0) ? replay->frameCapacity * 2 : 1024;
+        ReplayFrame* newFrames = (ReplayFrame*)realloc(replay->frames, (size_t)newCapacity * sizeof(ReplayFrame));
+        if (!newFrames) return false;
+        replay->frames = newFrames;
+        replay->frameCapacity = newCapacity;
+    }
+    replay->frames[replay->frameCount++] = *frame;
+    return true;
+}
+
+// Apply the input of one frame: spawn the balls it asks for, then advance the world by its
+// frame time. Returns the number of steps taken (see advanceSimulation).
+int applyReplayFrame(Simulation* sim, const ReplayFrame* frame) {
+    bool spawn = (frame->input & (REPLAY_INPUT_LEFT_PRESSED | REPLAY_INPUT_SPACE_DOWN)) != 0;
+    if (spawn && !(frame->input & REPLAY_INPUT_OVER_CONTROLS)) {
+        int repetition = (frame->input & REPLAY_INPUT_RIGHT_DOWN) ? REPLAY_SPAWN_BURST : 1;
+        for (int i = 0; i < repetition; i++) {
+            spawnRandomBall(sim, frame->mouse);
+        }
+    }
+    return advanceSimulation(sim, frame->frameTime * frame->timeMultiplier);
+}
+
+// FNV-1a over the bytes of an array
+static uint64_t hashBytes(uint64_t hash, const void* data, size_t size) {
+    const unsigned char* bytes = (const unsigned char*)data;
+    for (size_t i = 0; i < size; i++) {
+        hash ^= bytes[i];
+        hash *= 1099511628211ull;
+    }
+    return hash;
+}
+
+// Hash of everything a replay must reproduce: the steps taken, the random state, the objects
+// left and every ball, bit for bit
+uint64_t hashSimulationState(const Simulation* sim) {
+    const BallStore* balls = &sim->balls;
+    size_t n = (size_t)balls->count;
+    int32_t objectCount = 0;
+    for (const GameObject* obj = sim->objects; obj != NULL; obj = obj->next) objectCount++;
+
+    uint64_t hash = 14695981039346656037ull;
+    hash = hashBytes(hash, &sim->frame, sizeof(sim->frame));
+    hash = hashBytes(hash, &sim->rngState, sizeof(sim->rngState));
+    hash = hashBytes(hash, &objectCount, sizeof(objectCount));
+    hash = hashBytes(hash, &balls->count, sizeof(balls->count));
+    hash = hashBytes(hash, balls->posX, n * sizeof(float));
+    hash = hashBytes(hash, balls->posY, n * sizeof(float));
+    hash = hashBytes(hash, balls->velX, n * sizeof(float));
+    hash = hashBytes(hash, balls->velY, n * sizeof(float));
+    hash = hashBytes(hash, balls->radius, n * sizeof(float));
+    hash = hashBytes(hash, balls->flags, n * sizeof(uint8_t));
+    return hash;
+}
+
+// Write the frames recorded so far, with the seed and the hash of `sim`, the world they led to
+bool saveReplay(const Replay* replay, const Simulation* sim, const char* path) {
+    FILE* file = fopen(path, "wb");
+    if (!file) return false;
+    ReplayHeader header = {
+        .magic = REPLAY_MAGIC,
+        .version = REPLAY_VERSION,
+        .byteOrder = REPLAY_BYTE_ORDER,
+        .seed = replay->seed,
+        .frameCount = replay->frameCount,
+        .stateHash = hashSimulationState(sim),
+        .steps = sim->frame,
+    };
+    memcpy(header.scene, replay->scene, sizeof(header.scene));
+    bool ok = fwrite(&header, sizeof(header), 1, file) == 1;
+    if (ok && replay->frameCount > 0) {
+        ok = fwrite(replay->frames, sizeof(ReplayFrame), (size_t)replay->frameCount, file) == (size_t)replay->frameCount;
+    }
+    bool closed = fclose(file) == 0;
+    return ok && closed;
+}
+
+// Read a replay written by saveReplay into `replay` (freed first). Returns false if the file
+// can't be read or isn't a replay of this version.
+bool loadReplay(Replay* replay, const char* path) {
+    FILE* file = fopen(path, "rb");
+    if (!file) return false;
+    ReplayHeader header;
+    bool ok = fread(&header, sizeof(header), 1, file) == 1 &&
+              memcmp(header.magic, REPLAY_MAGIC, sizeof(header.magic)) == 0 &&
+              header.version == REPLAY_VERSION && header.byteOrder == REPLAY_BYTE_ORDER && header.frameCount >= 0;
+
+    ReplayFrame* frames = NULL;
+    if (ok && header.frameCount > 0) {
+        frames = (ReplayFrame*)malloc((size_t)header.frameCount * sizeof(ReplayFrame));
+        ok = frames && fread(frames, sizeof(ReplayFrame), (size_t)header.frameCount, file) == (size_t)header.frameCount;
+    }
+    fclose(file);
+    if (!ok) {
+        free(frames);
+        return false;
+    }
+
+    freeReplay(replay);
+    replay->seed = header.seed;
+    memcpy(replay->scene, header.scene, sizeof(replay->scene));
+    replay->scene[sizeof(replay->scene) - 1] = '\0';
+    replay->frames = frames;
+    replay->frameCount = replay->frameCapacity = header.frameCount;
+    replay->stateHash = header.stateHash;
+    replay->steps = header.steps;
+    return true;
+}
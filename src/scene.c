@@ -0,0 +1,512 @@
+#include "../include/common.h"
+#include <stdio.h>  // For fopen, fgets, fprintf
+#include <stdlib.h> // For strtof, strtol
+#include <string.h> // For strcmp, strchr
+#include <ctype.h>  // For isspace, tolower
+#include <math.h>   // For isfinite, fabsf
+
+// --- Scene files ---
+//
+// Text files of [sections] holding "key = value" lines; '#' and ';' start a comment.
+//
+//   [scene]      seed, mode (substeps or events), max_substeps, sleep_steps
+//   [rectangle]  position, velocity, size (width height), color, static, repeat, spacing
+//   [diamond]    the same, size being the two diagonals
+//   [arc]        position, velocity, radius, angles (start end), thickness, color, static,
+//                rotation_speed, remove_escaped, swept, on_escape (remove_arc), repeat, spacing,
+//                rings, radius_step, speed_step (rings nested arcs, each larger and faster; no
+//                ring may turn faster than SCENE_MAX_ROTATION_SPEED)
+//   [emitter]    position, rate (balls per step), count (-1: no limit), speed, angle, radius,
+//                mass (each "min max" or a single value), restitution, color, interact
+//   [effect]     type (color_change, velocity_boost, velocity_dampen, size_change, disappear,
+//                spawn), continuous, color, factor, particles, position, radius; added to
+//                every object of the last object section, or to the balls of the last emitter.
+//                applyEffects doesn't apply disappear when it is an object's effect, nor spawn
+//                at all, so these are refused rather than silently doing nothing.
+//
+// Vectors and ranges are finite numbers separated by spaces; colors are a raylib name (red,
+// skyblue...) or "r g b [a]". repeat = "columns rows" copies an object section on a grid of
+// `spacing`.
+//
+// The file is read one line at a time and each section is built as soon as the next one
+// starts: objects and effects go straight from the parser into their pools and the world,
+// and nothing but the current section is kept.
+
+#define SCENE_LINE_MAX 512
+#define SCENE_MAX_ROTATION_SPEED 3600.0f // Degrees per second, ten turns
+
+// Prototypes for functions in objects.c
+GameObject* createRectangleObject(Vector2 position, Vector2 velocity, float width, float height, Color color, bool isStatic);
+GameObject* createDiamondObject(Vector2 position, Vector2 velocity, float diagWidth, float diagHeight, Color color, bool isStatic);
+GameObject* createArcCircleObject(Vector2 position, Vector2 velocity, float radius, float startAngle, float endAngle, float thickness, Color color, bool isStatic, float rotationSpeed, bool removeEscapedBalls);
+
+typedef enum {
+    SECTION_NONE,
+    SECTION_SCENE,
+    SECTION_RECTANGLE,
+    SECTION_DIAMOND,
+    SECTION_ARC,
+    SECTION_EMITTER,
+    SECTION_EFFECT
+} SceneSection;
+
+// Values of the section being read (the keys of every kind of section, with their defaults)
+typedef struct {
+    SceneSection section;
+    int line;                  // Line of the section header
+
+    // [scene]
+    bool hasSeed;
+    uint32_t seed;
+    int mode, maxSubsteps, sleepSteps; // -1: unchanged
+
+    // Objects
+    Vector2 position, velocity, size, spacing;
+    Color color;
+    bool isStatic;
+    int repeatX, repeatY;
+
+    // [arc]
+    float radius, startAngle, endAngle, thickness, rotationSpeed;
+    bool removeEscapedBalls, sweptRotation, removeOnEscape;
+    int rings;
+    float radiusStep, speedStep;
+
+    // [emitter]
+    BallEmitter emitter;
+
+    // [effect]
+    bool hasEffectType;
+    EffectType effectType;
+    bool continuous;
+    float factor;
+    int particles;
+} SceneValues;
+
+typedef struct {
+    const char* path;
+    int line;
+    Simulation* sim;
+    SceneValues values;
+    int lastObjectCount;  // Objects built by the last object section (the first ones of sim->objects)
+    int lastEmitter;      // Emitter built by the last emitter section, -1 if none
+} SceneParser;
+
+typedef struct {
+    const char* name;
+    Color color;
+} NamedColor;
+
+static const NamedColor namedColors[] = {
+    { "lightgray", LIGHTGRAY }, { "gray", GRAY }, { "darkgray", DARKGRAY }, { "yellow", YELLOW },
+    { "gold", GOLD }, { "orange", ORANGE }, { "pink", PINK }, { "red", RED }, { "maroon", MAROON },
+    { "green", GREEN }, { "lime", LIME }, { "darkgreen", DARKGREEN }, { "skyblue", SKYBLUE },
+    { "blue", BLUE }, { "darkblue", DARKBLUE }, { "purple", PURPLE }, { "violet", VIOLET },
+    { "darkpurple", DARKPURPLE }, { "beige", BEIGE }, { "brown", BROWN }, { "darkbrown", DARKBROWN },
+    { "white", WHITE }, { "black", BLACK }, { "magenta", MAGENTA }, { "raywhite", RAYWHITE },
+};
+
+static bool sceneError(const SceneParser* parser, const char* message, const char* detail) {
+    fprintf(stderr, "%s:%d: %s%s%s\n", parser->path, parser->line, message, detail ? ": " : "", detail ? detail : "");
+    return false;
+}
+
+static void resetSceneValues(SceneValues* v, SceneSection section, int line) {
+    *v = (SceneValues){
+        .section = section,
+        .line = line,
+        .mode = -1, .maxSubsteps = -1, .sleepSteps = -1,
+        .position = { SCREEN_WIDTH * 0.5f, SCREEN_HEIGHT * 0.5f },
+        .size = { 40.0f, 40.0f },
+        .color = WHITE,
+        .isStatic = true,
+        .repeatX = 1, .repeatY = 1,
+        .radius = 100.0f, .startAngle = 0.0f, .endAngle = 300.0f, .thickness = 5.0f,
+        .rings = 1,
+        .emitter = {
+            .position = { SCREEN_WIDTH * 0.5f, SCREEN_HEIGHT * 0.5f },
+            .minSpeed = 100.0f, .maxSpeed = 300.0f,
+            .minAngle = 0.0f, .maxAngle = 360.0f,
+            .minRadius = 10.0f, .maxRadius = 30.0f,
+            .minMass = 0.5f, .maxMass = 3.0f,
+            .restitution = 1.0f,
+            .color = YELLOW,
+            .interactWithOtherBouncingObjects = true,
+            .rate = 1,
+            .remaining = -1,
+        },
+        .factor = 1.0f,
+        .particles = 10,
+    };
+}
+
+// --- Values ---
+
+// Read between minCount and maxCount numbers; returns how many, 0 on error
+static int parseFloats(const char* text, float* out, int minCount, int maxCount) {
+    int count = 0;
+    const char* p = text;
+    while (*p) {
+        while (isspace((unsigned char)*p)) p++;
+        if (!*p) break;
+        if (count == maxCount) return 0;
+        char* end;
+        out[count] = strtof(p, &end);
+        if (end == p || !isfinite(out[count])) return 0; // Also refuses inf, nan and overflows
+        count++;
+        p = end;
+    }
+    return (count >= minCount) ? count : 0;
+}
+
+static bool parseFloat(const char* text, float* out) {
+    return parseFloats(text, out, 1, 1) == 1;
+}
+
+static bool parseVector(const char* text, Vector2* out) {
+    float values[2];
+    if (parseFloats(text, values, 2, 2) != 2) return false;
+    *out = (Vector2){ values[0], values[1] };
+    return true;
+}
+
+// "min max", or a single value for both
+static bool parseRange(const char* text, float* min, float* max) {
+    float values[2];
+    int count = parseFloats(text, values, 1, 2);
+    if (count == 0) return false;
+    *min = values[0];
+    *max = (count == 2) ? values[1] : values[0];
+    return true;
+}
+
+static bool parseInt(const char* text, int* out) {
+    char* end;
+    long value = strtol(text, &end, 10);
+    while (isspace((unsigned char)*end)) end++;
+    if (end == text || *end) return false;
+    *out = (int)value;
+    return true;
+}
+
+static bool parseBool(const char* text, bool* out) {
+    if (strcmp(text, "true") == 0 || strcmp(text, "yes") == 0 || strcmp(text, "1") == 0) {
+        *out = true;
+    } else if (strcmp(text, "false") == 0 || strcmp(text, "no") == 0 || strcmp(text, "0") == 0) {
+        *out = false;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+static bool parseColor(const char* text, Color* out) {
+    char name[32];
+    size_t length = strlen(text);
+    if (length < sizeof(name)) {
+        for (size_t i = 0; i <= length; i++) name[i] = (char)tolower((unsigned char)text[i]);
+        for (size_t i = 0; i < sizeof(namedColors) / sizeof(namedColors[0]); i++) {
+            if (strcmp(name, namedColors[i].name) == 0) {
+                *out = namedColors[i].color;
+                return true;
+            }
+        }
+    }
+    float values[4];
+    int count = parseFloats(text, values, 3, 4);
+    if (count == 0) return false;
+    for (int i = 0; i < count; i++) {
+        if (values[i] < 0.0f || values[i] > 255.0f) return false;
+    }
+    *out = (Color){ (unsigned char)values[0], (unsigned char)values[1], (unsigned char)values[2],
+                    (count == 4) ? (unsigned char)values[3] : 255 };
+    return true;
+}
+
+// --- Keys ---
+
+// Keys of the [scene] section
+static bool setSceneKey(SceneValues* v, const char* key, const char* value) {
+    if (strcmp(key, "seed") == 0) {
+        int seed;
+        if (!parseInt(value, &seed)) return false;
+        v->hasSeed = true;
+        v->seed = (uint32_t)seed;
+        return true;
+    }
+    if (strcmp(key, "mode") == 0) {
+        if (strcmp(value, "substeps") == 0) v->mode = SIMULATION_SUBSTEPS;
+        else if (strcmp(value, "events") == 0) v->mode = SIMULATION_EVENTS;
+        else return false;
+        return true;
+    }
+    if (strcmp(key, "max_substeps") == 0) return parseInt(value, &v->maxSubsteps) && v->maxSubsteps > 0;
+    if (strcmp(key, "sleep_steps") == 0) return parseInt(value, &v->sleepSteps) && v->sleepSteps >= 0;
+    return false;
+}
+
+// Keys shared by [rectangle], [diamond] and [arc]
+static bool setObjectKey(SceneValues* v, const char* key, const char* value) {
+    if (strcmp(key, "position") == 0) return parseVector(value, &v->position);
+    if (strcmp(key, "velocity") == 0) return parseVector(value, &v->velocity);
+    if (strcmp(key, "color") == 0) return parseColor(value, &v->color);
+    if (strcmp(key, "static") == 0) return parseBool(value, &v->isStatic);
+    if (strcmp(key, "spacing") == 0) return parseVector(value, &v->spacing);
+    if (strcmp(key, "repeat") == 0) {
+        Vector2 repeat;
+        if (!parseVector(value, &repeat) || repeat.x < 1.0f || repeat.y < 1.0f) return false;
+        v->repeatX = (int)repeat.x;
+        v->repeatY = (int)repeat.y;
+        return true;
+    }
+    if (v->section != SECTION_ARC) {
+        if (strcmp(key, "size") == 0) return parseVector(value, &v->size) && v->size.x > 0.0f && v->size.y > 0.0f;
+        return false;
+    }
+
+    if (strcmp(key, "radius") == 0) return parseFloat(value, &v->radius) && v->radius > 0.0f;
+    if (strcmp(key, "angles") == 0) return parseRange(value, &v->startAngle, &v->endAngle);
+    if (strcmp(key, "thickness") == 0) return parseFloat(value, &v->thickness) && v->thickness > 0.0f;
+    if (strcmp(key, "rotation_speed") == 0) return parseFloat(value, &v->rotationSpeed) && fabsf(v->rotationSpeed) <= SCENE_MAX_ROTATION_SPEED;
+    if (strcmp(key, "remove_escaped") == 0) return parseBool(value, &v->removeEscapedBalls);
+    if (strcmp(key, "swept") == 0) return parseBool(value, &v->sweptRotation);
+    if (strcmp(key, "on_escape") == 0) {
+        if (strcmp(value, "remove_arc") == 0) v->removeOnEscape = true;
+        else if (strcmp(value, "none") == 0) v->removeOnEscape = false;
+        else return false;
+        return true;
+    }
+    if (strcmp(key, "rings") == 0) return parseInt(value, &v->rings) && v->rings > 0;
+    if (strcmp(key, "radius_step") == 0) return parseFloat(value, &v->radiusStep);
+    if (strcmp(key, "speed_step") == 0) return parseFloat(value, &v->speedStep);
+    return false;
+}
+
+static bool setEmitterKey(SceneValues* v, const char* key, const char* value) {
+    BallEmitter* e = &v->emitter;
+    if (strcmp(key, "position") == 0) return parseVector(value, &e->position);
+    if (strcmp(key, "rate") == 0) return parseInt(value, &e->rate) && e->rate >= 0;
+    if (strcmp(key, "count") == 0) return parseInt(value, &e->remaining) && e->remaining >= -1;
+    if (strcmp(key, "speed") == 0) return parseRange(value, &e->minSpeed, &e->maxSpeed);
+    if (strcmp(key, "angle") == 0) return parseRange(value, &e->minAngle, &e->maxAngle);
+    if (strcmp(key, "radius") == 0) return parseRange(value, &e->minRadius, &e->maxRadius) && e->minRadius > 0.0f && e->maxRadius > 0.0f;
+    if (strcmp(key, "mass") == 0) return parseRange(value, &e->minMass, &e->maxMass);
+    if (strcmp(key, "restitution") == 0) return parseFloat(value, &e->restitution);
+    if (strcmp(key, "color") == 0) return parseColor(value, &e->color);
+    if (strcmp(key, "interact") == 0) return parseBool(value, &e->interactWithOtherBouncingObjects);
+    return false;
+}
+
+static bool setEffectKey(SceneValues* v, const char* key, const char* value) {
+    if (strcmp(key, "type") == 0) {
+        static const struct { const char* name; EffectType type; } types[] = {
+            { "color_change", EFFECT_COLOR_CHANGE }, { "velocity_boost", EFFECT_VELOCITY_BOOST },
+            { "velocity_dampen", EFFECT_VELOCITY_DAMPEN }, { "size_change", EFFECT_SIZE_CHANGE },
+            { "disappear", EFFECT_BALL_DISAPPEAR }, { "spawn", EFFECT_BALL_SPAWN },
+        };
+        for (size_t i = 0; i < sizeof(types) / sizeof(types[0]); i++) {
+            if (strcmp(value, types[i].name) == 0) {
+                v->hasEffectType = true;
+                v->effectType = types[i].type;
+                return true;
+            }
+        }
+        return false;
+    }
+    if (strcmp(key, "continuous") == 0) return parseBool(value, &v->continuous);
+    if (strcmp(key, "color") == 0) return parseColor(value, &v->color);
+    if (strcmp(key, "factor") == 0) return parseFloat(value, &v->factor);
+    if (strcmp(key, "particles") == 0) return parseInt(value, &v->particles) && v->particles >= 0;
+    if (strcmp(key, "position") == 0) return parseVector(value, &v->position);
+    if (strcmp(key, "radius") == 0) return parseFloat(value, &v->radius) && v->radius >= 0.0f;
+    return false;
+}
+
+// --- Building the sections ---
+
+static bool buildObjects(SceneParser* parser) {
+    SceneValues* v = &parser->values;
+    Simulation* sim = parser->sim;
+    int built = 0;
+    for (int row = 0; row < v->repeatY; row++) {
+        for (int column = 0; column < v->repeatX; column++) {
+            Vector2 position = { v->position.x + column * v->spacing.x, v->position.y + row * v->spacing.y };
+            for (int ring = 0; ring < v->rings; ring++) {
+                float rotationSpeed = v->rotationSpeed + ring * v->speedStep;
+                if (v->section == SECTION_ARC && fabsf(rotationSpeed) > SCENE_MAX_ROTATION_SPEED) {
+                    return sceneError(parser, "rotation speed of a ring out of range", NULL);
+                }
+                GameObject* obj = NULL;
+                if (v->section == SECTION_RECTANGLE) {
+                    obj = createRectangleObject(position, v->velocity, v->size.x, v->size.y, v->color, v->isStatic);
+                } else if (v->section == SECTION_DIAMOND) {
+                    obj = createDiamondObject(position, v->velocity, v->size.x, v->size.y, v->color, v->isStatic);
+                } else {
+                    obj = createArcCircleObject(position, v->velocity, v->radius + ring * v->radiusStep,
+                                                v->startAngle, v->endAngle, v->thickness, v->color, v->isStatic,
+                                                rotationSpeed, v->removeEscapedBalls);
+                    if (obj && v->sweptRotation) setArcCircleSweptRotation(obj, true);
+                    if (obj && v->removeOnEscape) {
+                        registerSnapshotCallback(removeArcOnEscape);
+                        addEscapeCallbackToArcCircle(obj, removeArcOnEscape);
+                    }
+                }
+                if (!obj || !addSimulationObject(sim, obj)) return sceneError(parser, "out of memory", NULL);
+                built++;
+            }
+        }
+    }
+    parser->lastObjectCount = built;
+    parser->lastEmitter = -1;
+    return true;
+}
+
+static CollisionEffect* createSceneEffect(const SceneValues* v) {
+    switch (v->effectType) {
+        case EFFECT_COLOR_CHANGE:    return createColorChangeEffect(v->color, v->continuous);
+        case EFFECT_VELOCITY_BOOST:  return createVelocityBoostEffect(v->factor, v->continuous);
+        case EFFECT_VELOCITY_DAMPEN: return createVelocityDampenEffect(v->factor, v->continuous);
+        case EFFECT_SIZE_CHANGE:     return createSizeChangeEffect(v->factor, v->continuous);
+        case EFFECT_BALL_DISAPPEAR:  return createBallDisappearEffect(v->particles, v->color, v->continuous);
+        case EFFECT_BALL_SPAWN:      return createBallSpawnEffect(v->position, v->radius, v->color, v->continuous);
+        case EFFECT_SOUND_PLAY:      break; // Needs a loaded Sound, not available to scene files
+    }
+    return NULL;
+}
+
+static bool buildEffect(SceneParser* parser) {
+    SceneValues* v = &parser->values;
+    if (!v->hasEffectType) return sceneError(parser, "[effect] without a type", NULL);
+    if (v->effectType == EFFECT_BALL_SPAWN) return sceneError(parser, "effect type not applied yet", "spawn");
+
+    if (parser->lastEmitter >= 0) {
+        CollisionEffect* effect = createSceneEffect(v);
+        if (!effect) return sceneError(parser, "out of memory", NULL);
+        addEffectToList(&parser->sim->emitters[parser->lastEmitter].effects, effect);
+        return true;
+    }
+    if (parser->lastObjectCount == 0) return sceneError(parser, "[effect] must follow an object or an emitter", NULL);
+    if (v->effectType == EFFECT_BALL_DISAPPEAR) return sceneError(parser, "effect type only applied to the balls of an emitter", "disappear");
+
+    // The objects of the last section are the first ones of the list (addSimulationObject prepends)
+    GameObject* obj = parser->sim->objects;
+    for (int i = 0; i < parser->lastObjectCount && obj != NULL; i++, obj = obj->next) {
+        CollisionEffect* effect = createSceneEffect(v);
+        if (!effect) return sceneError(parser, "out of memory", NULL);
+        addEffectToList(&obj->onCollisionEffects, effect);
+    }
+    return true;
+}
+
+// Build the section that was just read into the world
+static bool buildSection(SceneParser* parser) {
+    SceneValues* v = &parser->values;
+    parser->line = v->line; // Errors are reported at the section header
+    switch (v->section) {
+        case SECTION_NONE:
+            return true;
+        case SECTION_SCENE:
+            if (v->hasSeed) seedSimulation(parser->sim, v->seed);
+            if (v->mode >= 0) parser->sim->mode = (SimulationMode)v->mode;
+            if (v->maxSubsteps >= 0) parser->sim->maxSubsteps = v->maxSubsteps;
+            if (v->sleepSteps >= 0) parser->sim->sleepSteps = v->sleepSteps;
+            return true;
+        case SECTION_RECTANGLE:
+        case SECTION_DIAMOND:
+        case SECTION_ARC:
+            return buildObjects(parser);
+        case SECTION_EMITTER:
+            if (!addSimulationEmitter(parser->sim, &v->emitter)) return sceneError(parser, "out of memory", NULL);
+            parser->lastEmitter = parser->sim->emitterCount - 1;
+            parser->lastObjectCount = 0;
+            return true;
+        case SECTION_EFFECT:
+            return buildEffect(parser);
+    }
+    return true;
+}
+
+// --- Lines ---
+
+static char* trim(char* text) {
+    while (isspace((unsigned char)*text)) text++;
+    char* end = text + strlen(text);
+    while (end > text && isspace((unsigned char)end[-1])) end--;
+    *end = '\0';
+    return text;
+}
+
+static bool parseSectionHeader(SceneParser* parser, char* line) {
+    static const struct { const char* name; SceneSection section; } sections[] = {
+        { "scene", SECTION_SCENE }, { "rectangle", SECTION_RECTANGLE }, { "diamond", SECTION_DIAMOND },
+        { "arc", SECTION_ARC }, { "emitter", SECTION_EMITTER }, { "effect", SECTION_EFFECT },
+    };
+    char* close = strchr(line, ']');
+    if (!close || close[1] != '\0') return sceneError(parser, "expected [section]", line);
+    *close = '\0';
+    char* name = trim(line + 1);
+
+    for (size_t i = 0; i < sizeof(sections) / sizeof(sections[0]); i++) {
+        if (strcmp(name, sections[i].name) == 0) {
+            int line = parser->line;
+            if (!buildSection(parser)) return false;
+            resetSceneValues(&parser->values, sections[i].section, line);
+            parser->line = line;
+            return true;
+        }
+    }
+    return sceneError(parser, "unknown section", name);
+}
+
+static bool parseKeyValue(SceneParser* parser, char* line) {
+    char* equals = strchr(line, '=');
+    if (!equals) return sceneError(parser, "expected key = value", line);
+    *equals = '\0';
+    char* key = trim(line);
+    char* value = trim(equals + 1);
+
+    SceneValues* v = &parser->values;
+    bool ok = false;
+    switch (v->section) {
+        case SECTION_NONE:      return sceneError(parser, "key outside of a section", key);
+        case SECTION_SCENE:     ok = setSceneKey(v, key, value); break;
+        case SECTION_RECTANGLE:
+        case SECTION_DIAMOND:
+        case SECTION_ARC:       ok = setObjectKey(v, key, value); break;
+        case SECTION_EMITTER:   ok = setEmitterKey(v, key, value); break;
+        case SECTION_EFFECT:    ok = setEffectKey(v, key, value); break;
+    }
+    if (!ok) return sceneError(parser, "unknown key or bad value", key);
+    return true;
+}
+
+// Add the objects, emitters and effects of a scene file to the world, and apply its [scene]
+// settings. Errors are reported on stderr as "path:line: message"; the sections before the
+// error stay in the world.
+bool loadScene(Simulation* sim, const char* path) {
+    FILE* file = fopen(path, "r");
+    if (!file) {
+        fprintf(stderr, "%s: cannot open the scene file\n", path);
+        return false;
+    }
+    SceneParser parser = { .path = path, .line = 0, .sim = sim, .lastObjectCount = 0, .lastEmitter = -1 };
+    resetSceneValues(&parser.values, SECTION_NONE, 0);
+
+    bool ok = true;
+    char buffer[SCENE_LINE_MAX];
+    while (ok && fgets(buffer, sizeof(buffer), file)) {
+        parser.line++;
+        if (!strchr(buffer, '\n') && !feof(file)) {
+            ok = sceneError(&parser, "line too long", NULL);
+            break;
+        }
+        char* comment = strpbrk(buffer, "#;");
+        if (comment) *comment = '\0';
+        char* line = trim(buffer);
+        if (*line == '\0') continue;
+        ok = (*line == '[') ? parseSectionHeader(&parser, line) : parseKeyValue(&parser, line);
+    }
+    if (ok) ok = buildSection(&parser);
+    fclose(file);
+    return ok;
+}
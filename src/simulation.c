@@ -0,0 +1,271 @@
+#include "../include/common.h"
+#include <stdlib.h> // For realloc, free
+#include <math.h>   // For fmodf, cosf, sinf
+
+// --- Simulation ---
+//
+// Everything needed to advance the world by one frame, without any window or rendering,
+// so the same step runs in the game (main.c) and in the headless binary (headless.c).
+
+// Prototypes for functions in objects.c
+GameObject* createArcCircleObject(Vector2 position, Vector2 velocity, float radius, float startAngle, float endAngle, float thickness, Color color, bool isStatic, float rotationSpeed, bool removeEscapedBalls);
+void addObjectToList(GameObject** head, GameObject* newObject);
+void freeObjectList(GameObject** head);
+void freeGameObject(GameObject* obj);
+void updateObjectList(GameObject* head, float dt);
+
+// threadCount: threads used by the collision passes, 0 for one per CPU
+bool initSimulation(Simulation* sim, int threadCount) {
+    sim->objects = NULL;
+    initAABBTree(&sim->objectTree);
+    initBallStore(&sim->balls);
+    sim->mode = SIMULATION_SUBSTEPS;
+    sim->maxSubsteps = 10;
+    sim->sleepSteps = BALL_SLEEP_STEPS;
+    sim->frame = 0;
+    sim->fixedDt = SIMULATION_FIXED_DT;
+    sim->maxStepsPerFrame = SIMULATION_MAX_STEPS_PER_FRAME;
+    sim->accumulator = 0.0f;
+    sim->droppedTime = 0.0;
+    sim->emitters = NULL;
+    sim->emitterCount = 0;
+    sim->emitterCapacity = 0;
+    seedSimulation(sim, SIMULATION_DEFAULT_SEED);
+    return initThreadPool(&sim->threads, threadCount);
+}
+
+void freeSimulation(Simulation* sim) {
+    freeObjectList(&sim->objects);
+    freeAABBTree(&sim->objectTree);
+    freeBallStore(&sim->balls);
+    for (int i = 0; i < sim->emitterCount; i++) {
+        freeEffectList(&sim->emitters[i].effects);
+    }
+    free(sim->emitters);
+    sim->emitters = NULL;
+    sim->emitterCount = sim->emitterCapacity = 0;
+    freeThreadPool(&sim->threads);
+}
+
+// Add a GameObject to the world (object list and broadphase tree); the world owns it from
+// then on. The collision passes only look for objects in the tree, so an object the tree
+// can't take (out of memory) is freed instead of added, and false is returned.
+bool addSimulationObject(Simulation* sim, GameObject* obj) {
+    if (!obj) return false;
+    if (!insertObjectInTree(&sim->objectTree, obj)) {
+        freeGameObject(obj);
+        return false;
+    }
+    addObjectToList(&sim->objects, obj);
+    return true;
+}
+
+// Add a copy of an emitter to the world; the world owns its effects from then on.
+// Returns the copy, NULL if out of memory.
+BallEmitter* addSimulationEmitter(Simulation* sim, const BallEmitter* emitter) {
+    if (sim->emitterCount >= sim->emitterCapacity) {
+        int newCapacity = (sim->emitterCapacity > 0) ? sim->emitterCapacity * 2 : 8;
+        BallEmitter* newEmitters = (BallEmitter*)realloc(sim->emitters, (size_t)newCapacity * sizeof(BallEmitter));
+        if (!newEmitters) return NULL;
+        sim->emitters = newEmitters;
+        sim->emitterCapacity = newCapacity;
+    }
+    sim->emitters[sim->emitterCount] = *emitter;
+    return &sim->emitters[sim->emitterCount++];
+}
+
+// Copy of an effect list from the pool, in the same order
+static CollisionEffect* cloneEffectList(const CollisionEffect* effects) {
+    CollisionEffect* head = NULL;
+    CollisionEffect** tail = &head;
+    for (const CollisionEffect* e = effects; e != NULL; e = e->next) {
+        CollisionEffect* copy = cloneCollisionEffect(e);
+        if (!copy) break;
+        *tail = copy;
+        tail = &copy->next;
+    }
+    return head;
+}
+
+static float randomBetween(Simulation* sim, float min, float max) {
+    return min + (max - min) * simulationRandomFloat(sim);
+}
+
+// Emit this step's balls of every emitter
+static void runBallEmitters(Simulation* sim) {
+    for (int e = 0; e < sim->emitterCount; e++) {
+        BallEmitter* emitter = &sim->emitters[e];
+        for (int i = 0; i < emitter->rate && emitter->remaining != 0; i++) {
+            // One draw per statement, so the draws happen in the same order with every compiler
+            float speed = randomBetween(sim, emitter->minSpeed, emitter->maxSpeed);
+            float angle = randomBetween(sim, emitter->minAngle, emitter->maxAngle) * DEG2RAD;
+            float radius = randomBetween(sim, emitter->minRadius, emitter->maxRadius);
+            float mass = randomBetween(sim, emitter->minMass, emitter->maxMass);
+            BallHandle ball = createBouncingObject(&sim->balls, emitter->position,
+                                                   (Vector2){ cosf(angle) * speed, sinf(angle) * speed }, radius,
+                                                   emitter->color, mass, emitter->restitution,
+                                                   emitter->interactWithOtherBouncingObjects);
+            if (emitter->effects && getBallIndex(&sim->balls, ball) >= 0) {
+                addCollisionEffectsToBouncingObject(&sim->balls, ball, cloneEffectList(emitter->effects));
+            }
+            if (emitter->remaining > 0) emitter->remaining--;
+        }
+    }
+}
+
+// Advance the world by dt seconds
+void stepSimulation(Simulation* sim, float dt) {
+    profileBegin(PROFILE_STEP);
+
+    // New balls from the emitters (scene files)
+    runBallEmitters(sim);
+
+    // Remember where the balls were, for interpolated rendering
+    saveBallPositions(&sim->balls);
+
+    // Update all static objects (especially important for rotating objects like arcCircle)
+    profileBegin(PROFILE_UPDATE_OBJECTS);
+    updateObjectList(sim->objects, dt);
+    profileEnd(PROFILE_UPDATE_OBJECTS);
+
+    if (sim->mode == SIMULATION_EVENTS) {
+        // Collisions with the objects, the screen boundaries and between bouncing objects,
+        // one at a time in time order
+        profileBegin(PROFILE_BALL_VS_OBJECTS);
+        handleEventDrivenCollisions(&sim->balls, sim->objects, &sim->objectTree, dt, sim->maxSubsteps);
+        profileEnd(PROFILE_BALL_VS_OBJECTS);
+    } else {
+        // Process physics for all bouncing objects
+        // (collisions with static and moving non-bouncing objects, then screen boundaries)
+        profileBegin(PROFILE_BALL_VS_OBJECTS);
+        handleBouncingObjectListCollisions(&sim->balls, sim->objects, &sim->objectTree, dt, sim->maxSubsteps, &sim->threads);
+        profileEnd(PROFILE_BALL_VS_OBJECTS);
+
+        // Handle collisions between bouncing objects
+        profileBegin(PROFILE_BALL_VS_BALL);
+        handleBallToBallCollisions(&sim->balls, dt, &sim->threads);
+        profileEnd(PROFILE_BALL_VS_BALL);
+    }
+
+    profileBegin(PROFILE_REMOVE_MARKED);
+    // Remove any balls marked for deletion (e.g. those that have escaped through arcs)
+    removeMarkedBouncingObjects(&sim->balls);
+
+    // Remove any game objects marked for deletion (e.g. arcs that had balls escape through them)
+    removeMarkedGameObjects(&sim->objects);
+    profileEnd(PROFILE_REMOVE_MARKED);
+
+    // Put the balls which have come to rest to sleep, wake the ones something has reached
+    profileBegin(PROFILE_SLEEP);
+    updateSleepingBalls(&sim->balls, sim->objects, &sim->objectTree, dt, sim->sleepSteps);
+    profileEnd(PROFILE_SLEEP);
+
+    sim->frame++;
+    profileEnd(PROFILE_STEP);
+}
+
+// Advance the world by frameTime seconds in steps of fixedDt, so the physics always sees the
+// same dt whatever the frame rate. The time left over is kept for the next call (see
+// getSimulationAlpha). At most maxStepsPerFrame steps are taken: after a hitch or at a high
+// time multiplier the simulation slows down instead of making every frame longer.
+// Returns the number of steps taken.
+int advanceSimulation(Simulation* sim, float frameTime) {
+    if (frameTime > 0.0f) sim->accumulator += frameTime;
+
+    int steps = 0;
+    while (sim->accumulator >= sim->fixedDt && steps < sim->maxStepsPerFrame) {
+        stepSimulation(sim, sim->fixedDt);
+        sim->accumulator -= sim->fixedDt;
+        steps++;
+    }
+
+    // Out of budget: drop the whole steps that are left, keep the fraction for interpolation
+    if (sim->accumulator >= sim->fixedDt) {
+        float kept = fmodf(sim->accumulator, sim->fixedDt);
+        sim->droppedTime += sim->accumulator - kept;
+        sim->accumulator = kept;
+    }
+    return steps;
+}
+
+// How far the world is between the last two steps, in [0, 1): render the balls and objects
+// with this alpha to draw the state the world would be in at the current time
+float getSimulationAlpha(const Simulation* sim) {
+    return (sim->fixedDt > 0.0f) ? sim->accumulator / sim->fixedDt : 1.0f;
+}
+
+// --- Scenes ---
+
+// Arc escape callback of the game's scene (also "on_escape = remove_arc" in scene files)
+void removeArcOnEscape(GameObject* arc, BouncingObject* ball) {
+    if (!arc) return;
+    (void)ball; // Unused parameter
+    // Mark the arc for deletion when a ball escapes through it
+    arc->markedForDeletion = true;
+}
+
+// The game's scene: 10 nested rotating red arcs which disappear when balls escape through them
+void createArcScene(Simulation* sim) {
+    registerSnapshotCallback(removeArcOnEscape);
+    for (int i = 0; i < 10; i++) {
+        GameObject* arc = createArcCircleObject(
+            (Vector2){ SCREEN_WIDTH*0.5f, SCREEN_HEIGHT*0.5f },
+            (Vector2){ 0, 0 },
+            50 + i*25,
+            0.0f, // Start angle
+            300.0f, // End angle
+            5.0f, // Thickness
+            RED,
+            false, // Static
+            60.0f+i*20, // Rotation speed
+            false // Remove escaped balls
+        );
+        addEscapeCallbackToArcCircle(arc, removeArcOnEscape);
+        addSimulationObject(sim, arc);
+    }
+}
+
+// --- Random numbers ---
+//
+// The simulation draws its random numbers from its own generator (xorshift32) rather than
+// rand(): its whole state is one word, so a seed or a snapshot gives back the same run.
+
+void seedSimulation(Simulation* sim, uint32_t seed) {
+    sim->rngState = (seed != 0) ? seed : SIMULATION_DEFAULT_SEED; // xorshift never leaves 0
+}
+
+uint32_t simulationRandom(Simulation* sim) {
+    uint32_t x = sim->rngState;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    sim->rngState = x;
+    return x;
+}
+
+// Uniform in [0, 1)
+float simulationRandomFloat(Simulation* sim) {
+    return (float)(simulationRandom(sim) >> 8) / 16777216.0f;
+}
+
+// Spawn a ball with a random speed, size and mass (uses simulationRandom)
+BallHandle spawnRandomBall(Simulation* sim, Vector2 position) {
+    // One draw per statement, so the draws happen in the same order with every compiler
+    Vector2 speed;
+    speed.x = (float)(100 + simulationRandom(sim) % 200);
+    if (simulationRandom(sim) % 2 != 0) speed.x = -speed.x;
+    speed.y = (float)(100 + simulationRandom(sim) % 200);
+    if (simulationRandom(sim) % 2 != 0) speed.y = -speed.y;
+    float radius = (float)(10 + simulationRandom(sim) % 20); // Random size
+    float mass = 0.5f + simulationRandomFloat(sim) * 2.5f; // Random mass between 0.5 and 3.0
+    return createBouncingObject(
+        &sim->balls,
+        position,
+        speed,
+        radius,
+        (Color){ 255, 255, 0, 255 }, // Yellow color
+        mass,
+        1.0f, // Restitution (bounciness)
+        true // By default, allow interaction with other bouncing objects
+    );
+}
@@ -0,0 +1,828 @@
+#include "../include/common.h"
+#include <stdio.h>  // For fopen, fwrite, fread
+#include <stdlib.h> // For malloc, free
+#include <string.h> // For memcpy, memcmp, memset
+#include <math.h>   // For isfinite
+
+// --- World snapshots ---
+//
+// A snapshot holds everything stepSimulation depends on: the simulation settings and random
+// state, the BallStore arrays (handle slots included, so BallHandles stay valid across a
+// save and load), every GameObject with its shape data and effects, the ball emitters, and the broadphase tree
+// nodes as they are (so queries visit objects in the same order as before the save).
+//
+// The ball arrays are written as they are in memory and read back with one memcpy each.
+// Objects, effects and tree nodes are written as fixed-size records of 32-bit fields (no
+// pointers, no padding, so the same world always gives the same file) and rebuilt from their
+// pools; the function pointers of the objects are bound again from their ShapeType.
+//
+// Loading checks every index the file holds (ball slots, tree links, object leaves) and the
+// settings before anything follows them: a damaged or forged file is refused, it can't leave
+// the simulation with a tree or a slot table that points outside its arrays.
+//
+// Not saved: arc callbacks that weren't registered with registerSnapshotCallback (they are
+// saved as their index in that table), sound effects (a Sound belongs to the running
+// program), and the arc meshes (tessellated again on the next draw).
+// Files use the byte order and float format of the machine that wrote them.
+
+#define SNAPSHOT_MAGIC "BBSNAP\0"       // 8 bytes with the terminating zero
+#define SNAPSHOT_BYTE_ORDER 0x01020304u // Reads back differently on a machine of the other byte order
+#define SNAPSHOT_MAX_CALLBACKS 32
+
+// Prototypes for functions in objects.c
+void freeObjectList(GameObject** head);
+
+typedef struct {
+    char magic[8];
+    uint32_t version;
+    uint32_t byteOrder;
+    int64_t frame;
+    double droppedTime;
+    float fixedDt;
+    float accumulator;
+    int32_t maxStepsPerFrame;
+    int32_t mode;
+    int32_t maxSubsteps;
+    int32_t sleepSteps;
+    uint32_t rngState;
+    int32_t ballCount;
+    int32_t slotCount;
+    uint32_t freeSlot;
+    int32_t objectCount;
+    int32_t treeNodeCapacity;
+    int32_t treeNodeCount;
+    int32_t treeRoot;
+    int32_t treeFreeList;
+    float treeMaxObjectSpeed;
+    int32_t emitterCount;
+    int32_t reserved;           // Keeps the header a multiple of 8 bytes
+} SnapshotHeader;
+
+typedef struct {
+    uint8_t type;
+    uint8_t continuous;
+    uint8_t padding[2];
+    Color color;         // COLOR_CHANGE, BALL_DISAPPEAR (particles), BALL_SPAWN
+    int32_t count;       // BALL_DISAPPEAR (particles)
+    float value;         // Factor of VELOCITY_BOOST, VELOCITY_DAMPEN and SIZE_CHANGE, BALL_SPAWN radius
+    Vector2 position;    // BALL_SPAWN
+} SnapshotEffect;
+
+typedef struct {
+    int32_t type;
+    uint8_t isStatic;
+    uint8_t markedForDeletion;
+    uint8_t removeEscapedBalls; // Arcs
+    uint8_t sweptRotation;      // Arcs
+    Vector2 position;
+    Vector2 previousPosition;
+    Vector2 velocity;
+    int32_t treeProxy;          // Leaf in the tree, AABB_TREE_NULL if not in it
+    Color color;
+    float size[4];              // Rectangle: width, height; diamond: halfWidth, halfHeight;
+                                // arc: radius, startAngle, endAngle, thickness
+    float rotation;             // Arcs
+    float previousRotation;
+    float rotationSpeed;
+    int32_t collisionCallbackCount; // Registered callbacks that follow the record (arcs)
+    int32_t escapeCallbackCount;
+} SnapshotObject;
+
+typedef struct {
+    Vector2 position;
+    float minSpeed, maxSpeed;
+    float minAngle, maxAngle;
+    float minRadius, maxRadius;
+    float minMass, maxMass;
+    float restitution;
+    Color color;
+    int32_t interactWithOtherBouncingObjects;
+    int32_t rate;
+    int32_t remaining;
+} SnapshotEmitter;
+
+typedef struct {
+    Vector2 min, max;
+    int32_t parent;
+    int32_t left, right;
+    int32_t height;
+    int32_t next;
+} SnapshotTreeNode;
+
+static ArcCircleCallback registeredCallbacks[SNAPSHOT_MAX_CALLBACKS];
+static int registeredCallbackCount = 0;
+
+// Make arc callbacks saveable: they are written as their index in this table, so the
+// program loading the snapshot must register the same callbacks in the same order.
+// Returns false if the table is full.
+bool registerSnapshotCallback(ArcCircleCallback callback) {
+    for (int i = 0; i < registeredCallbackCount; i++) {
+        if (registeredCallbacks[i] == callback) return true;
+    }
+    if (registeredCallbackCount >= SNAPSHOT_MAX_CALLBACKS) return false;
+    registeredCallbacks[registeredCallbackCount++] = callback;
+    return true;
+}
+
+static int findCallbackIndex(ArcCircleCallback callback) {
+    for (int i = 0; i < registeredCallbackCount; i++) {
+        if (registeredCallbacks[i] == callback) return i;
+    }
+    return -1;
+}
+
+// --- Writing ---
+
+typedef struct {
+    FILE* file;
+    bool ok;
+} SnapshotWriter;
+
+static void writeBytes(SnapshotWriter* w, const void* data, size_t size) {
+    if (w->ok && size > 0 && fwrite(data, 1, size, w->file) != size) w->ok = false;
+}
+
+static void writeInt(SnapshotWriter* w, int32_t value) {
+    writeBytes(w, &value, sizeof(value));
+}
+
+static void writeEffectList(SnapshotWriter* w, const CollisionEffect* effects) {
+    int32_t count = 0;
+    for (const CollisionEffect* e = effects; e != NULL; e = e->next) {
+        if (e->type != EFFECT_SOUND_PLAY) count++;
+    }
+    writeInt(w, count);
+
+    for (const CollisionEffect* e = effects; e != NULL; e = e->next) {
+        SnapshotEffect record = { .type = (uint8_t)e->type, .continuous = e->continuous };
+        switch (e->type) {
+            case EFFECT_COLOR_CHANGE:
+                record.color = e->params.colorEffect.color;
+                break;
+            case EFFECT_VELOCITY_BOOST:
+            case EFFECT_VELOCITY_DAMPEN:
+                record.value = e->params.velocityEffect.factor;
+                break;
+            case EFFECT_SIZE_CHANGE:
+                record.value = e->params.sizeEffect.factor;
+                break;
+            case EFFECT_SOUND_PLAY:
+                continue;
+            case EFFECT_BALL_DISAPPEAR:
+                record.count = e->params.disappearEffect.particleCount;
+                record.color = e->params.disappearEffect.particleColor;
+                break;
+            case EFFECT_BALL_SPAWN:
+                record.position = e->params.spawnEffect.position;
+                record.value = e->params.spawnEffect.radius;
+                record.color = e->params.spawnEffect.color;
+                break;
+        }
+        writeBytes(w, &record, sizeof(record));
+    }
+}
+
+static void writeCallbackList(SnapshotWriter* w, const ArcCircleCallbackNode* callbacks) {
+    for (const ArcCircleCallbackNode* node = callbacks; node != NULL; node = node->next) {
+        int32_t index = findCallbackIndex(node->callback);
+        if (index >= 0) writeInt(w, index);
+    }
+}
+
+static int32_t countRegisteredCallbacks(const ArcCircleCallbackNode* callbacks) {
+    int32_t count = 0;
+    for (const ArcCircleCallbackNode* node = callbacks; node != NULL; node = node->next) {
+        if (findCallbackIndex(node->callback) >= 0) count++;
+    }
+    return count;
+}
+
+static void writeObject(SnapshotWriter* w, const Simulation* sim, const GameObject* obj) {
+    SnapshotObject record = {
+        .type = (int32_t)obj->type,
+        .isStatic = obj->isStatic,
+        .markedForDeletion = obj->markedForDeletion,
+        .position = obj->position,
+        .previousPosition = obj->previousPosition,
+        .velocity = obj->velocity,
+        .treeProxy = (obj->tree == &sim->objectTree) ? obj->treeProxy : AABB_TREE_NULL,
+    };
+    const ShapeDataArcCircle* arc = NULL;
+    switch (obj->type) {
+        case SHAPE_RECTANGLE: {
+            const ShapeDataRectangle* data = (const ShapeDataRectangle*)obj->shapeData;
+            record.color = data->color;
+            record.size[0] = data->width;
+            record.size[1] = data->height;
+        } break;
+        case SHAPE_DIAMOND: {
+            const ShapeDataDiamond* data = (const ShapeDataDiamond*)obj->shapeData;
+            record.color = data->color;
+            record.size[0] = data->halfWidth;
+            record.size[1] = data->halfHeight;
+        } break;
+        case SHAPE_CIRCLE_ARC: {
+            arc = (const ShapeDataArcCircle*)obj->shapeData;
+            record.color = arc->color;
+            record.size[0] = arc->radius;
+            record.size[1] = arc->startAngle;
+            record.size[2] = arc->endAngle;
+            record.size[3] = arc->thickness;
+            record.rotation = arc->rotation;
+            record.previousRotation = arc->previousRotation;
+            record.rotationSpeed = arc->rotationSpeed;
+            record.removeEscapedBalls = arc->removeEscapedBalls;
+            record.sweptRotation = arc->sweptRotation;
+            record.collisionCallbackCount = countRegisteredCallbacks(arc->onCollisionCallbacks);
+            record.escapeCallbackCount = countRegisteredCallbacks(arc->onEscapeCallbacks);
+        } break;
+    }
+    writeBytes(w, &record, sizeof(record));
+    if (arc) {
+        writeCallbackList(w, arc->onCollisionCallbacks);
+        writeCallbackList(w, arc->onEscapeCallbacks);
+    }
+    writeEffectList(w, obj->onCollisionEffects);
+}
+
+// Write the whole world of `sim` to `path`. Returns false if the file couldn't be written.
+bool saveSimulationSnapshot(const Simulation* sim, const char* path) {
+    FILE* file = fopen(path, "wb");
+    if (!file) return false;
+    SnapshotWriter w = { file, true };
+
+    const BallStore* balls = &sim->balls;
+    const AABBTree* tree = &sim->objectTree;
+    SnapshotHeader header = {
+        .magic = SNAPSHOT_MAGIC,
+        .version = SNAPSHOT_VERSION,
+        .byteOrder = SNAPSHOT_BYTE_ORDER,
+        .frame = sim->frame,
+        .droppedTime = sim->droppedTime,
+        .fixedDt = sim->fixedDt,
+        .accumulator = sim->accumulator,
+        .maxStepsPerFrame = sim->maxStepsPerFrame,
+        .mode = (int32_t)sim->mode,
+        .maxSubsteps = sim->maxSubsteps,
+        .sleepSteps = sim->sleepSteps,
+        .rngState = sim->rngState,
+        .ballCount = balls->count,
+        .slotCount = balls->slotCount,
+        .freeSlot = balls->freeSlot,
+        .objectCount = 0,
+        .treeNodeCapacity = tree->nodeCapacity,
+        .treeNodeCount = tree->nodeCount,
+        .treeRoot = tree->root,
+        .treeFreeList = tree->freeList,
+        .treeMaxObjectSpeed = tree->maxObjectSpeed,
+        .emitterCount = sim->emitterCount,
+    };
+    for (const GameObject* obj = sim->objects; obj != NULL; obj = obj->next) header.objectCount++;
+    writeBytes(&w, &header, sizeof(header));
+
+    // Balls: one block per array
+    size_t n = (size_t)balls->count;
+    writeBytes(&w, balls->posX, n * sizeof(float));
+    writeBytes(&w, balls->posY, n * sizeof(float));
+    writeBytes(&w, balls->prevX, n * sizeof(float));
+    writeBytes(&w, balls->prevY, n * sizeof(float));
+    writeBytes(&w, balls->velX, n * sizeof(float));
+    writeBytes(&w, balls->velY, n * sizeof(float));
+    writeBytes(&w, balls->radius, n * sizeof(float));
+    writeBytes(&w, balls->mass, n * sizeof(float));
+    writeBytes(&w, balls->restitution, n * sizeof(float));
+    writeBytes(&w, balls->flags, n * sizeof(uint8_t));
+    writeBytes(&w, balls->stillSteps, n * sizeof(uint8_t));
+    writeBytes(&w, balls->color, n * sizeof(Color));
+    writeBytes(&w, balls->slotOf, n * sizeof(uint32_t));
+    writeBytes(&w, balls->slotDense, (size_t)balls->slotCount * sizeof(uint32_t));
+    writeBytes(&w, balls->slotGeneration, (size_t)balls->slotCount * sizeof(uint32_t));
+
+    // Effects of the balls that have some, as (index, list)
+    int32_t ballsWithEffects = 0;
+    for (int i = 0; i < balls->count; i++) {
+        if (balls->effects[i]) ballsWithEffects++;
+    }
+    writeInt(&w, ballsWithEffects);
+    for (int i = 0; i < balls->count; i++) {
+        if (!balls->effects[i]) continue;
+        writeInt(&w, i);
+        writeEffectList(&w, balls->effects[i]);
+    }
+
+    // Objects, in list order
+    for (const GameObject* obj = sim->objects; obj != NULL; obj = obj->next) {
+        writeObject(&w, sim, obj);
+    }
+
+    // Emitters, each followed by its effects
+    for (int i = 0; i < sim->emitterCount; i++) {
+        const BallEmitter* emitter = &sim->emitters[i];
+        SnapshotEmitter record = {
+            .position = emitter->position,
+            .minSpeed = emitter->minSpeed, .maxSpeed = emitter->maxSpeed,
+            .minAngle = emitter->minAngle, .maxAngle = emitter->maxAngle,
+            .minRadius = emitter->minRadius, .maxRadius = emitter->maxRadius,
+            .minMass = emitter->minMass, .maxMass = emitter->maxMass,
+            .restitution = emitter->restitution,
+            .color = emitter->color,
+            .interactWithOtherBouncingObjects = emitter->interactWithOtherBouncingObjects,
+            .rate = emitter->rate,
+            .remaining = emitter->remaining,
+        };
+        writeBytes(&w, &record, sizeof(record));
+        writeEffectList(&w, emitter->effects);
+    }
+
+    // Tree nodes, without the object pointers (objects give their leaf with treeProxy)
+    for (int i = 0; i < tree->nodeCapacity; i++) {
+        const AABBTreeNode* node = &tree->nodes[i];
+        SnapshotTreeNode record = {
+            .min = node->min, .max = node->max,
+            .parent = node->parent, .left = node->left, .right = node->right,
+            .height = node->height, .next = node->next,
+        };
+        writeBytes(&w, &record, sizeof(record));
+    }
+
+    bool closed = fclose(file) == 0;
+    return w.ok && closed;
+}
+
+// --- Reading ---
+
+typedef struct {
+    const unsigned char* data;
+    size_t size;
+    size_t offset;
+    bool ok;
+} SnapshotReader;
+
+static bool readBytes(SnapshotReader* r, void* out, size_t size) {
+    if (!r->ok || size > r->size - r->offset) {
+        r->ok = false;
+        return false;
+    }
+    if (size > 0) memcpy(out, r->data + r->offset, size);
+    r->offset += size;
+    return true;
+}
+
+static int32_t readInt(SnapshotReader* r) {
+    int32_t value = 0;
+    readBytes(r, &value, sizeof(value));
+    return value;
+}
+
+// Read an effect list written by writeEffectList, in the same order
+static bool readEffectList(SnapshotReader* r, CollisionEffect** head) {
+    int32_t count = readInt(r);
+    if (count < 0) r->ok = false;
+    CollisionEffect** tail = head;
+    for (int32_t k = 0; k < count && r->ok; k++) {
+        SnapshotEffect record;
+        if (!readBytes(r, &record, sizeof(record))) break;
+
+        CollisionEffect effect = { .type = (EffectType)record.type, .continuous = record.continuous != 0 };
+        switch (record.type) {
+            case EFFECT_COLOR_CHANGE:
+                effect.params.colorEffect.color = record.color;
+                break;
+            case EFFECT_VELOCITY_BOOST:
+            case EFFECT_VELOCITY_DAMPEN:
+                effect.params.velocityEffect.factor = record.value;
+                break;
+            case EFFECT_SIZE_CHANGE:
+                effect.params.sizeEffect.factor = record.value;
+                break;
+            case EFFECT_BALL_DISAPPEAR:
+                effect.params.disappearEffect.particleCount = record.count;
+                effect.params.disappearEffect.particleColor = record.color;
+                break;
+            case EFFECT_BALL_SPAWN:
+                effect.params.spawnEffect.position = record.position;
+                effect.params.spawnEffect.radius = record.value;
+                effect.params.spawnEffect.color = record.color;
+                break;
+            default:
+                r->ok = false; // Sound effects are never written
+                continue;
+        }
+        CollisionEffect* copy = cloneCollisionEffect(&effect);
+        if (!copy) {
+            r->ok = false;
+            break;
+        }
+        *tail = copy;
+        tail = &copy->next;
+    }
+    return r->ok;
+}
+
+static bool readCallbackList(SnapshotReader* r, int32_t count, ArcCircleCallbackNode** head) {
+    ArcCircleCallbackNode** tail = head;
+    for (int32_t k = 0; k < count && r->ok; k++) {
+        int32_t index = readInt(r);
+        if (index < 0 || index >= registeredCallbackCount) continue; // Not registered by this program
+        ArcCircleCallbackNode* node = (ArcCircleCallbackNode*)malloc(sizeof(ArcCircleCallbackNode));
+        if (!node) {
+            r->ok = false;
+            break;
+        }
+        node->callback = registeredCallbacks[index];
+        node->next = NULL;
+        *tail = node;
+        tail = &node->next;
+    }
+    return r->ok;
+}
+
+// Check the floats of an object record: all finite, positive sizes (the arc's radius and
+// thickness, its angles being free) and an arc rotation already wrapped into [0, 360] as
+// updateArcCircleObj leaves it
+static bool validateObjectRecord(const SnapshotObject* record) {
+    const float values[] = {
+        record->position.x, record->position.y, record->previousPosition.x, record->previousPosition.y,
+        record->velocity.x, record->velocity.y, record->size[0], record->size[1], record->size[2],
+        record->size[3], record->rotation, record->previousRotation, record->rotationSpeed,
+    };
+    for (size_t i = 0; i < sizeof(values) / sizeof(values[0]); i++) {
+        if (!isfinite(values[i])) return false;
+    }
+    if (record->type == SHAPE_CIRCLE_ARC) {
+        return record->size[0] > 0.0f && record->size[3] > 0.0f &&
+               record->rotation >= 0.0f && record->rotation <= 360.0f &&
+               record->previousRotation >= 0.0f && record->previousRotation <= 360.0f;
+    }
+    return record->size[0] > 0.0f && record->size[1] > 0.0f;
+}
+
+// Read one object written by writeObject. Its leaf in the tree is returned in `treeProxy`.
+static GameObject* readObject(SnapshotReader* r, int32_t* treeProxy) {
+    SnapshotObject record;
+    if (!readBytes(r, &record, sizeof(record))) return NULL;
+    if (record.type < 0 || record.type >= SHAPE_TYPE_COUNT ||
+        record.collisionCallbackCount < 0 || record.escapeCallbackCount < 0 || !validateObjectRecord(&record)) {
+        r->ok = false;
+        return NULL;
+    }
+
+    GameObject* obj = allocGameObject();
+    if (!obj) {
+        r->ok = false;
+        return NULL;
+    }
+    obj->type = (ShapeType)record.type;
+    obj->position = record.position;
+    obj->previousPosition = record.previousPosition;
+    obj->velocity = record.velocity;
+    obj->isStatic = record.isStatic != 0;
+    obj->markedForDeletion = record.markedForDeletion != 0;
+    obj->onCollisionEffects = NULL;
+    obj->next = NULL;
+    switch (obj->type) {
+        case SHAPE_RECTANGLE: {
+            ShapeDataRectangle* data = (ShapeDataRectangle*)obj->shapeData;
+            data->width = record.size[0];
+            data->height = record.size[1];
+            data->color = record.color;
+        } break;
+        case SHAPE_DIAMOND: {
+            ShapeDataDiamond* data = (ShapeDataDiamond*)obj->shapeData;
+            data->halfWidth = record.size[0];
+            data->halfHeight = record.size[1];
+            data->color = record.color;
+        } break;
+        case SHAPE_CIRCLE_ARC: {
+            ShapeDataArcCircle* data = (ShapeDataArcCircle*)obj->shapeData;
+            data->radius = record.size[0];
+            data->startAngle = record.size[1];
+            data->endAngle = record.size[2];
+            data->thickness = record.size[3];
+            data->color = record.color;
+            data->rotation = record.rotation;
+            data->previousRotation = record.previousRotation;
+            data->rotationSpeed = record.rotationSpeed;
+            data->removeEscapedBalls = record.removeEscapedBalls != 0;
+            data->sweptRotation = record.sweptRotation != 0;
+            data->onCollisionCallbacks = NULL;
+            data->onEscapeCallbacks = NULL;
+        } break;
+    }
+    bindGameObject(obj);
+
+    if (obj->type == SHAPE_CIRCLE_ARC) {
+        ShapeDataArcCircle* data = (ShapeDataArcCircle*)obj->shapeData;
+        readCallbackList(r, record.collisionCallbackCount, &data->onCollisionCallbacks);
+        readCallbackList(r, record.escapeCallbackCount, &data->onEscapeCallbacks);
+    }
+    readEffectList(r, &obj->onCollisionEffects);
+    *treeProxy = record.treeProxy;
+    return obj; // Returned even if reading failed, so the caller frees it with the others
+}
+
+// Read the emitters written after the objects into `emitters` (room for header->emitterCount)
+static bool readEmitters(SnapshotReader* r, const SnapshotHeader* header, BallEmitter* emitters) {
+    for (int32_t k = 0; k < header->emitterCount && r->ok; k++) {
+        SnapshotEmitter record;
+        if (!readBytes(r, &record, sizeof(record))) break;
+        if (record.rate < 0 || record.remaining < -1) {
+            r->ok = false;
+            break;
+        }
+        emitters[k] = (BallEmitter){
+            .position = record.position,
+            .minSpeed = record.minSpeed, .maxSpeed = record.maxSpeed,
+            .minAngle = record.minAngle, .maxAngle = record.maxAngle,
+            .minRadius = record.minRadius, .maxRadius = record.maxRadius,
+            .minMass = record.minMass, .maxMass = record.maxMass,
+            .restitution = record.restitution,
+            .color = record.color,
+            .interactWithOtherBouncingObjects = record.interactWithOtherBouncingObjects != 0,
+            .rate = record.rate,
+            .remaining = record.remaining,
+            .effects = NULL,
+        };
+        readEffectList(r, &emitters[k].effects);
+    }
+    return r->ok;
+}
+
+// Check the handle slots: each ball owns a slot which points back at it, and every other slot
+// is in the free list (chained through slotDense) exactly once
+static bool validateBallSlots(const BallStore* balls) {
+    int slotCount = balls->slotCount;
+    uint8_t* used = (uint8_t*)calloc((size_t)(slotCount > 0 ? slotCount : 1), 1);
+    if (!used) return false;
+    bool ok = true;
+    for (int i = 0; i < balls->count && ok; i++) {
+        uint32_t slot = balls->slotOf[i];
+        ok = slot < (uint32_t)slotCount && balls->slotDense[slot] == (uint32_t)i;
+        if (ok) used[slot] = 1;
+    }
+    int freeCount = 0;
+    for (uint32_t slot = balls->freeSlot; ok && slot != BALL_SLOT_NONE; slot = balls->slotDense[slot]) {
+        ok = slot < (uint32_t)slotCount && !used[slot];
+        if (!ok) break;
+        used[slot] = 1;
+        freeCount++;
+    }
+    free(used);
+    return ok && balls->count + freeCount == slotCount;
+}
+
+// Check the ball state the broad phase sizes its grid from: finite positions and velocities,
+// positive radius and mass, and restitution in [0, 1] as createBouncingObject clamps it
+static bool validateBallValues(const BallStore* balls) {
+    for (int i = 0; i < balls->count; i++) {
+        if (!isfinite(balls->posX[i]) || !isfinite(balls->posY[i]) ||
+            !isfinite(balls->prevX[i]) || !isfinite(balls->prevY[i]) ||
+            !isfinite(balls->velX[i]) || !isfinite(balls->velY[i]) ||
+            !(balls->restitution[i] >= 0.0f && balls->restitution[i] <= 1.0f) ||
+            !(balls->radius[i] > 0.0f && isfinite(balls->radius[i])) ||
+            !(balls->mass[i] > 0.0f && isfinite(balls->mass[i]))) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static bool isNodeIndex(int32_t index, int capacity) {
+    return index >= 0 && index < capacity;
+}
+
+// Check the tree nodes: the nodes reachable from the root form a tree (children in range and
+// pointing back at their parent, heights consistent) of nodeCount nodes, and all the others
+// are free nodes chained once in the free list. Returns the number of leaves in `leafCount`.
+static bool validateTree(const AABBTree* tree, int* leafCount) {
+    int capacity = tree->nodeCapacity;
+    *leafCount = 0;
+    if ((tree->root != AABB_TREE_NULL && !isNodeIndex(tree->root, capacity)) ||
+        (tree->freeList != AABB_TREE_NULL && !isNodeIndex(tree->freeList, capacity))) {
+        return false;
+    }
+    if (capacity == 0) return tree->nodeCount == 0;
+
+    uint8_t* seen = (uint8_t*)calloc((size_t)capacity, 1);
+    int* stack = (int*)malloc((size_t)capacity * sizeof(int)); // A node is pushed by its parent only
+    bool ok = seen && stack;
+    int stackSize = 0;
+    int reachable = 0;
+    if (ok && tree->root != AABB_TREE_NULL) {
+        ok = tree->nodes[tree->root].parent == AABB_TREE_NULL;
+        stack[stackSize++] = tree->root;
+    }
+    while (ok && stackSize > 0) {
+        int index = stack[--stackSize];
+        const AABBTreeNode* node = &tree->nodes[index];
+        if (seen[index]) {
+            ok = false;
+            break;
+        }
+        seen[index] = 1;
+        reachable++;
+        if (node->left == AABB_TREE_NULL) {
+            ok = node->right == AABB_TREE_NULL && node->height == 0;
+            (*leafCount)++;
+            continue;
+        }
+        ok = isNodeIndex(node->left, capacity) && isNodeIndex(node->right, capacity) && node->left != node->right &&
+             tree->nodes[node->left].parent == index && tree->nodes[node->right].parent == index;
+        if (!ok) break;
+        int leftHeight = tree->nodes[node->left].height;
+        int rightHeight = tree->nodes[node->right].height;
+        ok = leftHeight < node->height && rightHeight < node->height &&
+             (leftHeight == node->height - 1 || rightHeight == node->height - 1);
+        stack[stackSize++] = node->left;
+        stack[stackSize++] = node->right;
+    }
+
+    int freeCount = 0;
+    for (int index = tree->freeList; ok && index != AABB_TREE_NULL; index = tree->nodes[index].next) {
+        ok = isNodeIndex(index, capacity) && !seen[index] && tree->nodes[index].height == -1;
+        if (!ok) break;
+        seen[index] = 1;
+        freeCount++;
+    }
+    free(seen);
+    free(stack);
+    return ok && reachable == tree->nodeCount && reachable + freeCount == capacity;
+}
+
+// Build the world of a snapshot into `balls`, `objects`, `emitters` and `tree` (empty on entry)
+static bool readWorld(SnapshotReader* r, const SnapshotHeader* header,
+                      BallStore* balls, GameObject** objects, BallEmitter* emitters, AABBTree* tree) {
+    if (header->ballCount < 0 || header->slotCount < header->ballCount || header->objectCount < 0 ||
+        header->treeNodeCapacity < 0 || header->treeNodeCount < 0 || header->treeNodeCount > header->treeNodeCapacity) {
+        return false;
+    }
+
+    // Reject counts the file is too short for before allocating anything
+    size_t ballBytes = (size_t)header->ballCount * (9 * sizeof(float) + 2 * sizeof(uint8_t) + sizeof(Color) + sizeof(uint32_t)) +
+                       (size_t)header->slotCount * 2 * sizeof(uint32_t);
+    size_t objectBytes = (size_t)header->objectCount * sizeof(SnapshotObject);
+    size_t treeBytes = (size_t)header->treeNodeCapacity * sizeof(SnapshotTreeNode);
+    if (ballBytes + objectBytes + treeBytes > r->size - r->offset) return false;
+
+    // Balls: straight into the arrays
+    if (!resizeBallStore(balls, header->ballCount, header->slotCount)) return false;
+    size_t n = (size_t)header->ballCount;
+    readBytes(r, balls->posX, n * sizeof(float));
+    readBytes(r, balls->posY, n * sizeof(float));
+    readBytes(r, balls->prevX, n * sizeof(float));
+    readBytes(r, balls->prevY, n * sizeof(float));
+    readBytes(r, balls->velX, n * sizeof(float));
+    readBytes(r, balls->velY, n * sizeof(float));
+    readBytes(r, balls->radius, n * sizeof(float));
+    readBytes(r, balls->mass, n * sizeof(float));
+    readBytes(r, balls->restitution, n * sizeof(float));
+    readBytes(r, balls->flags, n * sizeof(uint8_t));
+    readBytes(r, balls->stillSteps, n * sizeof(uint8_t));
+    readBytes(r, balls->color, n * sizeof(Color));
+    readBytes(r, balls->slotOf, n * sizeof(uint32_t));
+    readBytes(r, balls->slotDense, (size_t)header->slotCount * sizeof(uint32_t));
+    readBytes(r, balls->slotGeneration, (size_t)header->slotCount * sizeof(uint32_t));
+    balls->freeSlot = header->freeSlot;
+    if (n > 0) memset(balls->effects, 0, n * sizeof(CollisionEffect*));
+    if (!r->ok || !validateBallSlots(balls) || !validateBallValues(balls)) return false;
+    for (int i = 0; i < balls->count; i++) {
+        if (balls->flags[i] & BALL_FLAG_ASLEEP) balls->asleepCount++;
+    }
+
+    int32_t ballsWithEffects = readInt(r);
+    for (int32_t k = 0; k < ballsWithEffects && r->ok; k++) {
+        int32_t index = readInt(r);
+        if (index < 0 || index >= balls->count || balls->effects[index]) {
+            r->ok = false;
+            break;
+        }
+        readEffectList(r, &balls->effects[index]);
+    }
+
+    // Objects, linked in the order they were saved
+    int32_t* proxies = (int32_t*)malloc((size_t)(header->objectCount > 0 ? header->objectCount : 1) * sizeof(int32_t));
+    if (!proxies) return false;
+    GameObject** tail = objects;
+    for (int32_t k = 0; k < header->objectCount && r->ok; k++) {
+        GameObject* obj = readObject(r, &proxies[k]);
+        if (!obj) break;
+        *tail = obj;
+        tail = &obj->next;
+    }
+
+    readEmitters(r, header, emitters);
+
+    // Tree: the nodes as they were, checked, then the leaves pointed back at their objects
+    if (r->ok && header->treeNodeCapacity > 0) {
+        tree->nodes = (AABBTreeNode*)malloc((size_t)header->treeNodeCapacity * sizeof(AABBTreeNode));
+        if (!tree->nodes) r->ok = false;
+        for (int i = 0; i < header->treeNodeCapacity && r->ok; i++) {
+            SnapshotTreeNode record;
+            if (!readBytes(r, &record, sizeof(record))) break;
+            tree->nodes[i] = (AABBTreeNode){
+                .min = record.min, .max = record.max,
+                .parent = record.parent, .left = record.left, .right = record.right,
+                .height = record.height, .next = record.next, .object = NULL,
+            };
+        }
+        tree->nodeCapacity = header->treeNodeCapacity;
+    }
+    tree->nodeCount = header->treeNodeCount;
+    tree->root = header->treeRoot;
+    tree->freeList = header->treeFreeList;
+    tree->maxObjectSpeed = header->treeMaxObjectSpeed;
+    int leafCount = 0;
+    if (r->ok && !validateTree(tree, &leafCount)) r->ok = false;
+
+    // Every leaf belongs to exactly one object, and every object has a leaf (the collision
+    // passes only find objects through the tree)
+    int32_t k = 0;
+    int objectsInTree = 0;
+    for (GameObject* obj = *objects; obj != NULL && r->ok; obj = obj->next, k++) {
+        int32_t proxy = proxies[k];
+        if (!isNodeIndex(proxy, tree->nodeCapacity) || tree->nodes[proxy].height != 0 || tree->nodes[proxy].object) {
+            r->ok = false;
+            break;
+        }
+        tree->nodes[proxy].object = obj;
+        obj->treeProxy = proxy;
+        objectsInTree++;
+    }
+    free(proxies);
+    return r->ok && objectsInTree == leafCount;
+}
+
+// Replace the world of `sim` (initialized with initSimulation) by the one saved in `path`.
+// Returns false if the file can't be read or isn't a valid snapshot of this version; `sim`
+// is then left as it was.
+bool loadSimulationSnapshot(Simulation* sim, const char* path) {
+    FILE* file = fopen(path, "rb");
+    if (!file) return false;
+    unsigned char* data = NULL;
+    long size = -1;
+    if (fseek(file, 0, SEEK_END) == 0) size = ftell(file);
+    if (size > 0 && fseek(file, 0, SEEK_SET) == 0) {
+        data = (unsigned char*)malloc((size_t)size);
+        if (data && fread(data, 1, (size_t)size, file) != (size_t)size) {
+            free(data);
+            data = NULL;
+        }
+    }
+    fclose(file);
+    if (!data) return false;
+
+    SnapshotReader r = { data, (size_t)size, 0, true };
+    SnapshotHeader header;
+    if (!readBytes(&r, &header, sizeof(header)) || memcmp(header.magic, SNAPSHOT_MAGIC, sizeof(header.magic)) != 0 ||
+        header.version != SNAPSHOT_VERSION || header.byteOrder != SNAPSHOT_BYTE_ORDER ||
+        header.emitterCount < 0 || (size_t)header.emitterCount * sizeof(SnapshotEmitter) > r.size ||
+        (header.mode != SIMULATION_SUBSTEPS && header.mode != SIMULATION_EVENTS) ||
+        !isfinite(header.fixedDt) || header.fixedDt <= 0.0f || !isfinite(header.accumulator) || header.accumulator < 0.0f ||
+        header.maxStepsPerFrame <= 0 || header.maxSubsteps <= 0 || header.sleepSteps < 0) {
+        free(data);
+        return false;
+    }
+
+    // Build the new world aside, so a bad file leaves the current one untouched
+    BallStore balls;
+    GameObject* objects = NULL;
+    AABBTree tree;
+    initBallStore(&balls);
+    initAABBTree(&tree);
+    BallEmitter* emitters = (BallEmitter*)calloc((size_t)(header.emitterCount > 0 ? header.emitterCount : 1), sizeof(BallEmitter));
+    bool ok = emitters && readWorld(&r, &header, &balls, &objects, emitters, &tree);
+    free(data);
+    if (!ok) {
+        for (int i = 0; emitters && i < header.emitterCount; i++) freeEffectList(&emitters[i].effects);
+        free(emitters);
+        freeObjectList(&objects);
+        freeBallStore(&balls);
+        freeAABBTree(&tree);
+        return false;
+    }
+
+    freeObjectList(&sim->objects);
+    freeAABBTree(&sim->objectTree);
+    freeBallStore(&sim->balls);
+    sim->objects = objects;
+    sim->objectTree = tree;
+    sim->balls = balls;
+    for (int i = 0; i < sim->emitterCount; i++) freeEffectList(&sim->emitters[i].effects);
+    free(sim->emitters);
+    sim->emitters = emitters;
+    sim->emitterCount = sim->emitterCapacity = header.emitterCount;
+    for (GameObject* obj = sim->objects; obj != NULL; obj = obj->next) {
+        if (obj->treeProxy != AABB_TREE_NULL) obj->tree = &sim->objectTree;
+    }
+
+    sim->frame = header.frame;
+    sim->droppedTime = header.droppedTime;
+    sim->fixedDt = header.fixedDt;
+    sim->accumulator = header.accumulator;
+    sim->maxStepsPerFrame = header.maxStepsPerFrame;
+    sim->mode = (SimulationMode)header.mode;
+    sim->maxSubsteps = header.maxSubsteps;
+    sim->sleepSteps = header.sleepSteps;
+    sim->rngState = header.rngState;
+    return true;
+}
@@ -0,0 +1,133 @@
+#include "../include/common.h"
+#include <stdlib.h> // For malloc, free
+
+#ifdef _WIN32
+// winpthreads provides the processor count without pulling windows.h (which clashes with raylib)
+#define DETECT_CPU_COUNT() pthread_num_processors_np()
+#else
+#include <unistd.h> // For sysconf
+#define DETECT_CPU_COUNT() (int)sysconf(_SC_NPROCESSORS_ONLN)
+#endif
+
+// --- Worker Thread Pool ---
+//
+// Workers sleep on a condition variable until runParallelRange publishes a new job
+// (by bumping jobGeneration), run their share of the range and report back.
+// The calling thread always takes part as thread 0.
+
+typedef struct {
+    ThreadPool* pool;
+    int threadIndex;
+} WorkerArgs;
+
+// Range [begin, end) given to `threadIndex` when splitting `count` items over the pool.
+// Ranges are contiguous and ordered by thread index.
+static void getThreadRange(int count, int threadCount, int threadIndex, int* begin, int* end) {
+    int base = count / threadCount;
+    int extra = count % threadCount;
+    *begin = threadIndex * base + (threadIndex < extra ? threadIndex : extra);
+    *end = *begin + base + (threadIndex < extra ? 1 : 0);
+}
+
+static void* workerMain(void* arg) {
+    WorkerArgs* args = (WorkerArgs*)arg;
+    ThreadPool* pool = args->pool;
+    int threadIndex = args->threadIndex;
+    free(args);
+
+    unsigned int seenGeneration = 0;
+    for (;;) {
+        pthread_mutex_lock(&pool->mutex);
+        while (pool->jobGeneration == seenGeneration && !pool->shuttingDown) {
+            pthread_cond_wait(&pool->jobReady, &pool->mutex);
+        }
+        if (pool->shuttingDown) {
+            pthread_mutex_unlock(&pool->mutex);
+            return NULL;
+        }
+        seenGeneration = pool->jobGeneration;
+        ParallelRangeTask task = pool->task;
+        void* userData = pool->userData;
+        int count = pool->jobCount;
+        pthread_mutex_unlock(&pool->mutex);
+
+        int begin, end;
+        getThreadRange(count, pool->threadCount, threadIndex, &begin, &end);
+        if (begin < end) task(userData, begin, end, threadIndex);
+
+        pthread_mutex_lock(&pool->mutex);
+        if (--pool->pendingWorkers == 0) pthread_cond_signal(&pool->jobDone);
+        pthread_mutex_unlock(&pool->mutex);
+    }
+}
+
+// Start a pool. threadCount <= 0 uses one thread per online CPU.
+// threadCount counts the calling thread, so threadCount - 1 workers are started.
+bool initThreadPool(ThreadPool* pool, int threadCount) {
+    *pool = (ThreadPool){0};
+    if (threadCount <= 0) threadCount = DETECT_CPU_COUNT();
+    if (threadCount < 1) threadCount = 1;
+    if (threadCount > THREAD_POOL_MAX_THREADS) threadCount = THREAD_POOL_MAX_THREADS;
+
+    pthread_mutex_init(&pool->mutex, NULL);
+    pthread_cond_init(&pool->jobReady, NULL);
+    pthread_cond_init(&pool->jobDone, NULL);
+    pool->threadCount = 1;
+
+    for (int i = 1; i < threadCount; i++) {
+        WorkerArgs* args = (WorkerArgs*)malloc(sizeof(WorkerArgs));
+        if (!args) break;
+        args->pool = pool;
+        args->threadIndex = i;
+        if (pthread_create(&pool->workers[i - 1], NULL, workerMain, args) != 0) {
+            free(args);
+            break;
+        }
+        pool->threadCount++;
+    }
+    return pool->threadCount == threadCount;
+}
+
+void freeThreadPool(ThreadPool* pool) {
+    pthread_mutex_lock(&pool->mutex);
+    pool->shuttingDown = true;
+    pthread_cond_broadcast(&pool->jobReady);
+    pthread_mutex_unlock(&pool->mutex);
+
+    for (int i = 0; i < pool->threadCount - 1; i++) {
+        pthread_join(pool->workers[i], NULL);
+    }
+    pthread_mutex_destroy(&pool->mutex);
+    pthread_cond_destroy(&pool->jobReady);
+    pthread_cond_destroy(&pool->jobDone);
+    pool->threadCount = 0;
+}
+
+// Split [0, count) into one contiguous range per thread and run `task` on each,
+// returning when all ranges are done. A NULL pool runs the whole range on the caller.
+void runParallelRange(ThreadPool* pool, int count, ParallelRangeTask task, void* userData) {
+    if (count <= 0) return;
+    if (!pool || pool->threadCount <= 1) {
+        task(userData, 0, count, 0);
+        return;
+    }
+
+    pthread_mutex_lock(&pool->mutex);
+    pool->task = task;
+    pool->userData = userData;
+    pool->jobCount = count;
+    pool->pendingWorkers = pool->threadCount - 1;
+    pool->jobGeneration++;
+    pthread_cond_broadcast(&pool->jobReady);
+    pthread_mutex_unlock(&pool->mutex);
+
+    int begin, end;
+    getThreadRange(count, pool->threadCount, 0, &begin, &end);
+    if (begin < end) task(userData, begin, end, 0);
+
+    pthread_mutex_lock(&pool->mutex);
+    while (pool->pendingWorkers > 0) {
+        pthread_cond_wait(&pool->jobDone, &pool->mutex);
+    }
+    pthread_mutex_unlock(&pool->mutex);
+}